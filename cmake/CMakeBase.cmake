@@ -49,7 +49,34 @@ if(CMAKE_BUILD_TYPE MATCHES "Debug")
   endif(NOT DISABLE_LOGMUTEX MATCHES "Y" OR NOT DISABLE_LOGMUTEX MATCHES "y")
 endif(CMAKE_BUILD_TYPE MATCHES "Debug")
 
-add_definitions(-Wall -Wextra -Wlong-long -Wmissing-braces -std=c++1y -pthread)
+if(WITH_COROUTINES MATCHES "Y" OR WITH_COROUTINES MATCHES "y")
+  # Coroutine support (tasks/coro.h) needs C++20.
+  message(STATUS "Enabled coroutines")
+  set(CXX_STD c++2a)
+  if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+    add_definitions(-fcoroutines)
+  endif(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+else(WITH_COROUTINES MATCHES "Y" OR WITH_COROUTINES MATCHES "y")
+  set(CXX_STD c++1y)
+endif(WITH_COROUTINES MATCHES "Y" OR WITH_COROUTINES MATCHES "y")
+
+add_definitions(-Wall -Wextra -Wlong-long -Wmissing-braces -std=${CXX_STD} -pthread)
+
+if(WITH_NATIVE_ARCH MATCHES "Y" OR WITH_NATIVE_ARCH MATCHES "y")
+  # Enables the SSE4.2/AVX2 code paths (e.g. in the HTTP parser) if the build host supports them.
+  message(STATUS "Optimizing for the native CPU architecture")
+  add_definitions(-march=native)
+endif(WITH_NATIVE_ARCH MATCHES "Y" OR WITH_NATIVE_ARCH MATCHES "y")
+
+if(WITH_IO_URING MATCHES "Y" OR WITH_IO_URING MATCHES "y")
+  if(CMAKE_SYSTEM_NAME STREQUAL Linux)
+    # Submits disk I/O to an io_uring, needs Linux 5.6 or newer at runtime.
+    message(STATUS "Enabled io_uring disk I/O")
+    add_definitions(-D_WITH_IO_URING)
+  else(CMAKE_SYSTEM_NAME STREQUAL Linux)
+    message(WARNING "io_uring is only available on Linux")
+  endif(CMAKE_SYSTEM_NAME STREQUAL Linux)
+endif(WITH_IO_URING MATCHES "Y" OR WITH_IO_URING MATCHES "y")
 
 if(NOT NO_DBG_SYMBOLS MATCHES "Y" OR NOT NO_DBG_SYMBOLS MATCHES "y")
   add_definitions(-g)
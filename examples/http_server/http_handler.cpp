@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <tasks/dispatcher.h>
+#include <tasks/net/acceptor.h>
+
+#ifdef PROFILER
+#include <google/profiler.h>
+#endif
+
+#include "http_handler.h"
+#include "stats.h"
+
+bool http_handler::handle_request() {
+    // Do something with the url for example
+    // const std::string& url = request().url();
+
+    // Now send back a response
+    response().set_status("204 No Content");
+    send_response();
+
+    stats::inc_req();
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+#ifdef PROFILER
+    ProfilerStart("http_server.prof");
+#endif
+    stats s;
+    tasks::net::acceptor<http_handler> srv(8080);
+    auto tasks = std::vector<tasks::task*>{&srv, &s};
+    tasks::dispatcher::instance()->run(tasks);
+#ifdef PROFILER
+    ProfilerStop();
+#endif
+    return 0;
+}
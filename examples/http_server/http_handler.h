@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _HTTP_HANDLER_H_
+#define _HTTP_HANDLER_H_
+
+#include <tasks/net/http_server_task.h>
+
+#include "stats.h"
+
+class http_handler : public tasks::net::http_server_task {
+  public:
+    http_handler(tasks::net::socket& s) : http_server_task(s) { stats::inc_clients(); }
+
+    ~http_handler() { stats::dec_clients(); }
+
+    bool handle_request();
+};
+
+#endif  // _HTTP_HANDLER_H_
@@ -34,6 +34,9 @@ int main(int argc, char** argv) {
 #ifdef PROFILER
     ProfilerStart("uwsgi_server.prof");
 #endif
+    // Serve multiple requests per nginx upstream connection and close connections that are idle for a minute.
+    tasks::net::uwsgi_task::set_default_keep_alive(true);
+    tasks::net::uwsgi_task::set_default_idle_timeout(60.);
     stats s;
     tasks::net::acceptor<uwsgi_handler> srv(12345);
     auto tasks = std::vector<tasks::task*>{&srv, &s};
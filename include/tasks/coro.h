@@ -0,0 +1,463 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _TASKS_CORO_H_
+#define _TASKS_CORO_H_
+
+// Coroutine support needs a C++20 compiler (cmake option WITH_COROUTINES=y). The library itself does not depend on
+// it, so everything in here is header only.
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+#include <tasks/dispatcher.h>
+#include <tasks/exec.h>
+#include <tasks/future.h>
+#include <tasks/net_io_task.h>
+#include <tasks/timer_wheel.h>
+#include <tasks/worker.h>
+
+// The number of free coroutine frames a thread keeps per size class.
+#define CORO_FRAME_POOL_MAX 64
+
+namespace tasks {
+
+class coro_io_task;
+
+/// A thread local pool for coroutine frames.
+///
+/// Frames are rounded up to multiples of 64 bytes. Frames up to 1KB are kept in per thread free lists, so a worker
+/// reuses the frames of the coroutines it has finished. Frames can be freed by any thread.
+class coro_frame_pool {
+  public:
+    static inline void* allocate(std::size_t size) {
+        std::size_t c = size_class(size);
+        if (c >= CLASSES) {
+            return ::operator new(size);
+        }
+        lists& l = local();
+        block* b = l.heads[c];
+        if (nullptr != b) {
+            l.heads[c] = b->next;
+            l.counts[c]--;
+            return b;
+        }
+        return ::operator new((c + 1) * GRANULE);
+    }
+
+    static inline void deallocate(void* ptr, std::size_t size) {
+        std::size_t c = size_class(size);
+        if (c < CLASSES) {
+            lists& l = local();
+            if (l.counts[c] < CORO_FRAME_POOL_MAX) {
+                block* b = static_cast<block*>(ptr);
+                b->next = l.heads[c];
+                l.heads[c] = b;
+                l.counts[c]++;
+                return;
+            }
+        }
+        ::operator delete(ptr);
+    }
+
+    /// \return The number of free frames of the calling thread.
+    static inline std::size_t free_frames() {
+        std::size_t n = 0;
+        for (auto c : local().counts) {
+            n += c;
+        }
+        return n;
+    }
+
+  private:
+    static constexpr std::size_t GRANULE = 64;
+    static constexpr std::size_t CLASSES = 16;
+
+    struct block {
+        block* next;
+    };
+
+    struct lists {
+        block* heads[CLASSES] = {};
+        std::size_t counts[CLASSES] = {};
+
+        ~lists() {
+            for (auto b : heads) {
+                while (nullptr != b) {
+                    block* next = b->next;
+                    ::operator delete(b);
+                    b = next;
+                }
+            }
+        }
+    };
+
+    static inline std::size_t size_class(std::size_t size) { return (size + GRANULE - 1) / GRANULE - 1; }
+
+    static inline lists& local() {
+        thread_local lists l;
+        return l;
+    }
+};
+
+namespace detail {
+
+/// Resume a coroutine in the context it has been suspended in: a coro_io_task resumes it in its handler, any other
+/// coroutine in the event loop of the worker that suspended it.
+void resume_coroutine(coro_io_task* task, worker* w, std::coroutine_handle<> h, bool defer);
+
+template <class T>
+struct coro_promise_base {
+    promise<T> p;
+
+    future<T> get_return_object() { return p.get_future(); }
+
+    // Coroutines start right away and free their frame when they are done.
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() {
+        try {
+            throw;
+        } catch (tasks_exception& e) {
+            p.set_exception(e);
+        } catch (std::exception& e) {
+            p.set_exception(tasks_exception(tasks_error::FUTURE_EXCEPTION, e.what()));
+        } catch (...) {
+            p.set_exception(tasks_exception(tasks_error::FUTURE_EXCEPTION, "unknown exception"));
+        }
+    }
+
+    static void* operator new(std::size_t size) { return coro_frame_pool::allocate(size); }
+    static void operator delete(void* ptr, std::size_t size) { coro_frame_pool::deallocate(ptr, size); }
+};
+
+template <class T>
+struct coro_promise : coro_promise_base<T> {
+    void return_value(T v) { this->p.set_value(std::move(v)); }
+};
+
+template <>
+struct coro_promise<void> : coro_promise_base<void> {
+    void return_void() { p.set_value(); }
+};
+
+template <class T>
+struct future_awaiter_base {
+    future<T> f;
+
+    bool await_ready() const { return f.ready(); }
+
+    void await_suspend(std::coroutine_handle<> h);
+};
+
+}  // detail
+
+/// Awaits a future. The value is moved out of the future, errors are thrown.
+template <class T>
+struct future_awaiter : detail::future_awaiter_base<T> {
+    T await_resume() { return std::move(this->f.get()); }
+};
+
+template <>
+struct future_awaiter<void> : detail::future_awaiter_base<void> {
+    void await_resume() { f.get(); }
+};
+
+/// Make futures awaitable:
+///
+///   future<response_type> lookup(thrift_async_client& client, IpService_lookup_args args) {
+///       auto r = co_await client.async_call<IpService_lookup_result>("lookup", args);
+///       co_return r;
+///   }
+///
+/// A function that returns a tasks::future and uses co_await or co_return is a coroutine. It runs right away until
+/// its first suspension and its future becomes ready when it returns. Exceptions end up as error of the future.
+template <class T>
+inline future_awaiter<T> operator co_await(future<T> f) {
+    return future_awaiter<T>{{f}};
+}
+
+/// Suspends a coroutine for some time. The timer is managed by the timer wheel of the calling worker.
+class delay_awaiter {
+  public:
+    delay_awaiter(double seconds) : m_seconds(seconds), m_timer([this] { expired(); }) {}
+
+    bool await_ready() const { return m_seconds <= 0.; }
+
+    void await_suspend(std::coroutine_handle<> h);
+
+    void await_resume() {}
+
+  private:
+    double m_seconds;
+    wheel_timer m_timer;
+    std::coroutine_handle<> m_handle;
+    coro_io_task* m_task = nullptr;
+    worker* m_worker = nullptr;
+
+    // Called with the wheel locked, so the coroutine has to be resumed later.
+    void expired() { detail::resume_coroutine(m_task, m_worker, m_handle, true); }
+};
+
+/// \return An awaitable that suspends a coroutine for some time: co_await delay(0.5);
+inline delay_awaiter delay(double seconds) { return delay_awaiter(seconds); }
+
+/// Run a function in an executor thread.
+///
+/// \param f The function.
+/// \return A future for the return value of f: auto rows = co_await offload([q] { return db.query(q); });
+template <class F>
+inline future<decltype(std::declval<F&>()())> offload(F f) {
+    return exec<decltype(std::declval<F&>()())>(f);
+}
+
+}  // tasks
+
+namespace std {
+
+template <class T, class... Args>
+struct coroutine_traits<tasks::future<T>, Args...> {
+    using promise_type = tasks::detail::coro_promise<T>;
+};
+
+}  // std
+
+namespace tasks {
+
+/// A net_io_task that runs a coroutine instead of a state machine.
+///
+///   class echo_task : public coro_io_task {
+///     public:
+///       echo_task(net::socket& s) : coro_io_task(s, EV_READ) {}
+///
+///       future<void> run() {
+///           char buf[4];
+///           while (true) {
+///               co_await read_exact(buf, sizeof(buf));
+///               co_await write_all(buf, sizeof(buf));
+///           }
+///       }
+///   };
+///
+///   dispatcher::instance()->add_task(new acceptor<echo_task>(7));
+///
+/// run() gets started by the first event of the task. The coroutine is always resumed in handle_event() on the
+/// worker of the task, also when it awaits a future, a delay or an offloaded function. The watcher only runs for the
+/// first event and while the coroutine waits for the socket. The task finishes when run() returns, a failed run() sets
+/// the exception.
+class coro_io_task : public net_io_task {
+  public:
+    /// \param socket The socket.
+    /// \param events The events that start the coroutine, e.g. EV_READ for server or EV_WRITE for client connections.
+    coro_io_task(net::socket& socket, int events) : net_io_task(socket, events) {}
+
+    virtual ~coro_io_task() {}
+
+    /// The coroutine of the task.
+    virtual future<void> run() = 0;
+
+    /// \copydoc event_task::handle_event
+    bool handle_event(worker* worker, int events) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_in_handler = true;
+        }
+        coro_io_task* prev = current();
+        current_ref() = this;
+        m_revents = events;
+        if (!m_started) {
+            m_started = true;
+            m_run = run();
+        } else if (m_io_wait && (events & m_wait_events)) {
+            m_io_wait = false;
+            std::coroutine_handle<> h = m_io_handle;
+            m_io_handle = nullptr;
+            h.resume();
+        }
+        bool done = false;
+        bool io_wait = false;
+        while (true) {
+            std::coroutine_handle<> h;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_ready) {
+                    // Decide under the lock, a resumption that gets scheduled afterwards fires a new event.
+                    m_in_handler = false;
+                    done = m_run.ready();
+                    io_wait = m_io_wait;
+                    break;
+                }
+                h = m_ready;
+                m_ready = nullptr;
+            }
+            h.resume();
+        }
+        current_ref() = prev;
+        if (done) {
+            if (m_run.failed()) {
+                set_exception(m_run.error());
+            }
+            return false;
+        }
+        if (io_wait) {
+            update_watcher(worker);
+        }
+        return true;
+    }
+
+    /// The watcher only gets started to wait for the first event and while the coroutine waits for the socket.
+    void start_watcher(worker* worker) {
+        if (!m_started || m_io_wait) {
+            net_io_task::start_watcher(worker);
+        }
+    }
+
+    /// An awaitable for socket events.
+    class io_awaiter {
+      public:
+        io_awaiter(coro_io_task* task, int events) : m_task(task), m_events(events) {}
+
+        bool await_ready() const { return false; }
+
+        void await_suspend(std::coroutine_handle<> h) {
+            m_task->set_events(m_events);
+            m_task->m_wait_events = m_events;
+            m_task->m_io_handle = h;
+            m_task->m_io_wait = true;
+        }
+
+        /// \return The events that fired.
+        int await_resume() const { return m_task->m_revents; }
+
+      private:
+        coro_io_task* m_task;
+        int m_events;
+    };
+
+    /// \return An awaitable that resumes when the socket is readable.
+    inline io_awaiter readable() { return io_awaiter(this, EV_READ); }
+
+    /// \return An awaitable that resumes when the socket is writable.
+    inline io_awaiter writable() { return io_awaiter(this, EV_WRITE); }
+
+    /// Read exactly len bytes. Fails if the connection gets closed before.
+    future<std::size_t> read_exact(void* data, std::size_t len) {
+        std::size_t done = 0;
+        while (done < len) {
+            std::streamsize n = socket().read(static_cast<char*>(data) + done, len - done);
+            if (n < 0) {
+                co_await readable();
+            } else {
+                done += n;
+            }
+        }
+        co_return done;
+    }
+
+    /// Write len bytes.
+    future<std::size_t> write_all(const void* data, std::size_t len) {
+        std::size_t done = 0;
+        while (done < len) {
+            std::streamsize n = socket().write(static_cast<const char*>(data) + done, len - done);
+            if (n < 0) {
+                co_await writable();
+            } else {
+                done += n;
+            }
+        }
+        co_return done;
+    }
+
+    /// Resume a suspended coroutine of the task in its handler. Can be called from any thread.
+    void schedule(std::coroutine_handle<> h) {
+        bool fire;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            assert(!m_ready);
+            m_ready = h;
+            fire = !m_in_handler;
+        }
+        if (fire) {
+            event ev = {this, EV_CUSTOM};
+            worker* w = assigned_worker();
+            if (nullptr == w) {
+                w = dispatcher::instance()->last_worker();
+            }
+            w->async_call([ev](struct ev_loop* loop) {
+                worker* worker = (tasks::worker*)ev_userdata(loop);
+                worker->add_event(ev);
+            });
+        }
+    }
+
+    /// \return The task whose coroutine is running in the calling thread or nullptr.
+    static inline coro_io_task* current() { return current_ref(); }
+
+  private:
+    std::mutex m_mutex;
+    bool m_in_handler = false;
+    std::coroutine_handle<> m_ready;
+    bool m_started = false;
+    future<void> m_run;
+    std::atomic<bool> m_io_wait{false};
+    std::coroutine_handle<> m_io_handle;
+    int m_wait_events = EV_UNDEF;
+    int m_revents = EV_UNDEF;
+
+    static inline coro_io_task*& current_ref() {
+        thread_local coro_io_task* task = nullptr;
+        return task;
+    }
+};
+
+}  // tasks
+
+namespace tasks {
+namespace detail {
+
+inline void resume_coroutine(coro_io_task* task, worker* w, std::coroutine_handle<> h, bool defer) {
+    if (nullptr != task) {
+        task->schedule(h);
+    } else if (nullptr == w) {
+        h.resume();
+    } else if (defer) {
+        w->async_call([h](struct ev_loop* /* loop */) { h.resume(); });
+    } else {
+        w->exec_in_worker_ctx([h](struct ev_loop* /* loop */) { h.resume(); });
+    }
+}
+
+template <class T>
+void future_awaiter_base<T>::await_suspend(std::coroutine_handle<> h) {
+    coro_io_task* task = coro_io_task::current();
+    worker* w = worker::get();
+    // Attach to the completing thread, the coroutine gets resumed in its own context.
+    f.then([task, w, h](future<T>&) { resume_coroutine(task, w, h, false); }, nullptr);
+}
+
+}  // detail
+
+inline void delay_awaiter::await_suspend(std::coroutine_handle<> h) {
+    m_handle = h;
+    m_task = coro_io_task::current();
+    m_worker = worker::get();
+    if (nullptr == m_worker) {
+        m_worker = dispatcher::instance()->last_worker();
+    }
+    m_timer.arm(m_seconds);
+}
+
+}  // tasks
+
+#endif  // __cpp_impl_coroutine
+
+#endif  // _TASKS_CORO_H_
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _TASKS_CPU_POOL_H_
+#define _TASKS_CPU_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The default number of CPU pool threads. 0 uses one thread per CPU.
+#define CPU_POOL_THREADS 0
+
+namespace tasks {
+
+/// A work-stealing thread pool for CPU bound work.
+///
+/// Every thread owns a queue. Functors submitted by a pool thread are pushed to the back of its own queue and the
+/// owner takes them from the back again, so recursively split work stays hot in its cache. Idle threads steal from
+/// the front of the other queues, which holds the oldest and usually biggest pieces of work. Functors submitted from
+/// outside of the pool are spread over the queues.
+///
+/// The pool is separate from the executor threads of exec(), functors must not block. Use parallel_for(),
+/// parallel_reduce() or a task_group (tasks/parallel.h) instead of submitting functors directly.
+class cpu_pool {
+  public:
+    using func_t = std::function<void()>;
+
+    /// \param threads The number of threads, 0 for one per CPU.
+    cpu_pool(std::size_t threads);
+
+    /// Runs all queued functors and joins the threads.
+    ~cpu_pool();
+
+    /// Override the number of threads. This method needs to be called before the first call to instance().
+    static void init_threads(std::size_t threads);
+
+    /// \return The CPU pool singleton.
+    static std::shared_ptr<cpu_pool> instance();
+
+    /// Queue a functor.
+    void submit(func_t f);
+
+    /// \return The number of threads.
+    inline std::size_t threads() const { return m_queues.size(); }
+
+    /// \return The number of queued functors.
+    inline std::size_t pending() const { return m_queued; }
+
+  private:
+    struct queue {
+        std::mutex mutex;
+        std::deque<func_t> funcs;
+    };
+
+    static std::shared_ptr<cpu_pool> m_instance;
+    static std::mutex m_instance_mutex;
+    thread_local static cpu_pool* m_pool_ptr;  /// The pool of a pool thread
+    thread_local static std::size_t m_idx;     /// The queue of a pool thread
+
+    std::vector<std::unique_ptr<queue>> m_queues;
+    std::vector<std::unique_ptr<std::thread>> m_threads;
+    std::atomic<std::size_t> m_queued{0};
+    std::atomic<std::size_t> m_next{0};
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_term = false;
+
+    /// Main method of the pool threads.
+    void run(std::size_t idx);
+
+    /// Take a functor from the back of the own queue or steal one from the front of another queue.
+    bool take(std::size_t idx, func_t& f);
+};
+
+}  // tasks
+
+#endif  // _TASKS_CPU_POOL_H_
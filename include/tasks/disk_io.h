@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _TASKS_DISK_IO_H_
+#define _TASKS_DISK_IO_H_
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <tasks/future.h>
+#include <tasks/tasks_exception.h>
+
+// The default number of disk I/O threads.
+#define DISK_IO_THREADS 4
+
+namespace tasks {
+
+class worker;
+class disk_io_uring;
+
+/// Asynchronous disk I/O on a fixed pool of I/O threads.
+///
+/// Operations are queued and executed by the next free I/O thread, so workers never block on the disk and no thread
+/// is spawned per operation. If libtasks has been built with io_uring support (WITH_IO_URING=y) and the kernel
+/// supports it, operations are submitted to an io_uring instead. The thread pool takes over when the ring is full.
+///
+/// The completion callback runs in the event loop of the worker that submitted the operation, or in the I/O thread
+/// if the operation has been submitted outside of a worker.
+///
+///   disk_io::instance()->pwrite(fd, data, len, offset, [](std::streamsize bytes, const tasks_exception& e) {
+///       ...
+///   });
+///
+/// Every operation is also available without a callback. It returns a future then, which fails with the exception if
+/// an error occurs:
+///
+///   disk_io::instance()->pread(fd, buf, len, 0).then([](future<std::streamsize> bytes) { ... });
+///
+/// The data passed to an operation has to stay valid until the callback has been called. Writes write all data
+/// unless an error occurs, reads return less data than requested at the end of a file. On errors the result is -1
+/// and the exception is set.
+class disk_io {
+  public:
+    using complete_func_t = std::function<void(std::streamsize result, const tasks_exception& e)>;
+
+    /// \param threads The number of I/O threads.
+    disk_io(std::size_t threads);
+
+    /// Waits until all queued operations have been executed.
+    ~disk_io();
+
+    /// Override the number of I/O threads. This method needs to be called before the first call to instance().
+    static void init_threads(std::size_t threads);
+
+    /// \return The disk I/O singleton.
+    static std::shared_ptr<disk_io> instance();
+
+    /// Read at the current file position.
+    void read(int fd, void* data, std::size_t len, complete_func_t f);
+
+    /// Read at an offset. The file position is not changed.
+    void pread(int fd, void* data, std::size_t len, off_t offset, complete_func_t f);
+
+    /// Read into several buffers at an offset.
+    void preadv(int fd, std::vector<struct iovec> iov, off_t offset, complete_func_t f);
+
+    /// Write at the current file position.
+    void write(int fd, const void* data, std::size_t len, complete_func_t f);
+
+    /// Write at an offset. The file position is not changed.
+    void pwrite(int fd, const void* data, std::size_t len, off_t offset, complete_func_t f);
+
+    /// Write several buffers at an offset.
+    void pwritev(int fd, std::vector<struct iovec> iov, off_t offset, complete_func_t f);
+
+    /// Flush the data and metadata of a file to the disk. The result is 0 on success.
+    void fsync(int fd, complete_func_t f);
+
+    /// Flush the data of a file to the disk. The result is 0 on success.
+    void fdatasync(int fd, complete_func_t f);
+
+    future<std::streamsize> read(int fd, void* data, std::size_t len);
+    future<std::streamsize> pread(int fd, void* data, std::size_t len, off_t offset);
+    future<std::streamsize> preadv(int fd, std::vector<struct iovec> iov, off_t offset);
+    future<std::streamsize> write(int fd, const void* data, std::size_t len);
+    future<std::streamsize> pwrite(int fd, const void* data, std::size_t len, off_t offset);
+    future<std::streamsize> pwritev(int fd, std::vector<struct iovec> iov, off_t offset);
+    future<std::streamsize> fsync(int fd);
+    future<std::streamsize> fdatasync(int fd);
+
+    /// \return The number of queued operations.
+    std::size_t pending() const;
+
+  private:
+    friend class disk_io_uring;
+
+    enum class op_type { READ, WRITE, READV, WRITEV, FSYNC, FDATASYNC };
+
+    struct op {
+        op_type type;
+        int fd;
+        void* data;
+        std::size_t len;
+        off_t offset;  // -1 for the current file position
+        std::vector<struct iovec> iov;
+        complete_func_t func;
+        worker* origin;
+        std::size_t done = 0;  // the bytes written so far
+        std::size_t idx = 0;   // the first iovec that has not been written completely
+    };
+
+    static std::shared_ptr<disk_io> m_instance;
+    static std::mutex m_instance_mutex;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<op> m_ops;
+    bool m_term = false;
+    std::vector<std::unique_ptr<std::thread>> m_threads;
+#ifdef _WITH_IO_URING
+    std::unique_ptr<disk_io_uring> m_uring;
+#endif
+
+    /// \return A callback that completes a promise.
+    static complete_func_t promise_func(promise<std::streamsize> p);
+
+    /// Queue an operation.
+    void submit(op_type type, int fd, void* data, std::size_t len, off_t offset, std::vector<struct iovec> iov,
+                complete_func_t f);
+
+    /// Main method of the I/O threads.
+    void run();
+
+    /// Execute an operation.
+    ///
+    /// \return The result of the operation, -1 on errors with errno set.
+    static std::streamsize exec(op& o);
+
+    /// Pass the result of an operation to its callback.
+    ///
+    /// \param o The operation.
+    /// \param result The result.
+    /// \param err The errno if the result is -1.
+    static void complete(op& o, std::streamsize result, int err);
+
+    /// \return The total length of the buffers of a vectored operation.
+    static std::size_t iov_length(const op& o);
+
+    /// Account written bytes to a vectored operation, so o.iov[o.idx] starts with the first byte to write.
+    static void iov_advance(op& o, std::size_t bytes);
+};
+
+}  // tasks
+
+#endif  // _TASKS_DISK_IO_H_
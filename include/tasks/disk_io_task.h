@@ -18,9 +18,17 @@ namespace tasks {
 
 class worker;
 
+/// A task that reads a buffer from or writes a buffer to a file.
+///
+/// The operation is executed by the disk_io thread pool. When it has finished, the task is finished in a worker, so
+/// on_finish callbacks can be used. add_task() also returns a future for the number of bytes.
 class disk_io_task : public event_task {
   public:
-    disk_io_task(int fd, int events, tools::buffer* buf);
+    /// \param fd The file descriptor.
+    /// \param events EV_READ or EV_WRITE.
+    /// \param buf The buffer to read into or to write.
+    /// \param offset The file offset or -1 to use the current file position.
+    disk_io_task(int fd, int events, tools::buffer* buf, off_t offset = -1);
     virtual ~disk_io_task();
 
     inline std::string get_string() const {
@@ -47,7 +55,12 @@ class disk_io_task : public event_task {
     int m_fd = -1;
     int m_events = EV_UNDEF;
     tools::buffer* m_buf = nullptr;
+    off_t m_offset = -1;
     std::streamsize m_bytes = -1;
+    std::promise<std::streamsize> m_promise;
+
+    /// Called by the disk_io thread pool.
+    void op_finished(std::streamsize bytes, const tasks_exception& e);
 
     std::shared_future<std::streamsize> op();
 };
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _TASKS_DISK_IO_URING_H_
+#define _TASKS_DISK_IO_URING_H_
+
+#ifdef _WITH_IO_URING
+
+#include <linux/io_uring.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <tasks/disk_io.h>
+
+// The number of submission queue entries of the disk I/O ring.
+#define DISK_IO_URING_ENTRIES 256
+
+namespace tasks {
+
+/// An io_uring for the disk_io operations.
+///
+/// Operations are submitted to the ring directly by the calling thread, a single completion thread waits for their
+/// completions and passes them on like the I/O threads do. Short writes are resubmitted until all data is written.
+/// The ring is set up with the raw system calls, so no additional library is needed. Requires Linux 5.6 or newer.
+///
+/// The ring is used for disk I/O only. Sockets are driven by libev, which can use an io_uring backend of its own, see
+/// dispatcher::init_backend().
+class disk_io_uring {
+  public:
+    /// Set up the ring. Throws a tasks_exception if the kernel does not support io_uring.
+    ///
+    /// \param entries The number of submission queue entries.
+    disk_io_uring(unsigned entries);
+
+    /// Waits until all submitted operations have completed.
+    ~disk_io_uring();
+
+    /// Submit an operation.
+    ///
+    /// \param o The operation.
+    /// \return False if the ring is full or the kernel refused the submission. The operation is not modified in this
+    /// case.
+    bool submit(disk_io::op& o);
+
+  private:
+    int m_fd = -1;
+    unsigned m_entries = 0;
+    unsigned m_cq_entries = 0;
+    unsigned m_in_flight = 0;
+    bool m_term = false;
+    std::mutex m_mutex;  // serializes submissions
+
+    void* m_sq_ring = nullptr;
+    std::size_t m_sq_ring_size = 0;
+    void* m_cq_ring = nullptr;
+    std::size_t m_cq_ring_size = 0;
+    struct io_uring_sqe* m_sqes = nullptr;
+    std::size_t m_sqes_size = 0;
+
+    unsigned* m_sq_tail = nullptr;
+    unsigned* m_sq_mask = nullptr;
+    unsigned* m_sq_array = nullptr;
+    unsigned* m_cq_head = nullptr;
+    unsigned* m_cq_tail = nullptr;
+    unsigned* m_cq_mask = nullptr;
+    struct io_uring_cqe* m_cqes = nullptr;
+
+    std::unique_ptr<std::thread> m_thread;
+
+    /// Fill a submission queue entry and pass it to the kernel. Has to be called with the mutex held.
+    ///
+    /// \param o The operation, nullptr to wake up the completion thread.
+    /// \return The error code of io_uring_enter or 0. The entry has been taken back on errors.
+    int push(disk_io::op* o);
+
+    /// Main method of the completion thread.
+    void run();
+
+    /// Handle the completion of an operation.
+    ///
+    /// \return True if the operation has finished, false if it has been resubmitted.
+    bool completed(disk_io::op* o, int res);
+
+    /// Release the ring.
+    void unmap();
+};
+
+}  // tasks
+
+#endif  // _WITH_IO_URING
+
+#endif  // _TASKS_DISK_IO_URING_H_
@@ -72,6 +72,22 @@ class dispatcher {
 
     static mode run_mode() { return m_run_mode; }
 
+    /// Select the libev backend of the event loops, e.g. EVBACKEND_EPOLL. The default (0) lets libev pick the best
+    /// backend of the system. Backends that are not supported by the system are ignored by libev. All libev backends
+    /// only report readiness, sockets are always read and written by the tasks themselves, even with
+    /// EVBACKEND_IOURING.
+    ///
+    /// Note: This method has to be called before the dispatcher gets started.
+    static void init_backend(unsigned int flags) {
+        if (nullptr != m_instance && m_instance->m_started) {
+            terr("ERROR: dispatcher::init_backend must be called before starting the dispatcher!" << std::endl);
+            assert(false);
+        }
+        m_backend = flags;
+    }
+
+    static unsigned int backend() { return m_backend; }
+
     static std::shared_ptr<dispatcher> instance() {
         if (nullptr == m_instance) {
             // Create as many workers as we have CPU's per default
@@ -160,6 +176,7 @@ class dispatcher {
     std::mutex m_executor_mutex;
 
     static mode m_run_mode;
+    static unsigned int m_backend;
 
     /// State of the workers used for maintaining the leader/followers
     tools::bitset m_workers_busy;
@@ -9,38 +9,62 @@
 #define _TASKS_DISPOSABLE_H_
 
 #include <atomic>
+#include <cassert>
+#include <cstdint>
 
 namespace tasks {
 
+class worker;
+
 /*!
  * \brief Base class for objects/tasks that can be deleted.
  *
- * We implement a simplistic garbage collector using timer tasks. If
- * a task with auto_delete enabled can't be deleted directly by a
- * worker thread, a dispose_task gets created that periodically tries
- * to delete the task.
+ * A task that is still referenced by asynchronous work (e.g. a handler running in another thread) holds a dispose
+ * reference via disable_dispose(). If the task gets removed while references are held, it is disposed by the
+ * worker it belongs to as soon as the last reference is released with enable_dispose().
  */
 class disposable {
   public:
-    disposable() : m_can_dispose(true) {}
+    disposable() : m_state(0) {}
     virtual ~disposable() {}
 
     /*!
      * \brief Check if a task can be disposed or not.
      *
-     * \return True if the task can be disposed. False otherwise.
+     * \return True if no dispose references are held. False otherwise.
      */
-    inline bool can_dispose() const { return m_can_dispose; }
+    inline bool can_dispose() const { return 0 == (m_state.load(std::memory_order_acquire) & REFS_MASK); }
 
     /*!
-     * \brief Mark a task for being not disposable.
+     * \brief Take a dispose reference. Calls can be nested.
      */
-    inline void disable_dispose() { m_can_dispose = false; }
+    inline void disable_dispose() { m_state.fetch_add(1, std::memory_order_acq_rel); }
 
     /*!
-     * \brief Mark a task for being disposable.
+     * \brief Release a dispose reference.
+     *
+     * If the task has been removed and this was the last reference, it gets disposed. The task must not be accessed
+     * after this call.
      */
-    inline void enable_dispose() { m_can_dispose = true; }
+    inline void enable_dispose() {
+        uint32_t prev = m_state.fetch_sub(1, std::memory_order_acq_rel);
+        assert(0 != (prev & REFS_MASK));
+        if ((REMOVED | 1) == prev) {
+            dispose(m_dispose_worker);
+        }
+    }
+
+    /*!
+     * \brief Mark a task as removed.
+     *
+     * \param worker The worker that disposes the task.
+     * \return True if the task can be disposed now. Otherwise it gets disposed by the last enable_dispose() call.
+     */
+    inline bool request_dispose(worker* worker) {
+        m_dispose_worker = worker;
+        uint32_t prev = m_state.fetch_or(REMOVED, std::memory_order_acq_rel);
+        return 0 == (prev & REFS_MASK);
+    }
 
     /*! \brief Dispose an object.
      *
@@ -51,7 +75,11 @@ class disposable {
     virtual void dispose(worker*) = 0;
 
   private:
-    std::atomic<bool> m_can_dispose;
+    static constexpr uint32_t REMOVED = 1u << 31;
+    static constexpr uint32_t REFS_MASK = REMOVED - 1;
+
+    std::atomic<uint32_t> m_state;  // the number of references and the REMOVED flag
+    worker* m_dispose_worker = nullptr;
 };
 
 }  // tasks
@@ -51,7 +51,7 @@ class error_base {
     }
 
     /// Set an exception to report an error.
-    inline void set_exception(tasks_exception& e) {
+    inline void set_exception(const tasks_exception& e) {
         m_exception = e;
     }
 
@@ -11,6 +11,7 @@
 #include <tasks/task.h>
 #include <tasks/error_base.h>
 #include <tasks/dispatcher.h>
+#include <cstdint>
 
 namespace tasks {
 
@@ -18,6 +19,12 @@ namespace tasks {
 /// worker::exec_in_worker_ctx(task_func_t f).
 typedef std::function<void(struct ev_loop*)> task_func_t;
 
+/// The priority of the events of a task. Workers handle the fired events of higher priorities first.
+enum class event_priority : uint8_t { HIGH = 0, NORMAL = 1, LOW = 2 };
+
+/// The number of event priorities.
+#define EVENT_PRIORITIES 3
+
 class event_task : public task, public error_base {
   public:
     typedef std::function<void(worker* worker, const tasks_exception& e)> error_func_worker_t;
@@ -63,6 +70,13 @@ class event_task : public task, public error_base {
     /// Activate the underlying watcher to listen for I/O or timer events.
     virtual void start_watcher(worker* worker) = 0;
 
+    /// \return The priority of the events of the task.
+    inline event_priority priority() const { return m_priority; }
+
+    /// Set the priority of the events of the task, e.g. to keep health checks and control timers responsive when the
+    /// workers are overloaded. The default is event_priority::NORMAL.
+    inline void set_priority(event_priority p) { m_priority = p; }
+
     /// Returns a pointer to the assigned worker.
     inline worker* assigned_worker() const { return m_worker; }
 
@@ -93,6 +107,7 @@ class event_task : public task, public error_base {
 
   private:
     worker* m_worker = nullptr;
+    event_priority m_priority = event_priority::NORMAL;
     std::vector<error_func_t> m_error_funcs;
 };
 
@@ -8,7 +8,11 @@
 #ifndef _TASKS_EXEC_H_
 #define _TASKS_EXEC_H_
 
+#include <memory>
+#include <vector>
+
 #include <tasks/exec_task.h>
+#include <tasks/future.h>
 
 namespace tasks {
 
@@ -32,9 +36,141 @@ void exec(exec_task::func_t f);
  *
  * \param f The functor to execute.
  * \param ff The finish functor to be executed when f has been
- *           executed.
+ *           executed. It runs in the event loop of the worker that
+ *           called exec(), or in the executor thread if exec() has
+ *           been called outside of a worker.
  */
 void exec(exec_task::func_t f, task::finish_func_void_t ff);
+
+namespace detail {
+
+/// The value or the error of an executed functor.
+template <class R>
+struct exec_outcome {
+    R value{};
+    tasks_exception error;
+
+    template <class F>
+    void run(F& f) {
+        try {
+            value = f();
+        } catch (tasks_exception& e) {
+            error = e;
+        } catch (std::exception& e) {
+            error = tasks_exception(tasks_error::FUTURE_EXCEPTION, e.what());
+        }
+    }
+
+    void deliver(promise<R>& p) {
+        if (tasks_error::UNSET != error.error_code()) {
+            p.set_exception(error);
+        } else {
+            p.set_value(std::move(value));
+        }
+    }
+};
+
+template <>
+struct exec_outcome<void> {
+    tasks_exception error;
+
+    template <class F>
+    void run(F& f) {
+        try {
+            f();
+        } catch (tasks_exception& e) {
+            error = e;
+        } catch (std::exception& e) {
+            error = tasks_exception(tasks_error::FUTURE_EXCEPTION, e.what());
+        }
+    }
+
+    void deliver(promise<void>& p) {
+        if (tasks_error::UNSET != error.error_code()) {
+            p.set_exception(error);
+        } else {
+            p.set_value();
+        }
+    }
+};
+
+/// Pass the outcomes of executed functors to their promises in the event loop of a worker with a single wakeup, or
+/// right away if no worker is given.
+template <class R>
+void deliver(worker* origin, std::shared_ptr<std::vector<promise<R>>> promises,
+             std::shared_ptr<std::vector<exec_outcome<R>>> outcomes) {
+    auto f = [promises, outcomes] {
+        for (std::size_t i = 0; i < promises->size(); i++) {
+            (*outcomes)[i].deliver((*promises)[i]);
+        }
+    };
+    if (nullptr == origin) {
+        f();
+    } else {
+        origin->async_call([f](struct ev_loop* /* loop */) { f(); });
+    }
+}
+
+}  // detail
+
+/*!
+ * \brief Execute code in a separate executor thread and return its result.
+ *
+ * The result is passed back to the worker that called exec(), so the
+ * continuations of the future run in its event loop:
+ *
+ *   exec<std::string>([key] { return db.get(key); }).then([this](future<std::string> v) { ... });
+ *
+ * \param f The functor to execute. Exceptions fail the future.
+ * \return A future for the return value of f.
+ */
+template <class R, class F>
+future<R> exec(F f) {
+    auto promises = std::make_shared<std::vector<promise<R>>>(1);
+    future<R> result = promises->front().get_future();
+    worker* origin = worker::get();
+    exec([f, promises, origin]() mutable {
+        auto outcomes = std::make_shared<std::vector<detail::exec_outcome<R>>>(1);
+        outcomes->front().run(f);
+        detail::deliver(origin, promises, outcomes);
+    });
+    return result;
+}
+
+/*!
+ * \brief Execute a batch of functors in one executor thread.
+ *
+ * The functors run one after another in a single executor thread, so a
+ * batch of short blocking calls needs one executor wakeup and passes
+ * all results back to the calling worker with one wakeup.
+ *
+ * \param fs The functors to execute.
+ * \return The futures for the return values in the same order. Use
+ *         when_all() to continue when all of them are ready.
+ */
+template <class R, class F>
+std::vector<future<R>> exec_batch(std::vector<F> fs) {
+    auto promises = std::make_shared<std::vector<promise<R>>>(fs.size());
+    std::vector<future<R>> results;
+    results.reserve(fs.size());
+    for (auto& p : *promises) {
+        results.push_back(p.get_future());
+    }
+    if (fs.empty()) {
+        return results;
+    }
+    worker* origin = worker::get();
+    auto funcs = std::make_shared<std::vector<F>>(std::move(fs));
+    exec([funcs, promises, origin] {
+        auto outcomes = std::make_shared<std::vector<detail::exec_outcome<R>>>(funcs->size());
+        for (std::size_t i = 0; i < funcs->size(); i++) {
+            (*outcomes)[i].run((*funcs)[i]);
+        }
+        detail::deliver(origin, promises, outcomes);
+    });
+    return results;
 }
 
+}  // tasks
+
 #endif  // _TASKS_EXEC_H_
@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _TASKS_FUTURE_H_
+#define _TASKS_FUTURE_H_
+
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <tasks/tasks_exception.h>
+#include <tasks/worker.h>
+
+namespace tasks {
+
+template <class T>
+class future;
+template <class T>
+class promise;
+
+namespace detail {
+
+template <class T>
+struct future_storage {
+    using type = T;
+};
+
+template <>
+struct future_storage<void> {
+    using type = bool;
+};
+
+/// The state shared by a promise and its futures.
+template <class T>
+struct future_state {
+    using value_type = typename future_storage<T>::type;
+
+    std::mutex mutex;
+    bool ready = false;
+    value_type value{};
+    tasks_exception error;
+    std::vector<std::function<void()>> continuations;
+
+    /// Store the outcome and run the continuations.
+    void set(value_type&& v, const tasks_exception& e) {
+        std::vector<std::function<void()>> conts;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (ready) {
+                throw tasks_exception(tasks_error::FUTURE_ALREADY_SATISFIED, "promise: already satisfied");
+            }
+            value = std::move(v);
+            error = e;
+            ready = true;
+            conts.swap(continuations);
+        }
+        for (auto& f : conts) {
+            f();
+        }
+    }
+
+    /// Run a function when the state is ready. It runs right away if the state is ready already.
+    void add(std::function<void()> f) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!ready) {
+                continuations.push_back(std::move(f));
+                return;
+            }
+        }
+        f();
+    }
+};
+
+/// Breaks the promise if the last copy of a promise goes away without setting a value.
+template <class T>
+struct promise_guard {
+    std::shared_ptr<future_state<T>> state = std::make_shared<future_state<T>>();
+
+    ~promise_guard() {
+        bool ready;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            ready = state->ready;
+        }
+        if (!ready) {
+            state->set(typename future_state<T>::value_type(),
+                       tasks_exception(tasks_error::FUTURE_BROKEN_PROMISE, "promise: broken promise"));
+        }
+    }
+};
+
+template <class T>
+struct future_access {
+    static T& get(future_state<T>& s) { return s.value; }
+};
+
+template <>
+struct future_access<void> {
+    static void get(future_state<void>&) {}
+};
+
+/// Run a function in the event loop of a worker or right away if no worker is given.
+inline void run_in_worker(worker* w, std::function<void()> f) {
+    if (nullptr == w) {
+        f();
+    } else {
+        w->exec_in_worker_ctx([f](struct ev_loop* /* loop */) { f(); });
+    }
+}
+
+/// Calls a continuation and completes the promise of then() with its result. Continuations that return a future
+/// complete the promise when the returned future is ready.
+template <class R>
+struct continuation {
+    using future_type = future<R>;
+
+    template <class P, class F, class A>
+    static void call(P& p, F& f, A& a) {
+        p.set_value(f(a));
+    }
+};
+
+template <>
+struct continuation<void> {
+    using future_type = future<void>;
+
+    template <class P, class F, class A>
+    static void call(P& p, F& f, A& a) {
+        f(a);
+        p.set_value();
+    }
+};
+
+template <class R>
+struct continuation<future<R>> {
+    using future_type = future<R>;
+
+    template <class P, class F, class A>
+    static void call(P& p, F& f, A& a) {
+        future<R> r = f(a);
+        r.then([p](future<R> r) mutable { p.set_from(r); }, nullptr);
+    }
+};
+
+}  // detail
+
+/// The result of an asynchronous operation, that is set by a promise.
+///
+/// Unlike std::future, a tasks::future is never waited for. Continuations are attached with then() and run in the
+/// event loop of a worker once the value or an error has been set, so a worker is never blocked:
+///
+///   disk_io::instance()->pread(fd, buf, len, 0).then([](future<std::streamsize> bytes) {
+///       return parse(bytes.get());
+///   }).then([this](future<record> r) {
+///       ...
+///   });
+///
+/// A continuation gets the ready future. get() returns the value or throws the error, so errors propagate along a
+/// chain until a continuation catches them. The value of the future returned by then() is the return value of the
+/// continuation. If the continuation returns a future, the returned future completes when that one does.
+///
+/// Futures are copyable handles to a shared state. Value types have to be default constructible.
+template <class T>
+class future {
+  public:
+    using value_type = T;
+
+    /// Construct an invalid future.
+    future() {}
+
+    /// \return True if the future refers to a shared state.
+    inline bool valid() const { return nullptr != m_state; }
+
+    /// \return True if the value or an error has been set.
+    inline bool ready() const {
+        assert(valid());
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->ready;
+    }
+
+    /// \return True if an error has been set.
+    inline bool failed() const { return ready() && tasks_error::UNSET != m_state->error.error_code(); }
+
+    /// \return The error. The error code is tasks_error::UNSET if the future has no error.
+    inline const tasks_exception& error() const {
+        assert(ready());
+        return m_state->error;
+    }
+
+    /// Return the value of a ready future. Must not be called before the future is ready.
+    ///
+    /// \throws tasks_exception The error that has been set.
+    typename std::add_lvalue_reference<T>::type get() const {
+        assert(ready());
+        if (tasks_error::UNSET != m_state->error.error_code()) {
+            throw m_state->error;
+        }
+        return detail::future_access<T>::get(*m_state);
+    }
+
+    /// Attach a continuation.
+    ///
+    /// \param f The continuation. It gets this future when it is ready. A tasks_exception or std::exception thrown by
+    ///   the continuation is set as the error of the returned future.
+    /// \param w The worker that runs the continuation. The default is the calling worker. If nullptr, the
+    ///   continuation runs in the thread that completes the future.
+    /// \return A future for the result of the continuation.
+    template <class F>
+    auto then(F f, worker* w = worker::get()) ->
+        typename detail::continuation<decltype(f(std::declval<future<T>&>()))>::future_type {
+        using result_type = decltype(f(std::declval<future<T>&>()));
+        using future_type = typename detail::continuation<result_type>::future_type;
+        promise<typename future_type::value_type> p;
+        future_type next = p.get_future();
+        future<T> self = *this;
+        on_ready([p, f, self]() mutable {
+            try {
+                detail::continuation<result_type>::call(p, f, self);
+            } catch (tasks_exception& e) {
+                p.set_exception(e);
+            } catch (std::exception& e) {
+                p.set_exception(tasks_exception(tasks_error::FUTURE_EXCEPTION, e.what()));
+            }
+        }, w);
+        return next;
+    }
+
+  private:
+    template <class U>
+    friend class promise;
+    template <class U>
+    friend future<std::vector<future<U>>> when_all(const std::vector<future<U>>& futures);
+    template <class U>
+    friend future<std::size_t> when_any(const std::vector<future<U>>& futures);
+
+    std::shared_ptr<detail::future_state<T>> m_state;
+
+    future(std::shared_ptr<detail::future_state<T>> state) : m_state(state) {}
+
+    inline void on_ready(std::function<void()> f, worker* w) {
+        assert(valid());
+        if (nullptr == w) {
+            m_state->add(std::move(f));
+        } else {
+            m_state->add([w, f] { detail::run_in_worker(w, f); });
+        }
+    }
+};
+
+/// Sets the value or the error of a future. Promises are copyable handles, if the last copy goes away before a value
+/// has been set, the future fails with tasks_error::FUTURE_BROKEN_PROMISE.
+///
+/// Continuations that do not run in a worker, and continuations of the calling worker, run inside set_value() and
+/// set_exception(). A value or an error can be set only once.
+template <class T>
+class promise {
+  public:
+    promise() : m_guard(std::make_shared<detail::promise_guard<T>>()) {}
+
+    /// \return A future for the value.
+    inline future<T> get_future() const { return future<T>(m_guard->state); }
+
+    /// Set the value.
+    template <class V = T>
+    void set_value(typename std::enable_if<!std::is_void<V>::value, V>::type v) {
+        m_guard->state->set(std::move(v), tasks_exception());
+    }
+
+    /// Complete a promise<void>.
+    template <class V = T>
+    typename std::enable_if<std::is_void<V>::value>::type set_value() {
+        m_guard->state->set(true, tasks_exception());
+    }
+
+    /// Set an error.
+    void set_exception(const tasks_exception& e) {
+        m_guard->state->set(typename detail::future_state<T>::value_type(), e);
+    }
+
+    /// Take over the value or the error of a ready future.
+    void set_from(const future<T>& f) {
+        assert(f.ready());
+        m_guard->state->set(typename detail::future_state<T>::value_type(f.m_state->value), f.m_state->error);
+    }
+
+  private:
+    std::shared_ptr<detail::promise_guard<T>> m_guard;
+};
+
+/// \return A ready future.
+template <class T>
+future<typename std::decay<T>::type> make_ready_future(T&& v) {
+    promise<typename std::decay<T>::type> p;
+    p.set_value(std::forward<T>(v));
+    return p.get_future();
+}
+
+/// \return A ready future<void>.
+inline future<void> make_ready_future() {
+    promise<void> p;
+    p.set_value();
+    return p.get_future();
+}
+
+/// \return A failed future.
+template <class T>
+future<T> make_exceptional_future(const tasks_exception& e) {
+    promise<T> p;
+    p.set_exception(e);
+    return p.get_future();
+}
+
+/// Wait for a number of futures.
+///
+/// \param futures The futures.
+/// \return A future that becomes ready when all futures are ready. Its value are the ready futures in the same order,
+///   so each of them can carry a value or an error. Attach a continuation with then() to use it.
+template <class T>
+future<std::vector<future<T>>> when_all(const std::vector<future<T>>& futures) {
+    promise<std::vector<future<T>>> p;
+    future<std::vector<future<T>>> result = p.get_future();
+    if (futures.empty()) {
+        p.set_value(std::vector<future<T>>());
+        return result;
+    }
+    auto all = std::make_shared<std::vector<future<T>>>(futures);
+    auto left = std::make_shared<std::atomic<std::size_t>>(all->size());
+    for (auto& f : *all) {
+        // The last one completes the result in the thread that made it ready.
+        f.on_ready([p, all, left]() mutable {
+            if (1 == left->fetch_sub(1)) {
+                p.set_value(std::move(*all));
+            }
+        }, nullptr);
+    }
+    return result;
+}
+
+/// Wait for the first of a number of futures.
+///
+/// \param futures The futures. Must not be empty.
+/// \return A future for the index of the first future that became ready.
+template <class T>
+future<std::size_t> when_any(const std::vector<future<T>>& futures) {
+    assert(!futures.empty());
+    promise<std::size_t> p;
+    future<std::size_t> result = p.get_future();
+    auto done = std::make_shared<std::atomic<bool>>(false);
+    for (std::size_t i = 0; i < futures.size(); i++) {
+        future<T> f = futures[i];
+        f.on_ready([p, done, i]() mutable {
+            if (!done->exchange(true)) {
+                p.set_value(i);
+            }
+        }, nullptr);
+    }
+    return result;
+}
+
+}  // tasks
+
+#endif  // _TASKS_FUTURE_H_
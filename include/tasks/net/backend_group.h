@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _BACKEND_GROUP_H_
+#define _BACKEND_GROUP_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The latency that is added to the EWMA of an endpoint when calculating its load. It lets the in flight count decide
+// between endpoints that have no samples yet or are very fast.
+#define BACKEND_GROUP_BASE_LATENCY 0.0001
+
+namespace tasks {
+namespace net {
+
+/// A group of replicas of a backend service.
+///
+/// Clients that are created with a backend group pick an endpoint for each request. Every endpoint tracks the number
+/// of requests in flight and an exponentially weighted moving average (EWMA) of its latency. An endpoint is picked by
+/// the power of two choices: two random endpoints are compared and the one with the lower load, the EWMA times the
+/// requests in flight, wins. This avoids the herd behaviour of always picking the least loaded endpoint, while slow or
+/// busy replicas get less traffic.
+///
+/// Endpoints that fail a number of requests in a row are ejected for some time. If all endpoints are ejected, they are
+/// used anyway. A group is shared by all clients of a backend and can be used from any thread.
+class backend_group {
+  public:
+    /// A replica of the backend, reachable via tcp or a unix domain socket.
+    struct endpoint {
+        endpoint(const std::string& h, int p) : host(h), port(p) {}
+        endpoint(const std::string& p) : path(p) {}
+
+        std::string host;
+        int port = -1;
+        std::string path;
+
+        /// \return True if the endpoint uses tcp.
+        inline bool tcp() const { return port > -1; }
+
+        std::string get_string() const;
+    };
+
+    static constexpr std::size_t NONE = std::numeric_limits<std::size_t>::max();
+
+    /// \param endpoints The replicas. At least one endpoint is required.
+    backend_group(std::vector<endpoint> endpoints);
+
+    /// Configure the outlier ejection.
+    ///
+    /// \param max_errors The number of consecutive errors after which an endpoint gets ejected. 0 disables the
+    ///   ejection. Default is 5.
+    /// \param seconds The time in seconds an endpoint stays ejected. Default is 10.
+    void set_ejection(uint32_t max_errors, double seconds);
+
+    /// Set the weight of a new sample in the latency EWMA. Default is 0.3.
+    void set_ewma_weight(double weight);
+
+    /// Pick an endpoint for a request and count the request as in flight.
+    ///
+    /// \return The index of the endpoint.
+    std::size_t acquire();
+
+    /// Report the outcome of a request.
+    ///
+    /// \param idx The endpoint index returned by acquire().
+    /// \param seconds The latency of the request.
+    /// \param success False if the request failed.
+    void release(std::size_t idx, double seconds, bool success);
+
+    /// Forget a request that has neither succeeded nor failed, e.g. when a client is closed before the request has
+    /// been sent.
+    ///
+    /// \param idx The endpoint index returned by acquire().
+    inline void cancel(std::size_t idx) { m_stats[idx].in_flight.fetch_sub(1, std::memory_order_relaxed); }
+
+    /// \return The endpoint at index idx.
+    inline const endpoint& get_endpoint(std::size_t idx) const { return m_endpoints[idx]; }
+
+    /// \return The number of endpoints.
+    inline std::size_t size() const { return m_endpoints.size(); }
+
+    /// \return The number of requests in flight to an endpoint.
+    inline uint32_t in_flight(std::size_t idx) const { return m_stats[idx].in_flight.load(std::memory_order_relaxed); }
+
+    /// \return The latency EWMA of an endpoint in seconds.
+    inline double latency(std::size_t idx) const { return m_stats[idx].ewma.load(std::memory_order_relaxed); }
+
+    /// \return True if an endpoint is ejected.
+    inline bool ejected(std::size_t idx) const { return ejected(idx, now_ms()); }
+
+    /// \return The current time in milliseconds of a monotonic clock.
+    static inline int64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+  private:
+    struct stats {
+        std::atomic<uint32_t> in_flight{0};
+        std::atomic<double> ewma{0.};
+        std::atomic<uint32_t> errors{0};
+        std::atomic<int64_t> ejected_until{0};
+    };
+
+    std::vector<endpoint> m_endpoints;
+    std::unique_ptr<stats[]> m_stats;
+    uint32_t m_max_errors = 5;
+    int64_t m_ejection_ms = 10000;
+    double m_ewma_weight = 0.3;
+
+    inline bool ejected(std::size_t idx, int64_t now) const {
+        return m_stats[idx].ejected_until.load(std::memory_order_relaxed) > now;
+    }
+
+    inline double load(std::size_t idx) const {
+        return (latency(idx) + BACKEND_GROUP_BASE_LATENCY) * (in_flight(idx) + 1);
+    }
+
+    /// \return The index of a random endpoint.
+    std::size_t random() const;
+};
+
+}  // net
+}  // tasks
+
+#endif  // _BACKEND_GROUP_H_
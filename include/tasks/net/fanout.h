@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _FANOUT_H_
+#define _FANOUT_H_
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <tasks/dispatcher.h>
+#include <tasks/logging.h>
+#include <tasks/tasks_exception.h>
+#include <tasks/timer_wheel.h>
+#include <tasks/worker.h>
+#include <tasks/net/hedge_policy.h>
+
+namespace tasks {
+namespace net {
+
+/// Sends a number of requests in parallel and continues when all of them have finished or a deadline has passed.
+///
+/// The fan-out does not know how to send a request. It calls an issue function for each request, that sends it via an
+/// http_sender, a thrift_async_client or anything else that reports a value or an error to a callback:
+///
+///   using lookup_fanout = fanout<response_type>;
+///   lookup_fanout f(args.size(), [&](std::size_t i, bool hedge, lookup_fanout::reply_func_t r) {
+///       (hedge ? replica : client).call<IpService_lookup_result>("lookup", args[i], r);
+///       return lookup_fanout::cancel_func_t();
+///   });
+///   f.set_deadline(0.1);
+///   f.start([](lookup_fanout::results_t& results) { ... });
+///
+/// With a hedge_policy, requests that are still outstanding after the policy's delay are issued a second time with
+/// the hedge flag set, so the issue function can send them to another replica. The first reply wins. A request that
+/// fails is hedged right away.
+///
+/// The completion is called exactly once, with the results of all requests. Requests that did not finish in time
+/// carry a FANOUT_DEADLINE error. If the fan-out was started in a worker thread, the completion runs in the context
+/// of this worker. The fan-out object can be released after start(), its state is kept until all callbacks are done.
+/// The deadline and the hedge timer are canceled as soon as the fan-out completes.
+template <class value_type>
+class fanout {
+  public:
+    /// The result of one request.
+    struct result {
+        value_type value;
+        /// The error code is tasks_error::UNSET on success.
+        tasks_exception error;
+        /// True if the value was delivered by the hedged request.
+        bool hedged = false;
+    };
+
+    using results_t = std::vector<result>;
+    using complete_func_t = std::function<void(results_t&)>;
+    /// Reports the value of a request or an error. The value is undefined if the error code is set.
+    using reply_func_t = std::function<void(value_type&, const tasks_exception&)>;
+    /// Aborts a request after the fan-out has completed. May be empty if the request can't be aborted.
+    using cancel_func_t = std::function<void()>;
+    /// Sends request idx. The reply function has to be called exactly once, it can be called from within the issue
+    /// function.
+    using issue_func_t = std::function<cancel_func_t(std::size_t idx, bool hedge, reply_func_t reply)>;
+    /// Returns true if request idx can be hedged.
+    using hedgeable_func_t = std::function<bool(std::size_t idx)>;
+
+    /// \param count The number of requests.
+    /// \param issue The function that sends a request.
+    /// \param hedgeable Tells which requests can be hedged. All requests can be hedged if not set.
+    fanout(std::size_t count, issue_func_t issue, hedgeable_func_t hedgeable = nullptr)
+        : m_state(std::make_shared<state>(count)) {
+        m_state->issue = issue;
+        m_state->hedgeable = hedgeable;
+    }
+
+    virtual ~fanout() {}
+
+    /// Set the global deadline. Default is no deadline.
+    ///
+    /// \param seconds The time in seconds from start() until the completion is called with what has been received.
+    inline void set_deadline(double seconds) { m_state->deadline = seconds; }
+
+    /// Enable hedging.
+    inline void set_hedging(std::shared_ptr<hedge_policy> policy) { m_state->policy = policy; }
+
+    /// Send all requests.
+    ///
+    /// \param f The completion.
+    void start(complete_func_t f) {
+        std::shared_ptr<state> s = m_state;
+        s->complete = f;
+        s->origin = worker::get();
+        s->start = std::chrono::steady_clock::now();
+        tdbg("fanout(" << s.get() << "): sending " << s->results.size() << " requests" << std::endl);
+        if (s->results.empty()) {
+            finish(s);
+            return;
+        }
+        std::weak_ptr<state> ws = s;
+        // Both timers exist before one of them can fire, so finish() can cancel them without locking.
+        s->deadline_timer.reset(new wheel_timer([ws] { on_timer(ws, expire); }));
+        s->hedge_timer.reset(new wheel_timer([ws] { on_timer(ws, hedge_all); }));
+        s->deadline_timer->arm(s->deadline);
+        if (nullptr != s->policy) {
+            s->hedge_timer->arm(s->policy->delay());
+        }
+        for (std::size_t i = 0; i < s->results.size(); i++) {
+            issue(s, i, false);
+        }
+    }
+
+  private:
+    using clock_t = std::chrono::steady_clock;
+
+    /// The two attempts of a request, index 0 is the primary and index 1 the hedged request.
+    struct slot {
+        cancel_func_t cancel[2];
+        clock_t::time_point sent[2];
+        bool issued[2] = {false, false};
+        bool failed[2] = {false, false};
+        bool done = false;
+    };
+
+    struct state {
+        state(std::size_t count) : results(count), slots(count), pending(count) {}
+
+        std::mutex mutex;
+        results_t results;
+        std::vector<slot> slots;
+        std::size_t pending;
+        bool completed = false;
+        double deadline = 0.;
+        issue_func_t issue;
+        hedgeable_func_t hedgeable;
+        complete_func_t complete;
+        std::shared_ptr<hedge_policy> policy;
+        worker* origin = nullptr;
+        clock_t::time_point start;
+        std::unique_ptr<wheel_timer> deadline_timer;
+        std::unique_ptr<wheel_timer> hedge_timer;
+    };
+
+    std::shared_ptr<state> m_state;
+
+    /// Send one attempt of a request. Hedged attempts are marked as issued by the caller, so they are sent only
+    /// once.
+    static void issue(std::shared_ptr<state> s, std::size_t idx, bool hedge) {
+        int a = hedge ? 1 : 0;
+        {
+            std::lock_guard<std::mutex> lock(s->mutex);
+            s->slots[idx].issued[a] = true;
+            s->slots[idx].sent[a] = clock_t::now();
+        }
+        cancel_func_t cancel;
+        try {
+            cancel = s->issue(idx, hedge,
+                              [s, idx, a](value_type& v, const tasks_exception& e) { reply(s, idx, a, v, e); });
+        } catch (tasks_exception& e) {
+            value_type v;
+            reply(s, idx, a, v, e);
+        }
+        if (nullptr != cancel) {
+            std::unique_lock<std::mutex> lock(s->mutex);
+            if (s->completed || s->slots[idx].done) {
+                // The request has been answered or timed out in the meantime, the attempt is not needed anymore.
+                lock.unlock();
+                cancel();
+            } else {
+                s->slots[idx].cancel[a] = cancel;
+            }
+        }
+    }
+
+    /// Called for each attempt when it has finished.
+    static void reply(std::shared_ptr<state> s, std::size_t idx, int a, value_type& v, const tasks_exception& e) {
+        cancel_func_t cancel;
+        bool hedge_now = false;
+        bool last = false;
+        {
+            std::lock_guard<std::mutex> lock(s->mutex);
+            slot& sl = s->slots[idx];
+            sl.cancel[a] = nullptr;
+            if (s->completed || sl.done) {
+                return;
+            }
+            bool failed = tasks_error::UNSET != e.error_code();
+            int other = 1 - a;
+            if (failed && sl.issued[other] && !sl.failed[other]) {
+                // Wait for the other attempt.
+                sl.failed[a] = true;
+                return;
+            }
+            if (failed && !sl.issued[1] && can_hedge(s, idx)) {
+                // Try the replica instead of giving up.
+                sl.failed[a] = true;
+                sl.issued[1] = true;
+                hedge_now = true;
+            } else {
+                if (!failed && nullptr != s->policy) {
+                    s->policy->record(std::chrono::duration<double>(clock_t::now() - sl.sent[a]).count());
+                }
+                result& r = s->results[idx];
+                r.value = std::move(v);
+                r.error = e;
+                r.hedged = 1 == a;
+                sl.done = true;
+                cancel = std::move(sl.cancel[other]);
+                sl.cancel[other] = nullptr;
+                last = 0 == --s->pending;
+                if (last) {
+                    s->completed = true;
+                }
+            }
+        }
+        if (hedge_now) {
+            tdbg("fanout(" << s.get() << "): request " << idx << " failed, hedging" << std::endl);
+            issue(s, idx, true);
+            return;
+        }
+        // Abort the losing attempt.
+        if (nullptr != cancel) {
+            cancel();
+        }
+        if (last) {
+            finish(s);
+        }
+    }
+
+    /// Hedge all outstanding requests. Called by the hedge timer.
+    static void hedge_all(std::shared_ptr<state> s) {
+        std::vector<std::size_t> hedge;
+        {
+            std::lock_guard<std::mutex> lock(s->mutex);
+            if (s->completed) {
+                return;
+            }
+            for (std::size_t i = 0; i < s->slots.size(); i++) {
+                if (!s->slots[i].done && !s->slots[i].issued[1] && can_hedge(s, i)) {
+                    s->slots[i].issued[1] = true;
+                    hedge.push_back(i);
+                }
+            }
+        }
+        for (std::size_t i : hedge) {
+            tdbg("fanout(" << s.get() << "): hedging request " << i << std::endl);
+            issue(s, i, true);
+        }
+    }
+
+    /// Complete with the results received so far. Called by the deadline timer.
+    static void expire(std::shared_ptr<state> s) {
+        std::vector<cancel_func_t> cancel;
+        {
+            std::lock_guard<std::mutex> lock(s->mutex);
+            if (s->completed) {
+                return;
+            }
+            s->completed = true;
+            for (std::size_t i = 0; i < s->slots.size(); i++) {
+                slot& sl = s->slots[i];
+                if (sl.done) {
+                    continue;
+                }
+                s->results[i].error = tasks_exception(tasks_error::FANOUT_DEADLINE, "fanout: deadline exceeded");
+                for (int a = 0; a < 2; a++) {
+                    if (nullptr != sl.cancel[a]) {
+                        cancel.push_back(std::move(sl.cancel[a]));
+                        sl.cancel[a] = nullptr;
+                    }
+                }
+            }
+        }
+        tdbg("fanout(" << s.get() << "): deadline exceeded, aborting " << cancel.size() << " requests" << std::endl);
+        for (auto& c : cancel) {
+            c();
+        }
+        finish(s);
+    }
+
+    /// Called by the timer wheel when a timer expires. The wheel is locked, so the work is done by the event loop later.
+    /// Only a weak reference is passed on, releasing the last reference here would cancel the timer.
+    static void on_timer(std::weak_ptr<state> ws, void (*f)(std::shared_ptr<state>)) {
+        worker::get()->async_call([ws, f](struct ev_loop* /* loop */) {
+            if (auto s = ws.lock()) {
+                f(s);
+            }
+        });
+    }
+
+    /// Has to be called with the mutex held.
+    static bool can_hedge(const std::shared_ptr<state>& s, std::size_t idx) {
+        return nullptr != s->policy && (nullptr == s->hedgeable || s->hedgeable(idx));
+    }
+
+    /// Pass the results to the completion in the context of the originating worker.
+    static void finish(std::shared_ptr<state> s) {
+        if (nullptr != s->deadline_timer) {
+            s->deadline_timer->cancel();
+            s->hedge_timer->cancel();
+        }
+        tdbg("fanout(" << s.get() << "): complete after "
+                       << std::chrono::duration<double>(clock_t::now() - s->start).count() << "s" << std::endl);
+        if (nullptr == s->origin) {
+            s->complete(s->results);
+        } else {
+            s->origin->exec_in_worker_ctx([s](struct ev_loop*) { s->complete(s->results); });
+        }
+    }
+};
+
+}  // net
+}  // tasks
+
+#endif  // _FANOUT_H_
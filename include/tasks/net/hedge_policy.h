@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _HEDGE_POLICY_H_
+#define _HEDGE_POLICY_H_
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// The number of latency samples a hedge_policy keeps.
+#ifndef HEDGE_POLICY_SAMPLES
+#define HEDGE_POLICY_SAMPLES 256
+#endif
+
+// The hedge delay is recalculated after this many new samples.
+#define HEDGE_POLICY_UPDATE 16
+
+namespace tasks {
+namespace net {
+
+/// Decides when a fan-out request gets re-issued to a second replica.
+///
+/// The policy tracks the latencies of the recent requests to a backend and hedges a request when it takes longer than
+/// a quantile (the p95 by default) of them. Until enough samples have been collected the initial delay is used. A
+/// policy is shared by all fan-outs that talk to the same backend and can be used from any thread.
+class hedge_policy {
+  public:
+    /// \param initial_delay The delay in seconds that is used until enough samples are available.
+    /// \param quantile The latency quantile to hedge after.
+    /// \param min_delay The lower bound of the delay in seconds. It protects the backend from hedging almost all
+    ///   requests if the latencies are very low.
+    hedge_policy(double initial_delay = 0.05, double quantile = 0.95, double min_delay = 0.001);
+
+    /// Add a latency sample.
+    ///
+    /// \param seconds The time it took to get a successful response.
+    void record(double seconds);
+
+    /// \return The time in seconds after which outstanding requests get hedged.
+    inline double delay() const { return m_delay.load(std::memory_order_relaxed); }
+
+    /// \return The number of samples that have been recorded.
+    std::size_t samples() const;
+
+  private:
+    mutable std::mutex m_mutex;
+    std::vector<double> m_samples;
+    std::size_t m_next = 0;
+    std::size_t m_count = 0;
+    double m_quantile;
+    double m_min_delay;
+    std::atomic<double> m_delay;
+
+    /// Calculate the delay from the samples. Has to be called with the mutex held.
+    void update();
+};
+
+}  // net
+}  // tasks
+
+#endif  // _HEDGE_POLICY_H_
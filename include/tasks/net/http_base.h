@@ -111,6 +111,9 @@ class http_base {
     /// \param size The number of bytes to copy.
     inline std::size_t read(char* data, std::size_t size) { return m_content_buffer.read(data, size); }
 
+    /// \return The content buffer. Allows transports to access the content without copying it.
+    inline tools::buffer& content_buffer() { return m_content_buffer; }
+
     /// \return An std::istream to access the content buffer.
     inline std::istream& content_istream() { return m_content_istream; }
 
@@ -130,6 +133,17 @@ class http_base {
         std::cout << content_p();
     }
 
+    /// Append the serialized object to a string. Can be called after the object has been written to a socket and
+    /// before it gets cleared.
+    inline void append_serialized(std::string& out) const {
+        if (m_data_buffer.size()) {
+            out.append(m_data_buffer.ptr_begin(), m_data_buffer.size());
+        }
+        if (m_content_buffer.size()) {
+            out.append(m_content_buffer.ptr_begin(), m_content_buffer.size());
+        }
+    }
+
     /// \return True after an HTTP object has been read from a socket and parsed or written to a socket.
     inline bool done() const { return m_state == io_state::DONE; }
 
@@ -155,6 +169,9 @@ class http_base {
 
     void write_headers(socket& sock);
     void write_content(socket& sock);
+
+    /// Write the data and the content buffer with a single system call.
+    void write_headers_and_content(socket& sock);
 };
 
 }  // net
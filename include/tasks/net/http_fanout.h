@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _HTTP_FANOUT_H_
+#define _HTTP_FANOUT_H_
+
+#include <memory>
+#include <vector>
+
+#include <tasks/future.h>
+#include <tasks/net/fanout.h>
+#include <tasks/net/http_base.h>
+#include <tasks/net/http_response.h>
+
+namespace tasks {
+namespace net {
+
+/// Sends a set of HTTP or uwsgi requests in parallel, each via its own http_sender.
+///
+///   std::vector<http_fanout::request> requests;
+///   requests.push_back({std::make_shared<http_request>("backend1", "/a"),
+///                       std::make_shared<http_request>("backend2", "/a")});
+///   requests.push_back({std::make_shared<http_request>("backend1", "/b"), nullptr});
+///   http_fanout f(requests);
+///   f.set_deadline(0.05);
+///   f.set_hedging(policy);
+///   f.start([](http_fanout::results_t& results) { ... });
+///
+/// The result values are the responses. Requests without a replica are not hedged. Requests that are still running
+/// when the fan-out completes get aborted by shutting down their connection.
+class http_fanout : public fanout<std::shared_ptr<http_response>> {
+  public:
+    struct request {
+        std::shared_ptr<http_base> primary;
+        /// The request that is sent to another replica when hedging. Optional.
+        std::shared_ptr<http_base> replica;
+    };
+
+    http_fanout(std::vector<request> requests)
+        : http_fanout(std::make_shared<std::vector<request>>(std::move(requests))) {}
+
+    /// Send a single request via a new http_sender.
+    ///
+    /// \param request The request.
+    /// \param reply The function that gets the response or the error.
+    /// \return A function that aborts the request.
+    /// \throws tasks_exception if the request can't be sent.
+    static cancel_func_t send(std::shared_ptr<http_base> request, reply_func_t reply);
+
+    /// Send a single request via a new http_sender.
+    ///
+    /// \param request The request.
+    /// \return A future for the response. Errors, including the ones of sending the request, fail the future.
+    static future<std::shared_ptr<http_response>> send(std::shared_ptr<http_base> request);
+
+  private:
+    http_fanout(std::shared_ptr<std::vector<request>> requests)
+        : fanout(requests->size(),
+                 [requests](std::size_t idx, bool hedge, reply_func_t reply) {
+                     const request& r = (*requests)[idx];
+                     return send(hedge ? r.replica : r.primary, reply);
+                 },
+                 [requests](std::size_t idx) { return nullptr != (*requests)[idx].replica; }) {}
+};
+
+}  // net
+}  // tasks
+
+#endif  // _HTTP_FANOUT_H_
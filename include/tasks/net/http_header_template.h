@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _HTTP_HEADER_TEMPLATE_H_
+#define _HTTP_HEADER_TEMPLATE_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tasks {
+namespace net {
+
+/// An immutable, pre-serialized status line and header block for HTTP responses.
+///
+/// Most responses of a service share the status line and headers like Content-Type or Server. A template serializes
+/// them once, so sending a response only copies the block and appends the dynamic headers. Create templates once and
+/// share them between responses:
+///
+///   static auto ok_json = std::make_shared<const http_header_template>(
+///       "200 OK", http_header_template::headers_t{{"Content-Type", "application/json"}, {"Server", "libtasks"}});
+///   response().set_template(ok_json);
+class http_header_template {
+  public:
+    using headers_t = std::vector<std::pair<std::string, std::string>>;
+
+    /// Constructor
+    ///
+    /// \param status The status, e.g. "200 OK".
+    /// \param headers The static headers.
+    /// \param date If true a Date header is added to each response.
+    http_header_template(const std::string& status, const headers_t& headers = {}, bool date = true);
+
+    /// \return The HTTP status string.
+    inline const std::string& status() const { return m_status; }
+
+    /// \return The HTTP status code.
+    inline int status_code() const { return m_status_code; }
+
+    /// \return A pointer to the serialized block.
+    inline const char* data() const { return m_block.data(); }
+
+    /// \return The size of the serialized block.
+    inline std::size_t size() const { return m_block.size(); }
+
+    /// \return True if a Date header has to be added.
+    inline bool date() const { return m_date; }
+
+  private:
+    std::string m_status;
+    int m_status_code;
+    std::string m_block;
+    bool m_date;
+};
+
+}  // net
+}  // tasks
+
+#endif  // _HTTP_HEADER_TEMPLATE_H_
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _HTTP_PARSER_H_
+#define _HTTP_PARSER_H_
+
+#include <cstdint>
+#include <cstddef>
+
+#include <tasks/tasks_exception.h>
+#include <tasks/tools/buffer.h>
+#include <tasks/tools/string_view.h>
+
+// Protect against peers sending endless header lines.
+#define HTTP_PARSER_MAX_LINE 65536
+
+namespace tasks {
+namespace net {
+
+/// A resumable HTTP/1.x message parser for requests and responses.
+///
+/// The parser works on a tools::buffer that gets filled from a socket. Each call to parse() continues where the last
+/// one stopped, so no byte is scanned twice. Only offsets are stored between calls, which allows the buffer to grow in
+/// between. Content-Length, chunked and (for responses) close delimited bodies are supported. Chunked bodies are
+/// decoded in place, so the content is contiguous in the buffer after the message has been parsed.
+class http_parser {
+  public:
+    /// The message type to parse.
+    enum class mode : uint8_t { REQUEST, RESPONSE };
+
+    enum class state : uint8_t {
+        START_LINE,
+        HEADERS,
+        BODY_LENGTH,
+        CHUNK_SIZE,
+        CHUNK_DATA,
+        CHUNK_END,
+        TRAILERS,
+        BODY_CLOSE,
+        DONE
+    };
+
+    /// Receives the parsed elements of a message. The passed views point into the buffer and are only valid during
+    /// the call.
+    class handler {
+      public:
+        virtual ~handler() {}
+
+        /// Called for the status line of a response.
+        ///
+        /// \param status_code The numeric status code.
+        /// \param status The status code followed by the reason phrase, e.g. "200 OK".
+        virtual void on_status_line(int /* status_code */, tools::string_view /* status */) {}
+
+        /// Called for the request line of a request.
+        ///
+        /// \param method The request method, e.g. "GET".
+        /// \param url The request target.
+        virtual void on_request_line(tools::string_view /* method */, tools::string_view /* url */) {}
+
+        /// Called for each header.
+        virtual void on_header(tools::string_view name, tools::string_view value) = 0;
+    };
+
+    http_parser(handler* h, mode m = mode::RESPONSE) : m_handler(h), m_mode(m) {}
+
+    /// Parse all bytes between the last parse position and the write pointer of the buffer.
+    ///
+    /// \param buf The buffer that is being filled.
+    /// \return True if the message is complete.
+    bool parse(tools::buffer& buf);
+
+    /// Has to be called when the peer closed the connection.
+    ///
+    /// \return True if the close completed a close delimited message.
+    bool finish_eof();
+
+    /// \return The parser state.
+    inline state get_state() const { return m_state; }
+
+    /// \return True if a complete message has been parsed.
+    inline bool done() const { return state::DONE == m_state; }
+
+    /// \return The offset of the content in the buffer.
+    inline std::size_t content_start() const { return m_content_start; }
+
+    /// \return The content length. For chunked bodies this is the decoded length.
+    inline std::size_t content_length() const { return m_body_end - m_content_start; }
+
+    /// \return The offset of the first byte after the message. Bytes behind it belong to the next message.
+    inline std::size_t message_end() const { return m_pos; }
+
+    /// \return True if the body uses chunked transfer encoding.
+    inline bool chunked() const { return m_chunked; }
+
+    /// \return True if the message uses HTTP/1.1.
+    inline bool http11() const { return m_http11; }
+
+    /// \return True if the connection can be reused after this message.
+    inline bool keep_alive() const {
+        return !m_close_delimited && (m_http11 ? !m_conn_close : m_conn_keepalive);
+    }
+
+    /// Reset the parser to read the next message.
+    inline void reset() {
+        m_state = state::START_LINE;
+        m_pos = 0;
+        m_scan = 0;
+        m_content_start = 0;
+        m_body_end = 0;
+        m_remaining = 0;
+        m_status_code = 0;
+        m_has_content_length = false;
+        m_chunked = false;
+        m_http11 = true;
+        m_conn_close = false;
+        m_conn_keepalive = false;
+        m_close_delimited = false;
+    }
+
+  private:
+    handler* m_handler;
+    mode m_mode;
+    state m_state = state::START_LINE;
+    std::size_t m_pos = 0;            // first unconsumed byte
+    std::size_t m_scan = 0;           // first byte not yet scanned for a line end
+    std::size_t m_content_start = 0;  // offset of the (decoded) body
+    std::size_t m_body_end = 0;       // end of the (decoded) body
+    std::size_t m_remaining = 0;      // bytes left in the current body or chunk
+    int m_status_code = 0;
+    bool m_has_content_length = false;
+    bool m_chunked = false;
+    bool m_http11 = true;
+    bool m_conn_close = false;
+    bool m_conn_keepalive = false;
+    bool m_close_delimited = false;
+
+    bool next_line(tools::buffer& buf, tools::string_view& line);
+    void parse_status_line(tools::string_view line);
+    void parse_request_line(tools::string_view line);
+    void parse_header(tools::string_view line);
+    void parse_chunk_size(tools::string_view line);
+    void headers_complete();
+};
+
+}  // net
+}  // tasks
+
+#endif  // _HTTP_PARSER_H_
@@ -45,6 +45,9 @@ class http_request : public http_base {
     /// \return the port.
     inline int port() const { return m_port; }
 
+    /// \return The method the request is sent with, POST if it has content and GET otherwise.
+    inline std::string method() const { return m_content_buffer.size() ? "POST" : "GET"; }
+
     /// \copydoc http_base::prepare_data_buffer()
     void prepare_data_buffer();
 
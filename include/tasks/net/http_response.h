@@ -10,57 +10,88 @@
 
 #define READ_BUFFER_SIZE_BLOCK 4096
 
+#include <memory>
+
 #include <tasks/net/http_base.h>
+#include <tasks/net/http_header_template.h>
+#include <tasks/net/http_parser.h>
 
 namespace tasks {
 namespace net {
 
 /// The HTTP response implementation.
-class http_response : public http_base {
+class http_response : public http_base, private http_parser::handler {
   public:
-    http_response() {}
+    http_response() : m_parser(this) {}
 
     inline void set_status(std::string status) {
         m_status = status;
         m_status_code = std::atoi(status.c_str());
     }
 
+    /// Use a pre-serialized status line and header block. The status of the template replaces the status of the
+    /// response. Headers set with set_header() are appended to the block, as well as the Date header if the template
+    /// asks for it and the Content-Length header.
+    ///
+    /// \param tpl The template or nullptr to build the status line and headers from scratch.
+    inline void set_template(std::shared_ptr<const http_header_template> tpl) { m_template = std::move(tpl); }
+
+    /// \return The header template or nullptr.
+    inline const std::shared_ptr<const http_header_template>& header_template() const { return m_template; }
+
     /// \return The HTTP status string.
-    inline const std::string& status() const { return m_status; }
+    inline const std::string& status() const { return nullptr != m_template ? m_template->status() : m_status; }
 
     /// \return The HTTP status code.
-    inline int status_code() const { return m_status_code; }
+    inline int status_code() const { return nullptr != m_template ? m_template->status_code() : m_status_code; }
 
     /// \copydoc http_base::prepare_data_buffer()
     void prepare_data_buffer();
 
+    /// \return The Date header line for the current time, including the line break. The header is formatted once per
+    /// second and thread.
+    static tools::string_view date_header();
+
     /// Read an HTTP response from a socket.
+    ///
+    /// Content-Length, chunked and close delimited bodies are supported. The content is stored without chunk
+    /// framing in the content buffer.
     void read_data(net::socket& sock);
 
+    /// \return True if the connection can be reused after this response.
+    inline bool keep_alive() const { return m_parser.keep_alive(); }
+
     /// \copydoc http_base::clear()
     void clear() {
         http_base::clear();
         m_status = "";
-        m_line_number = 0;
-        m_last_line_start = 0;
-        m_content_start = 0;
-        m_content_length_exists = false;
-        m_chunked_enc = false;
+        m_template.reset();
+        m_parser.reset();
     }
 
   private:
     std::string m_status;
-    int m_status_code;
-    int m_line_number = 0;
-    std::size_t m_last_line_start = 0;
-    std::size_t m_content_start = 0;
-    bool m_content_length_exists = false;
-    bool m_chunked_enc = false;
-
-    void parse_data();
-    void parse_line();
-    void parse_status();
-    void parse_header();
+    int m_status_code = 0;
+    std::shared_ptr<const http_header_template> m_template;
+    http_parser m_parser;
+
+    /// Write the Date header.
+    inline void write_date() {
+        tools::string_view date = date_header();
+        m_data_buffer.write(date.data(), date.size());
+    }
+
+    /// Write the Content-Length header.
+    void write_content_length();
+
+    /// \copydoc http_parser::handler::on_status_line
+    void on_status_line(int status_code, tools::string_view status);
+
+    /// \copydoc http_parser::handler::on_header
+    void on_header(tools::string_view name, tools::string_view value);
+
+    /// Finish the content buffer after the parser is done.
+    void finish_content();
 };
 
 }  // net
@@ -8,6 +8,7 @@
 #ifndef _HTTP_SENDER_H_
 #define _HTTP_SENDER_H_
 
+#include <chrono>
 #include <memory>
 #include <cassert>
 #include <cstring>
@@ -16,6 +17,7 @@
 #include <tasks/worker.h>
 #include <tasks/logging.h>
 #include <tasks/net_io_task.h>
+#include <tasks/net/backend_group.h>
 #include <tasks/net/http_request.h>
 #include <tasks/net/http_response.h>
 #include <tasks/net/socket.h>
@@ -39,6 +41,12 @@ class http_sender : public net_io_task {
     http_sender(std::shared_ptr<handler_type> handler)
         : net_io_task(EV_UNDEF), m_response(new http_response()), m_handler(handler) {}
 
+    virtual ~http_sender() {
+        if (backend_group::NONE != m_backend) {
+            m_group->cancel(m_backend);
+        }
+    }
+
     /// \copydoc event_task::handle_event
     bool handle_event(tasks::worker* worker, int events) {
         bool success = true;
@@ -46,11 +54,17 @@ class http_sender : public net_io_task {
             if (EV_READ & events) {
                 m_response->read_data(socket());
                 if (m_response->done()) {
+                    release_backend(m_response->status_code() < 500);
                     if (nullptr == m_handler) {
                         m_handler = std::make_shared<handler_type>();
                     }
                     success = m_handler->handle_response(m_response);
-                    m_response->clear();
+                    if (m_response.use_count() > 1) {
+                        // The handler kept the response, use a new one for the next request.
+                        m_response = std::make_shared<http_response>();
+                    } else {
+                        m_response->clear();
+                    }
                 }
             } else if (EV_WRITE & events) {
                 m_request->write_data(socket());
@@ -63,12 +77,17 @@ class http_sender : public net_io_task {
                 }
             }
         } catch (tasks::tasks_exception& e) {
+            release_backend(false);
             set_exception(e);
             success = false;
         }
         return success;
     }
 
+    /// Send the requests to the replicas of a backend group instead of the remote of the request. The endpoint is
+    /// picked for each request.
+    inline void set_backend_group(std::shared_ptr<backend_group> group) { m_group = group; }
+
     /// \return True if connected.
     inline bool connected() const {
         return socket().fd() != -1;
@@ -79,8 +98,16 @@ class http_sender : public net_io_task {
     inline void send(std::shared_ptr<http_base> request) {
         m_request = request;
         std::string remote;
+        int port = request->port();
         bool tcp = true;
-        if (request->host() != http_base::NO_VAL) {
+        if (nullptr != m_group) {
+            m_backend = m_group->acquire();
+            m_backend_start = std::chrono::steady_clock::now();
+            const backend_group::endpoint& ep = m_group->get_endpoint(m_backend);
+            tcp = ep.tcp();
+            remote = tcp ? ep.host : ep.path;
+            port = ep.port;
+        } else if (request->host() != http_base::NO_VAL) {
             // Remote host via TCP
             remote = request->host();
         } else if (request->path() != http_base::NO_VAL) {
@@ -94,22 +121,28 @@ class http_sender : public net_io_task {
         // Find the worker if keepalive is used, and this is not the first request, or the object is reused to connect
         // to a different host.
         tasks::worker* worker = tasks::dispatcher::instance()->get_worker_by_task(this);
-        if (connected() && m_remote != remote) {
+        if (connected() && (m_remote != remote || m_port != port)) {
             // Stop the watcher and close an existing connection.
             tdbg("http_sender: Closing connection to " << m_remote << std::endl);
             stop_watcher(worker);
             socket().close();
         }
         m_remote = remote;
+        m_port = port;
         set_events(EV_WRITE);
         if (!connected()) {
             // Connect
-            if (tcp) {
-                tdbg("http_sender: Connecting " << m_remote << ":" << request->port() << std::endl);
-                socket().connect(m_remote, request->port());
-            } else {
-                tdbg("http_sender: Connecting " << m_remote << std::endl);
-                socket().connect(m_remote);
+            try {
+                if (tcp) {
+                    tdbg("http_sender: Connecting " << m_remote << ":" << port << std::endl);
+                    socket().connect(m_remote, port);
+                } else {
+                    tdbg("http_sender: Connecting " << m_remote << std::endl);
+                    socket().connect(m_remote);
+                }
+            } catch (tasks_exception&) {
+                release_backend(false);
+                throw;
             }
             tasks::dispatcher::instance()->add_event_task(this);
         } else {
@@ -122,6 +155,19 @@ class http_sender : public net_io_task {
     std::shared_ptr<http_response> m_response;
     std::shared_ptr<handler_type> m_handler;
     std::string m_remote;
+    int m_port = -1;
+    std::shared_ptr<backend_group> m_group;
+    std::size_t m_backend = backend_group::NONE;
+    std::chrono::steady_clock::time_point m_backend_start;
+
+    /// Report the outcome of the current request to the backend group.
+    inline void release_backend(bool success) {
+        if (backend_group::NONE != m_backend) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_backend_start).count();
+            m_group->release(m_backend, seconds, success);
+            m_backend = backend_group::NONE;
+        }
+    }
 };
 
 }  // net
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _HTTP_SERVER_REQUEST_H_
+#define _HTTP_SERVER_REQUEST_H_
+
+#include <vector>
+
+#include <tasks/net/http_base.h>
+#include <tasks/net/http_parser.h>
+
+#ifndef READ_BUFFER_SIZE_BLOCK
+#define READ_BUFFER_SIZE_BLOCK 4096
+#endif
+
+// The maximum number of bytes a client can pipeline while a request is being handled.
+#define HTTP_SERVER_MAX_PIPELINE (1024 * 1024)
+
+// The maximum number of headers of a request.
+#define HTTP_SERVER_MAX_HEADERS 100
+
+// The maximum body size of a request.
+#define HTTP_SERVER_MAX_BODY (16 * 1024 * 1024)
+
+namespace tasks {
+namespace net {
+
+/// An HTTP request received by a server.
+///
+/// Pipelined requests that are read together with the current request are kept in a surplus buffer and get parsed
+/// after the current request has been cleared.
+///
+/// A request with more than HTTP_SERVER_MAX_HEADERS headers fails with HTTP_TOO_MANY_HEADERS, a body of more than
+/// HTTP_SERVER_MAX_BODY bytes fails with HTTP_BODY_TOO_LARGE. A Content-Length above the limit fails before the body
+/// gets read.
+class http_server_request : public http_base, private http_parser::handler {
+  public:
+    http_server_request() : m_parser(this, http_parser::mode::REQUEST) {}
+
+    /// \return The request method.
+    inline const std::string& method() const { return m_method; }
+
+    /// \return The request URL.
+    inline const std::string& url() const { return m_url; }
+
+    /// \return True if the request uses HTTP/1.1.
+    inline bool http11() const { return m_parser.http11(); }
+
+    /// \return True if the client wants to reuse the connection.
+    inline bool keep_alive() const { return m_parser.keep_alive(); }
+
+    /// \return True if bytes of a pipelined request have been read already.
+    inline bool has_pipelined() const { return !m_surplus.empty(); }
+
+    /// Requests are not sent by the server.
+    void prepare_data_buffer() {}
+
+    /// Read an HTTP request from a socket.
+    ///
+    /// If the request is done already, the data belongs to pipelined requests and is kept for later.
+    void read_data(net::socket& sock);
+
+    /// Parse the pipelined bytes that have been read together with the previous request. Has to be called after
+    /// clear(). No data is read from the socket.
+    void read_pipelined();
+
+    /// \copydoc http_base::clear()
+    void clear();
+
+  private:
+    std::string m_method;
+    std::string m_url;
+    http_parser m_parser;
+    std::vector<char> m_surplus;
+    std::size_t m_header_count = 0;
+
+    /// \copydoc http_parser::handler::on_request_line
+    void on_request_line(tools::string_view method, tools::string_view url);
+
+    /// \copydoc http_parser::handler::on_header
+    void on_header(tools::string_view name, tools::string_view value);
+
+    /// Fail if the body that has been read so far exceeds HTTP_SERVER_MAX_BODY.
+    void check_body() const;
+
+    /// Move the pipelined bytes out of the content buffer and finish it after the parser is done.
+    void finish_content();
+};
+
+}  // net
+}  // tasks
+
+#endif  // _HTTP_SERVER_REQUEST_H_
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _HTTP_SERVER_TASK_H_
+#define _HTTP_SERVER_TASK_H_
+
+#include <cassert>
+
+#include <tasks/worker.h>
+#include <tasks/net_io_task.h>
+#include <tasks/net/http_server_request.h>
+#include <tasks/net/http_response.h>
+
+namespace tasks {
+namespace net {
+
+/// The base class for native HTTP/1.1 servers.
+///
+/// A server handles a client connection and is usually created by an acceptor:
+///
+///   class my_task : public http_server_task { ... };
+///   dispatcher::instance()->add_task(new acceptor<my_task>(8080));
+///
+/// Connections are kept alive if the client supports it. Pipelined requests are answered in order, the next request
+/// is passed to handle_request() after the response to the previous one has been written.
+///
+/// Like the uwsgi_task, a connection that exceeds the idle, read, request or write timeout gets closed.
+///
+/// Requests with too many headers or a body that is too large (see http_server_request) are answered with 431 or 413
+/// without calling handle_request(), and the connection gets closed.
+class http_server_task : public tasks::net_io_task {
+  public:
+    http_server_task(net::socket& sock) : tasks::net_io_task(sock, EV_READ), m_timeouts(m_default_timeouts) {
+        arm_deadline(m_timeouts.idle);
+    }
+
+    virtual ~http_server_task() {}
+
+    /// Set the timeout defaults for new connections.
+    static void set_default_timeouts(const timeouts_t& timeouts) { m_default_timeouts = timeouts; }
+
+    /// Set the timeouts of the connection. They apply from the next phase of the connection on.
+    inline void set_timeouts(const timeouts_t& timeouts) { m_timeouts = timeouts; }
+
+    /// \return The timeouts of the connection.
+    inline const timeouts_t& timeouts() const { return m_timeouts; }
+
+    /// \copydoc event_task::handle_event
+    bool handle_event(tasks::worker* worker, int revents);
+
+    /// An HTTP request handler needs to implement this. This method gets called after a request has been parsed
+    /// successfully. The request stays valid until the response has been sent.
+    virtual bool handle_request() = 0;
+
+    /// Enable or disable persistent connections. If disabled the connection is closed after each response.
+    inline void set_keep_alive(bool keep_alive) { m_keep_alive = keep_alive; }
+
+    /// \return True if persistent connections are enabled.
+    inline bool keep_alive() const { return m_keep_alive; }
+
+    /// \return A reference to the underlying request object.
+    inline http_server_request& request() { return m_request; }
+
+    /// \return A const reference to the underlying request object.
+    inline const http_server_request& request() const { return m_request; }
+
+    /// \return A pointer to the underlying request onject.
+    inline http_server_request* request_p() { return &m_request; }
+
+    /// \return A const pointer to the underlying request onject.
+    inline const http_server_request* request_p() const { return &m_request; }
+
+    /// \return A reference to the underlying response object.
+    inline http_response& response() { return m_response; }
+
+    /// \return A const reference to the underlying response object.
+    inline const http_response& response() const { return m_response; }
+
+    /// \return A pointer to the underlying response onject.
+    inline http_response* response_p() { return &m_response; }
+
+    /// \return A const pointer to the underlying response onject.
+    inline const http_response* response_p() const { return &m_response; }
+
+    /// Send the resonse back.
+    void send_response();
+
+  protected:
+    http_server_request m_request;
+    http_response m_response;
+
+    /// Called after a request has been responded.
+    inline void finish_request() { m_response.clear(); }
+
+  private:
+    static timeouts_t m_default_timeouts;
+    bool m_keep_alive = true;
+    bool m_reject = false;
+    timeouts_t m_timeouts;
+
+    /// \return True if the connection will be kept open after the current response.
+    inline bool reuse_connection() const { return m_keep_alive && !m_reject && m_request.keep_alive(); }
+
+    /// Answer a request that exceeds a limit of the http_server_request.
+    ///
+    /// \param e The error of the request.
+    /// \return False if the error is not about a limit.
+    bool reject_request(const tasks_exception& e);
+};
+
+}  // net
+}  // tasks
+
+#endif  // _HTTP_SERVER_TASK_H_
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _HTTP_SINGLEFLIGHT_H_
+#define _HTTP_SINGLEFLIGHT_H_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <tasks/tasks_exception.h>
+#include <tasks/net/http_base.h>
+#include <tasks/net/http_request.h>
+#include <tasks/net/http_response.h>
+
+namespace tasks {
+
+class worker;
+
+namespace net {
+
+/// Coalesces identical requests that are in flight at the same time.
+///
+/// The first request for a key is sent upstream, requests with the same key that are made before its response has
+/// arrived just wait for it. All waiters get the same response object, so it must not be modified. The callback of
+/// each waiter runs in the context of the worker that made the request.
+///
+///   static http_singleflight flights;
+///   flights.send(std::make_shared<http_request>("backend", "/popular"),
+///                [this](std::shared_ptr<http_response> response, const tasks_exception& e) { ... });
+///
+/// Only requests without a body are coalesced. A request with a body, which http_request sends as POST, may have side
+/// effects and could carry a different body than the request in flight, so it is always sent upstream on its own.
+///
+/// An http_singleflight is usually shared by all handlers of a process and can be used from any thread. It has to
+/// outlive the requests it sends.
+class http_singleflight {
+  public:
+    using response_func_t = std::function<void(std::shared_ptr<http_response>, const tasks_exception&)>;
+
+    /// Send a request or wait for an identical one. The key is built from the method, host, port and URL. Requests
+    /// with a body are sent without coalescing.
+    ///
+    /// \param request The request.
+    /// \param f The callback. The response is null if the error code is set.
+    /// \return True if the request has been sent upstream, false if it waits for a request in flight.
+    bool send(std::shared_ptr<http_request> request, response_func_t f);
+
+    /// Send a request or wait for one with the same key.
+    ///
+    /// \param key The key that identifies identical requests.
+    /// \param request The request.
+    /// \param f The callback. The response is null if the error code is set.
+    /// \return True if the request has been sent upstream, false if it waits for a request in flight.
+    bool send(const std::string& key, std::shared_ptr<http_base> request, response_func_t f);
+
+    /// \return The number of keys with a request in flight.
+    std::size_t in_flight() const;
+
+    /// \return The key of a request, built from its method, host, port and URL. The body is not part of the key.
+    static std::string key(const http_request& request);
+
+  private:
+    struct waiter {
+        response_func_t func;
+        worker* origin;
+    };
+
+    struct flight {
+        std::vector<waiter> waiters;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<flight>> m_flights;
+
+    /// Remove a flight and pass the response to its waiters.
+    void complete(const std::string& key, std::shared_ptr<flight> f, std::shared_ptr<http_response> response,
+                  const tasks_exception& e);
+};
+
+}  // net
+}  // tasks
+
+#endif  // _HTTP_SINGLEFLIGHT_H_
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _RESPONSE_CACHE_H_
+#define _RESPONSE_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tasks {
+namespace net {
+
+class uwsgi_request;
+
+/// A cache for serialized responses of uwsgi_task handlers.
+///
+/// GET requests are looked up by the values of a set of uwsgi vars, by default HTTP_HOST and REQUEST_URI. On a hit the
+/// uwsgi_task writes the cached bytes without calling handle_request(). Otherwise the response of the handler gets
+/// stored after it has been written, if its status is 200 and it is not private. Responses with a Set-Cookie or Vary
+/// header or a Cache-Control header with no-store or private are never stored. The Date and Connection headers of the first response are not stored,
+/// the uwsgi_task writes a current Date header with every cached response.
+///
+/// Entries expire after a TTL. The cache is split into shards with a lock and an LRU list each, so workers rarely
+/// wait for each other. Each shard evicts its least recently used entries when it exceeds its share of the byte
+/// budget.
+///
+///   static auto cache = std::make_shared<response_cache>(64 * 1024 * 1024, 2.);
+///   uwsgi_task::set_default_response_cache(cache);
+class response_cache {
+  public:
+    using entry_t = std::shared_ptr<const std::string>;
+
+    /// \param max_bytes The byte budget for all entries.
+    /// \param ttl The time in seconds an entry is valid.
+    /// \param key_vars The uwsgi vars that identify a response.
+    /// \param shards The number of shards, rounded up to a power of two.
+    response_cache(std::size_t max_bytes, double ttl, std::vector<std::string> key_vars = {"HTTP_HOST", "REQUEST_URI"},
+                   std::size_t shards = 16);
+
+    /// Build the cache key for a request.
+    ///
+    /// \param request The request.
+    /// \param key The key.
+    /// \return False if the request can't be cached.
+    bool key(const uwsgi_request& request, std::string& key) const;
+
+    /// Look up a response.
+    ///
+    /// \param key The key.
+    /// \return The serialized response or nullptr.
+    entry_t get(const std::string& key);
+
+    /// Store a response.
+    ///
+    /// \param key The key.
+    /// \param bytes The serialized response.
+    void put(const std::string& key, std::string bytes);
+
+    /// Remove all entries.
+    void clear();
+
+    /// \return The number of entries.
+    std::size_t size() const;
+
+    /// \return The number of bytes of all entries.
+    std::size_t bytes() const;
+
+    /// \return The number of hits.
+    inline uint64_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+
+    /// \return The number of misses.
+    inline uint64_t misses() const { return m_misses.load(std::memory_order_relaxed); }
+
+  private:
+    struct entry {
+        std::string key;
+        entry_t bytes;
+        int64_t expires_ms;
+    };
+
+    struct shard {
+        mutable std::mutex mutex;
+        std::list<entry> lru;  // most recently used first
+        std::unordered_map<std::string, std::list<entry>::iterator> index;
+        std::size_t bytes = 0;
+    };
+
+    std::vector<std::string> m_key_vars;
+    int64_t m_ttl_ms;
+    std::size_t m_shard_bytes;
+    std::vector<std::unique_ptr<shard>> m_shards;
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+
+    inline shard& get_shard(const std::string& key) {
+        return *m_shards[std::hash<std::string>()(key) & (m_shards.size() - 1)];
+    }
+
+    /// Remove an entry. Has to be called with the shard mutex held.
+    void erase(shard& s, std::list<entry>::iterator it);
+};
+
+}  // net
+}  // tasks
+
+#endif  // _RESPONSE_CACHE_H_
@@ -14,6 +14,7 @@
 #include <cerrno>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include <tasks/io_base.h>
 #include <tasks/tasks_exception.h>
@@ -87,13 +88,24 @@ class socket : public io_base {
     /// Connect to a domain socket.
     ///
     /// \param path The path to the socket file.
-    void connect(const std::string& path);
+    /// \param wait If false, the connect does not block. If it is still in progress, it has to be completed by
+    ///   finish_connect() when the socket becomes writable.
+    /// \return True if the connection has been established, false if it is in progress.
+    bool connect(const std::string& path, bool wait = true);
 
     /// Connect via tcp.
     ///
     /// \param host The hostname or ip address in dot notation.
     /// \param port The port.
-    void connect(const std::string& host, int port);
+    /// \param wait If false, the connect does not block. If it is still in progress, it has to be completed by
+    ///   finish_connect() when the socket becomes writable.
+    /// \return True if the connection has been established, false if it is in progress.
+    bool connect(const std::string& host, int port, bool wait = true);
+
+    /// Complete a connect that has been in progress after the socket became writable.
+    ///
+    /// \throws tasks_exception with SOCKET_CONNECT if the connection could not be established.
+    void finish_connect();
 
     /// Call shutdown on the fd.
     void shutdown();
@@ -106,6 +118,12 @@ class socket : public io_base {
     /// \param ip Optional ip in dot notation for UDP writes.
     std::streamsize write(const char* data, std::size_t len, int port = -1, std::string ip = "");
 
+    /// Write multiple blocks to a connected socket with a single system call.
+    ///
+    /// \param iov The blocks to write.
+    /// \param iovcnt The number of blocks.
+    std::streamsize writev(const struct iovec* iov, int iovcnt);
+
     /// Read data from a socket.
     ///
     /// \param data A pointer to the destination data.
@@ -119,6 +137,8 @@ class socket : public io_base {
 
     void bind(int port, const std::string& ip, bool udp);
     void init_sockaddr(int port, std::string ip = "");
+    bool connect(const struct sockaddr* addr, socklen_t addr_len, bool wait);
+    void set_nonblocking();
 };
 
 }  // net
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _THRIFT_ASYNC_CLIENT_H_
+#define _THRIFT_ASYNC_CLIENT_H_
+
+#include <boost/shared_ptr.hpp>
+#include <thrift/Thrift.h>
+#include <thrift/TApplicationException.h>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+#include <tasks/future.h>
+#include <tasks/net/thrift_client_pool.h>
+#include <tasks/net/thrift_frame_buffer.h>
+#include <tasks/net/thrift_protocol.h>
+#include <tasks/net/uwsgi_thrift_transport.h>
+
+namespace tasks {
+namespace net {
+
+/// A non-blocking thrift client for servers that use TFramedTransport, like the thrift_server_task.
+///
+/// Calls are multiplexed over a thrift_client_pool and never block the calling thread. The argument and result types
+/// are the ones thrift generates for each service method, e.g. IpService_lookup_args and IpService_lookup_result:
+///
+///   thrift_async_client client("localhost", 9090);
+///   IpService_lookup_args args;
+///   args.ipv4 = ip;
+///   using lookup_value = thrift_async_client::result_value<IpService_lookup_result>::type;
+///   client.call<IpService_lookup_result>("lookup", args, [](lookup_value& r, const tasks_exception& e) {
+///       ...
+///   });
+///
+/// Callbacks run in the worker thread that handles the connection. The std::future variant can be used from threads
+/// that are allowed to wait, like exec tasks. async_call() returns a tasks::future instead, that never blocks. Only
+/// methods with a return value are supported.
+class thrift_async_client {
+  public:
+    using transport_type = uwsgi_thrift_transport<thrift_frame_buffer>;
+
+    /// The type of the success field of a thrift generated result.
+    template <class result_type>
+    struct result_value {
+        using type = typename std::decay<decltype(std::declval<result_type>().success)>::type;
+    };
+
+    /// \copydoc thrift_client_pool::thrift_client_pool(const std::string&, int, std::size_t)
+    thrift_async_client(const std::string& host, int port, std::size_t max_connections = 4)
+        : m_pool(host, port, max_connections) {
+        init();
+    }
+
+    /// \copydoc thrift_client_pool::thrift_client_pool(const std::string&, std::size_t)
+    thrift_async_client(const std::string& path, std::size_t max_connections = 4) : m_pool(path, max_connections) {
+        init();
+    }
+
+    /// \copydoc thrift_client_pool::thrift_client_pool(std::shared_ptr<backend_group>, std::size_t)
+    thrift_async_client(std::shared_ptr<backend_group> group, std::size_t max_connections = 4)
+        : m_pool(group, max_connections) {
+        init();
+    }
+
+    /// Select the protocol. Default is thrift_protocol::BINARY.
+    inline void set_protocol(thrift_protocol p) { m_protocol = p; }
+
+    /// \return The protocol.
+    inline thrift_protocol protocol() const { return m_protocol; }
+
+    /// Call a service method.
+    ///
+    /// \param method The method name.
+    /// \param args The thrift generated arguments.
+    /// \param f The callback. It gets the success field of the result and an exception object that is set if the call
+    ///   failed. The result is undefined on errors.
+    template <class result_type, class args_type>
+    void call(const std::string& method, const args_type& args,
+              std::function<void(typename result_value<result_type>::type&, const tasks_exception&)> f) {
+        int32_t seqid = m_seqid++;
+        thrift_protocol p = m_protocol;
+        auto reply = [f, p](thrift_frame_buffer* buf, const tasks_exception& e) {
+            result_type result;
+            if (e.error_code() != tasks_error::UNSET) {
+                f(result.success, e);
+                return;
+            }
+            tasks_exception error;
+            read_result(buf, p, result, error);
+            f(result.success, error);
+        };
+        tasks_exception error;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            try {
+                tools::buffer& buf = m_frame.content_buffer();
+                buf.clear();
+                const boost::shared_ptr<apache::thrift::protocol::TProtocol>& out = m_protocols->out(p);
+                out->writeMessageBegin(method, apache::thrift::protocol::T_CALL, seqid);
+                args.write(out.get());
+                out->writeMessageEnd();
+                m_pool.send(buf.ptr_read(), buf.to_read(), seqid, reply);
+            } catch (tasks_exception& e) {
+                error = e;
+            } catch (apache::thrift::TException& e) {
+                error = tasks_exception(tasks_error::THRIFT_CLIENT, e.what());
+            }
+        }
+        // Report errors without holding the lock, the callback may issue the next call.
+        if (error.error_code() != tasks_error::UNSET) {
+            reply(nullptr, error);
+        }
+    }
+
+    /// Call a service method.
+    ///
+    /// \param method The method name.
+    /// \param args The thrift generated arguments.
+    /// \return A future for the success field of the result. Errors are reported as tasks_exception.
+    template <class result_type, class args_type>
+    std::future<typename result_value<result_type>::type> call(const std::string& method, const args_type& args) {
+        using value_type = typename result_value<result_type>::type;
+        auto promise = std::make_shared<std::promise<value_type>>();
+        call<result_type>(method, args, [promise](value_type& v, const tasks_exception& e) {
+            if (e.error_code() != tasks_error::UNSET) {
+                promise->set_exception(std::make_exception_ptr(e));
+            } else {
+                promise->set_value(std::move(v));
+            }
+        });
+        return promise->get_future();
+    }
+
+    /// Call a service method without blocking.
+    ///
+    /// \param method The method name.
+    /// \param args The thrift generated arguments.
+    /// \return A tasks::future for the success field of the result. Continuations run in the calling worker.
+    template <class result_type, class args_type>
+    tasks::future<typename result_value<result_type>::type> async_call(const std::string& method,
+                                                                       const args_type& args) {
+        using value_type = typename result_value<result_type>::type;
+        tasks::promise<value_type> p;
+        call<result_type>(method, args, [p](value_type& v, const tasks_exception& e) mutable {
+            if (e.error_code() != tasks_error::UNSET) {
+                p.set_exception(e);
+            } else {
+                p.set_value(std::move(v));
+            }
+        });
+        return p.get_future();
+    }
+
+    /// \return The connection pool.
+    inline thrift_client_pool& pool() { return m_pool; }
+
+  private:
+    thrift_client_pool m_pool;
+    thrift_protocol m_protocol = thrift_protocol::BINARY;
+    std::atomic<int32_t> m_seqid{0};
+    // The calls are serialized into m_frame before they get copied to a connection.
+    std::mutex m_mutex;
+    thrift_frame_buffer m_frame;
+    std::unique_ptr<thrift_protocol_set<transport_type, transport_type>> m_protocols;
+
+    inline void init() {
+        boost::shared_ptr<transport_type> transport(new transport_type(&m_frame));
+        m_protocols.reset(new thrift_protocol_set<transport_type, transport_type>(transport, transport));
+    }
+
+    /// Deserialize a reply.
+    template <class result_type>
+    static void read_result(thrift_frame_buffer* buf, thrift_protocol p, result_type& result,
+                            tasks_exception& error) {
+        using namespace apache::thrift::protocol;
+        // The reply is read in place from the connection buffer.
+        boost::shared_ptr<transport_type> transport(new transport_type(buf));
+        thrift_protocol_set<transport_type, transport_type> protocols(transport, transport);
+        const boost::shared_ptr<TProtocol>& in = protocols.in(p);
+        try {
+            std::string fname;
+            TMessageType mtype;
+            int32_t seqid;
+            in->readMessageBegin(fname, mtype, seqid);
+            if (T_EXCEPTION == mtype) {
+                apache::thrift::TApplicationException ae;
+                ae.read(in.get());
+                in->readMessageEnd();
+                error = tasks_exception(tasks_error::THRIFT_CLIENT, ae.what());
+            } else if (T_REPLY != mtype) {
+                error = tasks_exception(tasks_error::THRIFT_CLIENT, "invalid message type");
+            } else {
+                result.read(in.get());
+                in->readMessageEnd();
+                if (!result.__isset.success) {
+                    error = tasks_exception(tasks_error::THRIFT_CLIENT, fname + " failed: unknown result");
+                }
+            }
+        } catch (apache::thrift::TException& e) {
+            error = tasks_exception(tasks_error::THRIFT_CLIENT, e.what());
+        }
+    }
+};
+
+}  // net
+}  // tasks
+
+#endif  // _THRIFT_ASYNC_CLIENT_H_
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _THRIFT_CLIENT_CONNECTION_H_
+#define _THRIFT_CLIENT_CONNECTION_H_
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include <tasks/net_io_task.h>
+#include <tasks/net/thrift_frame_buffer.h>
+
+namespace tasks {
+namespace net {
+
+/// A persistent TFramedTransport connection to a thrift server.
+///
+/// Calls can be sent from any thread. Each call is identified by its seqid, so many calls can be in flight on one
+/// connection and the replies can arrive in any order. The reply callbacks run in the worker thread that handles the
+/// connection. The connection does not depend on thrift, it only reads the seqid from the message header. See
+/// thrift_async_client for the typed interface.
+///
+/// The connection is established without blocking the calling thread. Calls that are sent before it completes are
+/// buffered. If the connect fails, they fail with SOCKET_CONNECT.
+class thrift_client_connection : public net_io_task {
+  public:
+    /// Called with the reply message or an error. On success the read position of the reply buffer points to the
+    /// message. On errors reply is nullptr.
+    using reply_func_t = std::function<void(thrift_frame_buffer* reply, const tasks_exception& e)>;
+
+    /// Called when the connection gets closed.
+    using close_func_t = std::function<void(thrift_client_connection* conn)>;
+
+    /// Connect to a tcp server. Only the host name lookup blocks.
+    thrift_client_connection(const std::string& host, int port);
+
+    /// Connect to a unix domain socket.
+    thrift_client_connection(const std::string& path);
+
+    virtual ~thrift_client_connection() {}
+
+    inline std::string get_string() const {
+        std::ostringstream os;
+        os << "thrift_client_connection(" << this << ")";
+        return os.str();
+    }
+
+    /// \copydoc event_task::handle_event
+    bool handle_event(tasks::worker* worker, int revents);
+
+    /// Initialize the watcher when the connection gets added to the task system. Calls that are sent afterwards
+    /// update the watcher in the event loop.
+    void init_watcher();
+
+    /// Send a call. Calls can be sent before the connection has been added to the task system.
+    ///
+    /// \param data The serialized message.
+    /// \param len The message length.
+    /// \param seqid The seqid the message has been serialized with.
+    /// \param f The reply callback.
+    /// \return False if the connection has been closed. The callback will not be called in this case.
+    bool send(const char* data, std::size_t len, int32_t seqid, reply_func_t f);
+
+    /// \return The number of calls waiting for a reply.
+    std::size_t pending() const;
+
+    /// \return True if the connection has been closed.
+    bool closed() const;
+
+    /// Set a callback that gets called when the connection has been closed. Must be set before the connection gets
+    /// added to the task system.
+    inline void on_close(close_func_t f) { m_close_func = f; }
+
+    /// Shut the connection down. All calls in flight fail.
+    void shutdown();
+
+    /// Read the seqid from the header of a binary or compact message.
+    ///
+    /// \param data The message.
+    /// \param len The message length.
+    /// \param seqid Gets set to the seqid.
+    /// \return False if the header is invalid.
+    static bool parse_seqid(const char* data, std::size_t len, int32_t& seqid);
+
+  private:
+    thrift_frame_buffer m_in;
+    thrift_frame_buffer m_out;
+    std::unordered_map<int32_t, reply_func_t> m_calls;
+    bool m_connecting = false;
+    bool m_added = false;
+    bool m_closed = false;
+    close_func_t m_close_func;
+    // Guards the output buffer, the calls and the watcher events against senders in other threads.
+    mutable std::mutex m_mutex;
+
+    /// Pass all complete replies to their callbacks.
+    void dispatch_replies();
+
+    /// Fail all calls in flight and notify the close callback.
+    void close_connection(const tasks_exception& e);
+
+    /// Watch the socket for the events the connection is waiting for. Has to be called with the mutex held.
+    ///
+    /// \param worker The worker of the connection or nullptr if the connection has not been added yet.
+    void update_events(worker* worker);
+};
+
+}  // net
+}  // tasks
+
+#endif  // _THRIFT_CLIENT_CONNECTION_H_
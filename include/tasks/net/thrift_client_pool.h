@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _THRIFT_CLIENT_POOL_H_
+#define _THRIFT_CLIENT_POOL_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <tasks/net/backend_group.h>
+#include <tasks/net/thrift_client_connection.h>
+
+// The number of connections a call is tried on before it fails, if connections close while it is being sent.
+#define THRIFT_CLIENT_POOL_SEND_ATTEMPTS 3
+
+namespace tasks {
+namespace net {
+
+/// A pool of persistent connections to one thrift server.
+///
+/// Calls are sent over the connection with the fewest calls in flight. A new connection is opened when all
+/// connections are busy and the pool has not reached its maximum size, otherwise the calls are multiplexed over the
+/// existing connections. Closed connections are removed from the pool and replaced on demand.
+///
+/// A pool that is created with a backend_group keeps connections to all replicas of the group and lets the group pick
+/// the endpoint for each call. The outcome of the calls is reported back to the group.
+class thrift_client_pool {
+  public:
+    /// A pool for a tcp server.
+    ///
+    /// \param host The server host.
+    /// \param port The server port.
+    /// \param max_connections The maximum number of connections.
+    thrift_client_pool(const std::string& host, int port, std::size_t max_connections = 4);
+
+    /// A pool for a unix domain socket server.
+    ///
+    /// \param path The socket path.
+    /// \param max_connections The maximum number of connections.
+    thrift_client_pool(const std::string& path, std::size_t max_connections = 4);
+
+    /// A pool for the replicas of a backend group.
+    ///
+    /// \param group The backend group.
+    /// \param max_connections The maximum number of connections per endpoint.
+    thrift_client_pool(std::shared_ptr<backend_group> group, std::size_t max_connections = 4);
+
+    /// Shuts all connections down. Calls in flight fail.
+    ~thrift_client_pool();
+
+    /// Send a call. See thrift_client_connection::send.
+    ///
+    /// \throws tasks_exception if no connection could be established or the connections kept closing.
+    void send(const char* data, std::size_t len, int32_t seqid, thrift_client_connection::reply_func_t f);
+
+    /// \return The number of open connections.
+    std::size_t connections() const;
+
+  private:
+    // The state is shared with the close callbacks of the connections, which can run after the pool is gone.
+    struct state {
+        std::mutex mutex;
+        std::vector<backend_group::endpoint> endpoints;
+        // The connections per endpoint
+        std::vector<std::vector<thrift_client_connection*>> conns;
+        std::shared_ptr<backend_group> group;
+        std::size_t max_connections;
+    };
+    std::shared_ptr<state> m_state;
+
+    void init(std::vector<backend_group::endpoint> endpoints, std::size_t max_connections);
+
+    /// Pick a connection to an endpoint or open a new one. Has to be called with the mutex held.
+    thrift_client_connection* get_connection(std::size_t idx);
+};
+
+}  // net
+}  // tasks
+
+#endif  // _THRIFT_CLIENT_POOL_H_
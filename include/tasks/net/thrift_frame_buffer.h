@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _THRIFT_FRAME_BUFFER_H_
+#define _THRIFT_FRAME_BUFFER_H_
+
+#include <tasks/tools/buffer.h>
+#include <tasks/net/socket.h>
+
+// Frames bigger than this are rejected and the connection gets closed.
+#ifndef THRIFT_MAX_FRAME
+#define THRIFT_MAX_FRAME (16 * 1024 * 1024)
+#endif
+
+#define THRIFT_READ_BLOCK 4096
+
+namespace tasks {
+namespace net {
+
+/// The buffer of a TFramedTransport connection. It provides the content_buffer() interface the uwsgi_thrift_transport
+/// expects, so protocols can read and write frames in place.
+class thrift_frame_buffer {
+  public:
+    inline tools::buffer& content_buffer() { return m_buffer; }
+
+    inline const tools::buffer& content_buffer() const { return m_buffer; }
+
+    /// \return True if there is unread data.
+    inline bool pending() const { return m_buffer.to_read() > 0; }
+
+    /// Read the available data from a socket. Reading stops when a frame of THRIFT_MAX_FRAME bytes could be complete,
+    /// and it fails as soon as the length of the next frame exceeds THRIFT_MAX_FRAME.
+    void read_data(socket& sock);
+
+    /// Write as much unread data to a socket as possible.
+    void write_data(socket& sock);
+
+    /// Check for a complete frame at the read position. If there is one its length field gets consumed, so the read
+    /// position points to the message.
+    ///
+    /// \param frame_end Gets set to the offset of the first byte after the frame.
+    /// \return True if a complete frame is available.
+    bool next_frame(std::size_t& frame_end);
+
+    /// Move the unread data to the start of the buffer.
+    void compact();
+
+    /// Start a new frame at the end of the buffer.
+    ///
+    /// \return The offset of the frame.
+    std::size_t begin_frame();
+
+    /// Fill in the length of a frame after the message has been written.
+    ///
+    /// \param start The offset returned by begin_frame().
+    void end_frame(std::size_t start);
+
+  private:
+    tools::buffer m_buffer;
+
+    /// \return The length of the frame at the read position. At least four bytes have to be unread.
+    uint32_t frame_length() const;
+};
+
+}  // net
+}  // tasks
+
+#endif  // _THRIFT_FRAME_BUFFER_H_
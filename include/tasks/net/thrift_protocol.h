@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _THRIFT_PROTOCOL_H_
+#define _THRIFT_PROTOCOL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <boost/shared_ptr.hpp>
+#include <thrift/protocol/TBinaryProtocol.h>
+#include <thrift/protocol/TCompactProtocol.h>
+
+#include <tasks/net/uwsgi_request.h>
+#include <tasks/tools/string_view.h>
+
+namespace tasks {
+namespace net {
+
+/// The supported thrift protocols.
+enum class thrift_protocol : uint8_t { BINARY, COMPACT };
+
+#define THRIFT_CONTENT_TYPE_BINARY "application/x-thrift"
+#define THRIFT_CONTENT_TYPE_BINARY_VND "application/vnd.apache.thrift.binary"
+#define THRIFT_CONTENT_TYPE_COMPACT "application/vnd.apache.thrift.compact"
+
+/// \return The content type of a protocol.
+inline const char* thrift_content_type(thrift_protocol p) {
+    return thrift_protocol::COMPACT == p ? THRIFT_CONTENT_TYPE_COMPACT : THRIFT_CONTENT_TYPE_BINARY;
+}
+
+/// Find the first thrift protocol in a Content-Type or Accept value.
+///
+/// \param value The header value.
+/// \param p Gets set to the protocol if one has been found.
+/// \return True if a thrift content type has been found.
+inline bool thrift_protocol_from_mime(tools::string_view value, thrift_protocol& p) {
+    std::size_t compact = value.find(THRIFT_CONTENT_TYPE_COMPACT);
+    std::size_t binary = std::min(value.find(THRIFT_CONTENT_TYPE_BINARY), value.find(THRIFT_CONTENT_TYPE_BINARY_VND));
+    if (tools::string_view::npos == compact && tools::string_view::npos == binary) {
+        return false;
+    }
+    p = compact < binary ? thrift_protocol::COMPACT : thrift_protocol::BINARY;
+    return true;
+}
+
+/// Select the protocols for a thrift call over uwsgi.
+///
+/// The request protocol is taken from CONTENT_TYPE and defaults to the binary protocol. The response uses the first
+/// thrift protocol listed in HTTP_ACCEPT or the request protocol.
+///
+/// \param request The request.
+/// \param in Gets set to the protocol of the request.
+/// \param out Gets set to the protocol of the response.
+inline void negotiate_thrift_protocol(const uwsgi_request& request, thrift_protocol& in, thrift_protocol& out) {
+    in = thrift_protocol::BINARY;
+    thrift_protocol_from_mime(request.var(uwsgi_var::CONTENT_TYPE), in);
+    out = in;
+    thrift_protocol_from_mime(request.var(uwsgi_var::HTTP_ACCEPT), out);
+}
+
+/// Lazily created protocol objects for a pair of transports.
+///
+/// The protocols are instantiated for the concrete transport types, so they use the borrow/consume fast path of the
+/// transports without virtual calls.
+template <class in_transport_type, class out_transport_type>
+class thrift_protocol_set {
+  public:
+    using protocol_ptr_t = boost::shared_ptr<apache::thrift::protocol::TProtocol>;
+
+    thrift_protocol_set(boost::shared_ptr<in_transport_type> in, boost::shared_ptr<out_transport_type> out)
+        : m_in_transport(in), m_out_transport(out) {}
+
+    /// \return The protocol object to read a request.
+    inline const protocol_ptr_t& in(thrift_protocol p) { return get(m_in, m_in_transport, p); }
+
+    /// \return The protocol object to write a response.
+    inline const protocol_ptr_t& out(thrift_protocol p) { return get(m_out, m_out_transport, p); }
+
+  private:
+    boost::shared_ptr<in_transport_type> m_in_transport;
+    boost::shared_ptr<out_transport_type> m_out_transport;
+    protocol_ptr_t m_in[2];
+    protocol_ptr_t m_out[2];
+
+    template <class transport_type>
+    inline const protocol_ptr_t& get(protocol_ptr_t* protocols, boost::shared_ptr<transport_type>& transport,
+                                     thrift_protocol p) {
+        using namespace apache::thrift::protocol;
+        protocol_ptr_t& proto = protocols[static_cast<std::size_t>(p)];
+        if (nullptr == proto) {
+            if (thrift_protocol::COMPACT == p) {
+                proto.reset(new TCompactProtocolT<transport_type>(transport));
+            } else {
+                proto.reset(new TBinaryProtocolT<transport_type>(transport));
+            }
+        }
+        return proto;
+    }
+};
+
+}  // net
+}  // tasks
+
+#endif  // _THRIFT_PROTOCOL_H_
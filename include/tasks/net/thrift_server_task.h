@@ -0,0 +1,324 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _THRIFT_SERVER_TASK_H_
+#define _THRIFT_SERVER_TASK_H_
+
+#include <boost/shared_ptr.hpp>
+#include <thrift/Thrift.h>
+#include <thrift/TApplicationException.h>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <tasks/dispatcher.h>
+#include <tasks/worker.h>
+#include <tasks/net_io_task.h>
+#include <tasks/net/thrift_frame_buffer.h>
+#include <tasks/net/thrift_protocol.h>
+#include <tasks/net/uwsgi_thrift_handler_traits.h>
+#include <tasks/net/uwsgi_thrift_transport.h>
+#include <tasks/logging.h>
+#include <tasks/tools/buffer.h>
+
+// No further frames are dispatched while this many calls of a connection are running.
+#ifndef THRIFT_SERVER_MAX_IN_FLIGHT
+#define THRIFT_SERVER_MAX_IN_FLIGHT 128
+#endif
+
+namespace tasks {
+namespace net {
+
+/// A thrift server that speaks TFramedTransport directly over TCP or unix domain sockets.
+///
+/// The task takes the same asynchronous handlers as the uwsgi_thrift_async_processor, so a service can be served via
+/// uwsgi and natively at the same time:
+///
+///   dispatcher::instance()->add_task(new acceptor<thrift_server_task<my_async_handler>>(9090));
+///
+/// Connections are persistent. Each frame is dispatched as soon as it has been read, so a client can have several
+/// calls in flight and match the replies by seqid. Replies are written in the order the handlers finish. The binary
+/// and the compact protocol are detected per frame and the reply uses the protocol of the call.
+///
+/// Handlers served by this task have no uwsgi request or response, so they must not use request() or response().
+///
+/// A connection gets closed when it exceeds a timeout: idle while no call is running, read while a frame has been read
+/// partially, request while calls are running and write while a reply can't be written.
+template <class handler_type>
+class thrift_server_task : public net_io_task {
+  public:
+    using transport_type = uwsgi_thrift_transport<thrift_frame_buffer>;
+    using protocol_set_type = thrift_protocol_set<transport_type, transport_type>;
+
+    thrift_server_task(net::socket& s) : net_io_task(s, EV_READ), m_timeouts(m_default_timeouts) {
+        boost::shared_ptr<transport_type> in_transport(new transport_type(&m_in));
+        boost::shared_ptr<transport_type> out_transport(new transport_type(&m_out));
+        m_protocols.reset(new protocol_set_type(in_transport, out_transport));
+        arm_deadline(m_timeouts.idle);
+        tdbg(get_string() << ": ctor" << std::endl);
+    }
+
+    virtual ~thrift_server_task() { tdbg(get_string() << ": dtor" << std::endl); }
+
+    inline std::string get_string() const {
+        std::ostringstream os;
+        os << "thrift_server_task(" << this << ")";
+        return os.str();
+    }
+
+    /// Set the timeout defaults for new connections.
+    static void set_default_timeouts(const timeouts_t& timeouts) { m_default_timeouts = timeouts; }
+
+    /// Set the timeouts of the connection. They apply from the next event of the connection on.
+    inline void set_timeouts(const timeouts_t& timeouts) { m_timeouts = timeouts; }
+
+    /// \return The timeouts of the connection.
+    inline const timeouts_t& timeouts() const { return m_timeouts; }
+
+    /// \copydoc event_task::handle_event
+    bool handle_event(tasks::worker* worker, int revents) {
+        bool success = true;
+        try {
+            if (EV_READ & revents) {
+                m_in.read_data(socket());
+            }
+            if (EV_WRITE & revents) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_out.write_data(socket());
+            }
+            dispatch_frames();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            update_events(worker);
+        } catch (tasks::tasks_exception& e) {
+            if (tasks_error::SOCKET_NOCON == e.error_code()) {
+                tdbg(get_string() << ": client disconnected" << std::endl);
+            } else {
+                tdbg(get_string() << ": exception: " << e.what() << std::endl);
+                set_exception(e);
+            }
+            success = false;
+        }
+        if (!success) {
+            // Calls that are still running finish without writing a reply.
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        return success;
+    }
+
+  private:
+    /// The state of a dispatched call. A call slot owns its handler and is reused for later calls.
+    struct call {
+        std::unique_ptr<handler_type> handler;
+        int32_t seqid = 0;
+        thrift_protocol protocol = thrift_protocol::BINARY;
+        bool oneway = false;
+    };
+
+    static timeouts_t m_default_timeouts;
+    timeouts_t m_timeouts;
+    thrift_frame_buffer m_in;
+    thrift_frame_buffer m_out;
+    std::unique_ptr<protocol_set_type> m_protocols;
+    std::vector<std::unique_ptr<call>> m_calls;
+    std::vector<call*> m_free_calls;
+    std::size_t m_in_flight = 0;
+    bool m_blocked = false;  // complete frames wait for a free call slot
+    bool m_closed = false;
+    // Guards the reply buffer, the call slots and the watcher events against handlers that finish in other threads.
+    std::mutex m_mutex;
+
+    /// Dispatch all complete frames in the input buffer.
+    void dispatch_frames() {
+        bool blocked = false;
+        std::size_t frame_end;
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_in_flight >= THRIFT_SERVER_MAX_IN_FLIGHT) {
+                    blocked = m_in.pending();
+                    break;
+                }
+            }
+            if (!m_in.next_frame(frame_end)) {
+                break;
+            }
+            dispatch(frame_end);
+            // Skip whatever the protocol did not consume.
+            m_in.content_buffer().move_ptr_read_abs(frame_end);
+        }
+        // Keep the unread part of the next frame at the start of the buffer.
+        m_in.compact();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_blocked = blocked;
+    }
+
+    /// Deserialize a call and pass it to a handler.
+    ///
+    /// \param frame_end The offset of the end of the frame.
+    void dispatch(std::size_t frame_end) {
+        tools::buffer& buf = m_in.content_buffer();
+        thrift_protocol p = thrift_protocol::BINARY;
+        if (frame_end > buf.offset_read() && static_cast<uint8_t>(*buf.ptr_read()) == 0x82) {
+            // The first byte of a compact message is the protocol id, binary messages start with 0x80.
+            p = thrift_protocol::COMPACT;
+        }
+        const boost::shared_ptr<apache::thrift::protocol::TProtocol>& in = m_protocols->in(p);
+        call* c = acquire_call();
+        c->protocol = p;
+        std::string fname;
+        try {
+            apache::thrift::protocol::TMessageType mtype;
+            in->readMessageBegin(fname, mtype, c->seqid);
+            if (mtype != apache::thrift::protocol::T_CALL && mtype != apache::thrift::protocol::T_ONEWAY) {
+                reply_error(c, fname, "invalid message type");
+            } else if (!c->handler->select(fname)) {
+                reply_error(c, fname, "invalid method name");
+            } else {
+                c->oneway = apache::thrift::protocol::T_ONEWAY == mtype;
+                c->handler->read_args(in.get());
+                in->readMessageEnd();
+                tdbg(get_string() << ": calling " << fname << " on handler " << c->handler.get()
+                                  << " seqid=" << c->seqid << std::endl);
+                c->handler->call();
+            }
+        } catch (apache::thrift::TException& e) {
+            reply_error(c, fname, std::string("TException: ") + e.what());
+        }
+    }
+
+    /// Get a free call slot and count the call as in flight.
+    call* acquire_call() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        call* c;
+        if (m_free_calls.empty()) {
+            m_calls.emplace_back(new call());
+            c = m_calls.back().get();
+        } else {
+            c = m_free_calls.back();
+            m_free_calls.pop_back();
+        }
+        if (nullptr == c->handler || !uwsgi_thrift_handler_reuse<handler_type>::value) {
+            c->handler.reset(new handler_type());
+            tdbg(get_string() << ": created handler " << c->handler.get() << std::endl);
+            c->handler->on_finish([this, c] { call_finished(c); });
+        } else {
+            c->handler->reset();
+        }
+        c->oneway = false;
+        if (0 == m_in_flight++) {
+            // Make sure the task is kept until all handlers have finished.
+            disable_dispose();
+        }
+        return c;
+    }
+
+    /// Answer a call that can't be passed to the handler.
+    void reply_error(call* c, const std::string& fname, const std::string& msg) {
+        tdbg(get_string() << ": " << msg << std::endl);
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            write_error(c, fname, msg);
+            m_free_calls.push_back(c);
+            last = 0 == --m_in_flight;
+        }
+        if (last) {
+            enable_dispose();
+        }
+    }
+
+    /// Called by a handler when a call has finished. This can happen in any thread.
+    void call_finished(call* c) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_closed && !c->oneway) {
+                write_reply(c);
+            }
+        }
+        // The watcher belongs to the event loop of the worker. The call stays in flight until the events have been
+        // updated, so the task is kept until then.
+        worker* worker = dispatcher::instance()->get_worker_by_task(this);
+        worker->exec_in_worker_ctx([this, c, worker](struct ev_loop*) {
+            bool last;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_free_calls.push_back(c);
+                last = 0 == --m_in_flight;
+                if (!m_closed) {
+                    update_events(worker);
+                }
+            }
+            // Allow cleanup now. The task can be gone right after this.
+            if (last) {
+                enable_dispose();
+            }
+        });
+    }
+
+    /// Append a framed reply to the output buffer.
+    void write_reply(call* c) {
+        const boost::shared_ptr<apache::thrift::protocol::TProtocol>& out = m_protocols->out(c->protocol);
+        std::size_t start = m_out.begin_frame();
+        if (c->handler->error()) {
+            tdbg(get_string() << ": handler " << c->handler.get() << " finished with error("
+                              << c->handler->error() << "): " << c->handler->error_message() << std::endl);
+            apache::thrift::TApplicationException ae(c->handler->error_message());
+            out->writeMessageBegin(c->handler->service_name(), apache::thrift::protocol::T_EXCEPTION, c->seqid);
+            ae.write(out.get());
+        } else {
+            out->writeMessageBegin(c->handler->service_name(), apache::thrift::protocol::T_REPLY, c->seqid);
+            c->handler->write_result(out.get());
+        }
+        out->writeMessageEnd();
+        m_out.end_frame(start);
+    }
+
+    /// Append a framed exception to the output buffer.
+    void write_error(call* c, const std::string& fname, const std::string& msg) {
+        const boost::shared_ptr<apache::thrift::protocol::TProtocol>& out = m_protocols->out(c->protocol);
+        std::size_t start = m_out.begin_frame();
+        apache::thrift::TApplicationException ae(msg);
+        out->writeMessageBegin(fname, apache::thrift::protocol::T_EXCEPTION, c->seqid);
+        ae.write(out.get());
+        out->writeMessageEnd();
+        m_out.end_frame(start);
+    }
+
+    /// Watch the socket for the events the connection is waiting for and arm the deadline of the phase the connection
+    /// is in. Has to be called in the worker with the mutex held.
+    void update_events(worker* worker) {
+        int events = EV_NONE;
+        if (m_in_flight < THRIFT_SERVER_MAX_IN_FLIGHT) {
+            events |= EV_READ;
+        }
+        // Buffered frames that could not be dispatched yet are picked up after the next write.
+        if (m_out.pending() || (m_blocked && m_in_flight < THRIFT_SERVER_MAX_IN_FLIGHT)) {
+            events |= EV_WRITE;
+        }
+        set_events(events);
+        update_watcher(worker);
+        if (m_out.pending()) {
+            arm_deadline(m_timeouts.write);
+        } else if (m_in_flight > 0) {
+            arm_deadline(m_timeouts.request);
+        } else if (m_in.pending()) {
+            arm_deadline(m_timeouts.read > 0. ? m_timeouts.read : m_timeouts.idle);
+        } else {
+            arm_deadline(m_timeouts.idle);
+        }
+    }
+};
+
+template <class handler_type>
+typename thrift_server_task<handler_type>::timeouts_t thrift_server_task<handler_type>::m_default_timeouts;
+
+}  // net
+}  // tasks
+
+#endif  // _THRIFT_SERVER_TASK_H_
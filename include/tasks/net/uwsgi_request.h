@@ -17,18 +17,31 @@
 #include <tasks/tasks_exception.h>
 #include <tasks/net/socket.h>
 #include <tasks/net/uwsgi_structs.h>
+#include <tasks/net/uwsgi_vars.h>
 #include <tasks/net/io_state.h>
 #include <tasks/net/http_base.h>
 #include <tasks/tools/buffer.h>
+#include <tasks/tools/string_view.h>
 
 namespace tasks {
 namespace net {
 
+/// Controls how a uwsgi_request stores the parsed variables.
+enum class uwsgi_parse_mode : uint8_t {
+    /// Copy all variables into the headers map (default).
+    COPY,
+    /// Keep the variables as views into the received packet. Well known variables end up in fixed slots, all others
+    /// in a fallback table. No allocations happen while parsing. The headers map is filled lazily on the first call
+    /// to var(const std::string&) or vars().
+    ZERO_COPY
+};
+
 /// The uwsgi protocol implementation for a request. The response is a HTTP/1.1 response.
 class uwsgi_request : public http_base {
   public:
     /// For backward compatibility.
     using uwsgi_vars_t = http_base::headers_t;
+    using var_view_t = std::pair<tools::string_view, tools::string_view>;
 
     static std::string NO_VAL;
 
@@ -47,11 +60,18 @@ class uwsgi_request : public http_base {
     /// The path interface for unix domain socket connections.
     const std::string& path() const { return m_path; }
 
+    /// Set the parse mode. See uwsgi_parse_mode for details.
+    inline void set_parse_mode(uwsgi_parse_mode mode) { m_parse_mode = mode; }
+
+    /// \return The parse mode.
+    inline uwsgi_parse_mode parse_mode() const { return m_parse_mode; }
+
     /// Provide access to uwsgi parameters.
     ///
     /// \param key The parameter name.
     /// \return The parameter value.
     inline const std::string& var(const std::string& key) const {
+        materialize_vars();
         const std::string& val = header(key);
         if (val == http_base::NO_VAL) {
             return NO_VAL;
@@ -59,8 +79,28 @@ class uwsgi_request : public http_base {
         return val;
     }
 
+    /// Provide access to a well known uwsgi parameter. This is an index read and works in all parse modes.
+    ///
+    /// \param key The parameter.
+    /// \return A view to the parameter value. The view is empty if the parameter has not been passed and stays valid
+    ///   until the request gets cleared.
+    inline tools::string_view var(uwsgi_var key) const { return m_var_slots[static_cast<std::size_t>(key)]; }
+
+    /// Provide access to uwsgi parameters without copying them.
+    ///
+    /// \param key The parameter name.
+    /// \return A view to the parameter value. The view is empty if the parameter has not been passed and stays valid
+    ///   until the request gets cleared.
+    tools::string_view var_view(tools::string_view key) const;
+
     /// \return The parameter map.
-    inline const uwsgi_vars_t& vars() const { return headers(); }
+    inline const uwsgi_vars_t& vars() const {
+        materialize_vars();
+        return headers();
+    }
+
+    /// \return The parameters that are not well known and have no slot. Only filled in uwsgi_parse_mode::ZERO_COPY.
+    inline const std::vector<var_view_t>& other_vars() const { return m_var_fallback; }
 
     inline void print_header() const {
         std::cout << "header:"
@@ -69,7 +109,7 @@ class uwsgi_request : public http_base {
     }
 
     inline void print_vars() const {
-        for (auto& kv : headers()) {
+        for (auto& kv : vars()) {
             std::cout << kv.first << " = " << kv.second << std::endl;
         }
     }
@@ -84,10 +124,19 @@ class uwsgi_request : public http_base {
     inline void clear() {
         http_base::clear();
         m_header = {0, 0, 0};
+        for (auto& v : m_var_slots) {
+            v.clear();
+        }
+        m_var_fallback.clear();
+        m_vars_materialized = false;
     }
 
   private:
     uwsgi_packet_header m_header;
+    uwsgi_parse_mode m_parse_mode = uwsgi_parse_mode::COPY;
+    tools::string_view m_var_slots[uwsgi_vars::COUNT];
+    std::vector<var_view_t> m_var_fallback;
+    bool m_vars_materialized = false;
     std::string m_host = http_base::NO_VAL;
     std::string m_path = http_base::NO_VAL;
     int m_port = -1;
@@ -101,9 +150,12 @@ class uwsgi_request : public http_base {
     /// Read POST data into the content buffer.
     void read_content(socket& sock);
 
-    /// Parse the uswgi parameters into a hash map.
+    /// Parse the uswgi parameters into a hash map and/or the variable slots.
     void parse_vars();
 
+    /// Copy the variable views into the headers map. This is a no-op in uwsgi_parse_mode::COPY.
+    void materialize_vars() const;
+
     /// \copydoc http_base::prepare_data_buffer()
     void prepare_data_buffer();
 };
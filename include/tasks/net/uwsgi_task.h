@@ -17,21 +17,74 @@
 #include <tasks/net_io_task.h>
 #include <tasks/net/uwsgi_request.h>
 #include <tasks/net/http_response.h>
-
-// The nginx uwsgi module does not support keepalive connections. If
-// this gets implemented one day or we find a different webserver that
-// supports this, we can enable the following flag.
-#define UWSGI_KEEPALIVE 0
+#include <tasks/net/response_cache.h>
 
 namespace tasks {
 namespace net {
 
 /// The base class for the uwsgi protocol implementation.
+///
+/// By default the connection is closed after each response. With keep-alive enabled (e.g. for nginx upstreams with a
+/// "keepalive" pool), multiple requests are served per connection. Pipelined requests are handled one after the
+/// other: no further request is read until the response to the current one has been written, so the responses go
+/// out in order.
+///
+/// Each phase of a connection can have a timeout: waiting for a request (idle), reading a request (read), creating
+/// the response (request) and writing it (write). Connections that exceed a timeout get closed. The timeouts are
+/// tracked by a single deadline per connection in the timer wheel of the worker.
+///
+/// With a response_cache, cached responses are written directly from the cache without calling handle_request().
 class uwsgi_task : public tasks::net_io_task {
   public:
-    uwsgi_task(net::socket& sock) : tasks::net_io_task(sock, EV_READ) {}
+    uwsgi_task(net::socket& sock)
+        : tasks::net_io_task(sock, EV_READ),
+          m_keep_alive(m_default_keep_alive),
+          m_timeouts(m_default_timeouts),
+          m_cache(m_default_cache) {
+        arm_deadline(m_timeouts.idle);
+    }
+
     virtual ~uwsgi_task() {}
 
+    /// Set the keep-alive default for new connections.
+    static void set_default_keep_alive(bool keep_alive) { m_default_keep_alive = keep_alive; }
+
+    /// Set the idle timeout default for new connections.
+    static void set_default_idle_timeout(double timeout) { m_default_timeouts.idle = timeout; }
+
+    /// Set the timeout defaults for new connections.
+    static void set_default_timeouts(const timeouts_t& timeouts) { m_default_timeouts = timeouts; }
+
+    /// Set the response cache default for new connections.
+    static void set_default_response_cache(std::shared_ptr<response_cache> cache) { m_default_cache = cache; }
+
+    /// Set the response cache or nullptr to disable caching.
+    inline void set_response_cache(std::shared_ptr<response_cache> cache) { m_cache = cache; }
+
+    /// Don't store the response to the current request in the response cache.
+    inline void skip_response_cache() { m_cache_key.clear(); }
+
+    /// Enable or disable persistent connections.
+    inline void set_keep_alive(bool keep_alive) { m_keep_alive = keep_alive; }
+
+    /// \return True if the connection is kept open after a response.
+    inline bool keep_alive() const { return m_keep_alive; }
+
+    /// Set the time in seconds a connection can wait for a request before it gets closed. 0 disables the timeout.
+    inline void set_idle_timeout(double timeout) {
+        m_timeouts.idle = timeout;
+        arm_deadline(m_timeouts.idle);
+    }
+
+    /// \return The idle timeout in seconds.
+    inline double idle_timeout() const { return m_timeouts.idle; }
+
+    /// Set the timeouts of the connection. They apply from the next phase of the connection on.
+    inline void set_timeouts(const timeouts_t& timeouts) { m_timeouts = timeouts; }
+
+    /// \return The timeouts of the connection.
+    inline const timeouts_t& timeouts() const { return m_timeouts; }
+
     /// \copydoc event_task::handle_event
     bool handle_event(tasks::worker* worker, int revents);
 
@@ -69,6 +122,7 @@ class uwsgi_task : public tasks::net_io_task {
         assert(nullptr != w);
         set_events(EV_WRITE);
         update_watcher(w);
+        arm_deadline(m_timeouts.write);
     }
 
   protected:
@@ -77,6 +131,37 @@ class uwsgi_task : public tasks::net_io_task {
 
     /// Called after a request has been responded.
     inline void finish_request() { m_response.clear(); }
+
+  private:
+    static bool m_default_keep_alive;
+    static timeouts_t m_default_timeouts;
+    static std::shared_ptr<response_cache> m_default_cache;
+    bool m_keep_alive;
+    timeouts_t m_timeouts;
+    std::shared_ptr<response_cache> m_cache;
+    std::string m_cache_key;          // set while a cacheable response is being created
+    response_cache::entry_t m_cached;  // set while a cached response is being written
+    std::size_t m_cached_offset = 0;   // counts the Date header as well
+    std::size_t m_cached_split = 0;    // the end of the status line, where the Date header goes
+    std::string m_cached_date;
+
+    /// Look up the current request in the response cache. On a miss the key is kept to store the response.
+    ///
+    /// \return True if a cached response has been found.
+    bool lookup_cached();
+
+    /// Store the response that has been written in the response cache.
+    void store_cached();
+
+    /// Continue writing a cached response.
+    ///
+    /// \return True if the response has been written completely.
+    bool write_cached();
+
+    /// Prepare the connection for the next request after a response has been written.
+    ///
+    /// \return False if the connection gets closed.
+    bool response_written(tasks::worker* worker);
 };
 
 }  // net
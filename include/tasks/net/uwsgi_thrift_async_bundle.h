@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _UWSGI_THRIFT_ASYNC_BUNDLE_H_
+#define _UWSGI_THRIFT_ASYNC_BUNDLE_H_
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include <tasks/net/uwsgi_task.h>
+#include <tasks/net/uwsgi_thrift_handler_traits.h>
+
+namespace tasks {
+namespace net {
+
+/// Compile time perfect hash over the method names of a handler bundle.
+namespace thrift_methods {
+
+constexpr uint8_t EMPTY = 0xff;
+
+/// The number of seeds that are tried to find a perfect hash.
+constexpr uint32_t MAX_SEED = 1024;
+
+constexpr std::size_t length(const char* s) {
+    std::size_t len = 0;
+    while (s[len]) {
+        len++;
+    }
+    return len;
+}
+
+constexpr uint32_t hash(const char* s, std::size_t len, uint32_t seed) {
+    // FNV-1a
+    uint32_t h = 2166136261u ^ seed;
+    for (std::size_t i = 0; i < len; i++) {
+        h = (h ^ static_cast<uint8_t>(s[i])) * 16777619u;
+    }
+    return h;
+}
+
+/// \return The smallest power of two that is at least twice as big as n.
+constexpr std::size_t table_size(std::size_t n) {
+    std::size_t size = 1;
+    while (size < 2 * n) {
+        size <<= 1;
+    }
+    return size;
+}
+
+template <std::size_t N>
+struct table_t {
+    static constexpr std::size_t SIZE = table_size(N);
+    uint8_t slots[SIZE];
+    uint32_t seed;
+    bool perfect;
+};
+
+/// Find a seed that maps all names to different slots.
+template <std::size_t N>
+constexpr table_t<N> make_table(const char* const (&names)[N]) {
+    table_t<N> t{{0}, 0, false};
+    for (uint32_t seed = 0; seed < MAX_SEED; seed++) {
+        for (std::size_t i = 0; i < table_t<N>::SIZE; i++) {
+            t.slots[i] = EMPTY;
+        }
+        t.seed = seed;
+        t.perfect = true;
+        for (std::size_t i = 0; i < N && t.perfect; i++) {
+            std::size_t h = hash(names[i], length(names[i]), seed) & (table_t<N>::SIZE - 1);
+            if (EMPTY != t.slots[h]) {
+                t.perfect = false;
+            }
+            t.slots[h] = static_cast<uint8_t>(i);
+        }
+        if (t.perfect) {
+            break;
+        }
+    }
+    return t;
+}
+
+}  // thrift_methods
+
+/// Combines several asynchronous handlers, one per thrift method, to serve a whole thrift service on one endpoint.
+///
+/// A bundle can be used everywhere a single uwsgi_thrift_async_handler is expected:
+///
+///   using my_service = uwsgi_thrift_async_bundle<lookup_handler, update_handler>;
+///   dispatcher::instance()->add_task(new acceptor<uwsgi_thrift_async_processor<my_service>>(12345));
+///
+/// Each handler provides its method name via a static constexpr method_name(). The names are hashed into a perfect
+/// hash table at compile time, so finding the handler for a message costs one hash over the name and one string
+/// compare, independent of the number of methods. The handlers are created when their method is called the first
+/// time. They are kept for the following calls if uwsgi_thrift_handler_reuse is true for them.
+template <class... handler_types>
+class uwsgi_thrift_async_bundle {
+  public:
+    using handler_finish_func_t = std::function<void()>;
+    using handlers_t = std::tuple<std::unique_ptr<handler_types>...>;
+
+    static constexpr std::size_t COUNT = sizeof...(handler_types);
+    static_assert(COUNT > 0, "uwsgi_thrift_async_bundle: no handlers");
+    static_assert(COUNT < thrift_methods::EMPTY, "uwsgi_thrift_async_bundle: too many handlers");
+
+    static constexpr const char* names[COUNT] = {handler_types::method_name()...};
+    static constexpr thrift_methods::table_t<COUNT> table = thrift_methods::make_table(names);
+    static_assert(table.perfect, "uwsgi_thrift_async_bundle: no perfect hash found, duplicate method names?");
+
+    /// Find the handler index for a method name.
+    ///
+    /// \param name The method name.
+    /// \return The index of the handler or COUNT if no handler implements the method.
+    static std::size_t lookup(const std::string& name) {
+        uint32_t h = thrift_methods::hash(name.data(), name.size(), table.seed);
+        uint8_t idx = table.slots[h & (thrift_methods::table_t<COUNT>::SIZE - 1)];
+        if (thrift_methods::EMPTY != idx && !name.compare(names[idx])) {
+            return idx;
+        }
+        return COUNT;
+    }
+
+    /// Select the handler for a call.
+    ///
+    /// \param name The method name of the message.
+    /// \return True if a handler implements the method.
+    bool select(const std::string& name) {
+        m_current = lookup(name);
+        if (COUNT == m_current) {
+            return false;
+        }
+        select(std::index_sequence_for<handler_types...>());
+        return true;
+    }
+
+    /// Reset the selected handler.
+    void reset() {
+        if (COUNT != m_current) {
+            visit([](auto& h) { h.reset(); });
+        }
+        m_current = COUNT;
+    }
+
+    /// Read the arguments of a call into the selected handler.
+    template <class protocol_type>
+    void read_args(protocol_type* in) {
+        visit([in](auto& h) { h.read_args(in); });
+    }
+
+    /// Call the selected handler.
+    void call() {
+        visit([](auto& h) { h.call(); });
+    }
+
+    /// Write the result of the selected handler.
+    template <class protocol_type>
+    void write_result(protocol_type* out) {
+        visit([out](auto& h) { h.write_result(out); });
+    }
+
+    /// \return The method name of the selected handler.
+    std::string service_name() const {
+        assert(COUNT != m_current);
+        return names[m_current];
+    }
+
+    /// \return True if the selected handler reported an error.
+    bool error() {
+        bool err = false;
+        visit([&err](auto& h) { err = h.error(); });
+        return err;
+    }
+
+    /// \return The error message of the selected handler.
+    std::string error_message() {
+        std::string msg;
+        visit([&msg](auto& h) { msg = h.error_message(); });
+        return msg;
+    }
+
+    /// Assign the uwsgi_task to all handlers.
+    void set_uwsgi_task(uwsgi_task* t) { m_uwsgi_task = t; }
+
+    /// Set the finish callback for all handlers.
+    void on_finish(handler_finish_func_t f) { m_finish_func = f; }
+
+  private:
+    handlers_t m_handlers;
+    std::size_t m_current = COUNT;
+    uwsgi_task* m_uwsgi_task = nullptr;
+    handler_finish_func_t m_finish_func;
+
+    /// Create the selected handler if needed.
+    template <std::size_t... I>
+    void select(std::index_sequence<I...>) {
+        using func_t = void (*)(uwsgi_thrift_async_bundle&);
+        static constexpr func_t funcs[] = {&uwsgi_thrift_async_bundle::create<I>...};
+        funcs[m_current](*this);
+    }
+
+    template <std::size_t I>
+    static void create(uwsgi_thrift_async_bundle& b) {
+        auto& h = std::get<I>(b.m_handlers);
+        using handler_type = typename std::tuple_element<I, std::tuple<handler_types...>>::type;
+        if (nullptr == h || !uwsgi_thrift_handler_reuse<handler_type>::value) {
+            h.reset(new handler_type());
+            h->set_uwsgi_task(b.m_uwsgi_task);
+            h->on_finish([&b] { b.m_finish_func(); });
+        }
+    }
+
+    /// Apply a function to the selected handler. The handler is found via a jump table over the handler types.
+    template <class F>
+    void visit(F f) {
+        assert(COUNT != m_current);
+        visit(f, std::index_sequence_for<handler_types...>());
+    }
+
+    template <class F, std::size_t... I>
+    void visit(F& f, std::index_sequence<I...>) {
+        using func_t = void (*)(handlers_t&, F&);
+        static constexpr func_t funcs[] = {&uwsgi_thrift_async_bundle::apply<F, I>...};
+        funcs[m_current](m_handlers, f);
+    }
+
+    template <class F, std::size_t I>
+    static void apply(handlers_t& handlers, F& f) {
+        f(*std::get<I>(handlers));
+    }
+};
+
+template <class... handler_types>
+constexpr const char* uwsgi_thrift_async_bundle<handler_types...>::names[];
+
+template <class... handler_types>
+constexpr thrift_methods::table_t<uwsgi_thrift_async_bundle<handler_types...>::COUNT>
+    uwsgi_thrift_async_bundle<handler_types...>::table;
+
+/// A bundle is always kept, it decides per handler whether to reuse it.
+template <class... handler_types>
+struct uwsgi_thrift_handler_reuse<uwsgi_thrift_async_bundle<handler_types...>> : std::true_type {};
+
+}  // net
+}  // tasks
+
+#endif  // _UWSGI_THRIFT_ASYNC_BUNDLE_H_
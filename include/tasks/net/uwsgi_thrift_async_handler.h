@@ -18,6 +18,11 @@ namespace net {
 
 /// The base class for asynchronous thrift handlers. The two template arguments have to match the thrift generated
 /// types. A handler also has to implement a service and a service_name method. See below.
+///
+/// Handlers that are combined in a \link uwsgi_thrift_async_bundle \endlink additionally provide the method name at
+/// compile time:
+///
+///   static constexpr const char* method_name() { return "lookup"; }
 template <class thrift_result_type,  // generated by thrift
           class thrift_args_type>    // generated by thrift
 class uwsgi_thrift_async_handler : public tasks::error_base {
@@ -28,6 +33,7 @@ class uwsgi_thrift_async_handler : public tasks::error_base {
 
   private:
     result_t m_result;
+    std::shared_ptr<args_t> m_args;
     uwsgi_task* m_uwsgi_task = nullptr;
     handler_finish_func_t m_finish_func;
 
@@ -71,6 +77,42 @@ class uwsgi_thrift_async_handler : public tasks::error_base {
     /// Return a reference to the thrift result object. A thrift handler uses this to return data.
     inline auto result() -> decltype((m_result.success)) { return m_result.success; }
 
+    /// Reset the result and the error state. The \link uwsgi_thrift_async_processor \endlink calls this before a
+    /// handler object gets reused for the next request of a connection. Handlers that keep per request state can
+    /// override it, but have to call the base implementation.
+    virtual void reset() {
+        m_result = result_t();
+        m_args.reset();
+        reset_error();
+    }
+
+    /// Select the handler for a call. The processors use this to check the method name of a message.
+    ///
+    /// \param name The method name of the message.
+    /// \return True if the handler implements the method.
+    inline bool select(const std::string& name) { return name == service_name(); }
+
+    /// Read the arguments of a call.
+    ///
+    /// \param in The protocol to read from.
+    template <class protocol_type>
+    inline void read_args(protocol_type* in) {
+        m_args = std::make_shared<args_t>();
+        m_args->read(in);
+    }
+
+    /// Call the service method with the arguments read by read_args().
+    inline void call() { service(m_args); }
+
+    /// Write the result of a call.
+    ///
+    /// \param out The protocol to write to.
+    template <class protocol_type>
+    inline void write_result(protocol_type* out) {
+        m_result.__isset.success = true;
+        m_result.write(out);
+    }
+
     /// The \link uwsgi_thrift_async_processor \endlink uses this method to assign the underlying uwsgi_task object.
     inline void set_uwsgi_task(uwsgi_task* t) { m_uwsgi_task = t; }
 
@@ -11,13 +11,14 @@
 #include <arpa/inet.h>
 #include <boost/shared_ptr.hpp>
 #include <thrift/Thrift.h>
-#include <thrift/protocol/TBinaryProtocol.h>
 #include <thrift/TApplicationException.h>
 #include <unordered_set>
 #include <future>
 #include <sstream>
 
+#include <tasks/net/thrift_protocol.h>
 #include <tasks/net/uwsgi_task.h>
+#include <tasks/net/uwsgi_thrift_handler_traits.h>
 #include <tasks/net/uwsgi_thrift_transport.h>
 #include <tasks/logging.h>
 
@@ -33,7 +34,7 @@ class uwsgi_thrift_async_processor : public uwsgi_task {
   public:
     using in_transport_type = uwsgi_thrift_transport<uwsgi_request>;
     using out_transport_type = uwsgi_thrift_transport<http_response>;
-    using protocol_type = TBinaryProtocol;
+    using protocol_set_type = thrift_protocol_set<in_transport_type, out_transport_type>;
 
     uwsgi_thrift_async_processor(net::socket& s) : uwsgi_task(s) { tdbg(get_string() << ": ctor" << std::endl); }
 
@@ -47,68 +48,51 @@ class uwsgi_thrift_async_processor : public uwsgi_task {
 
     /// \copydoc uwsgi_task::handle_request
     virtual bool handle_request() {
-        boost::shared_ptr<in_transport_type> in_transport(new in_transport_type(request_p()));
-        boost::shared_ptr<out_transport_type> out_transport(new out_transport_type(response_p()));
-        boost::shared_ptr<protocol_type> in_protocol(new protocol_type(in_transport));
-        boost::shared_ptr<protocol_type> out_protocol(new protocol_type(out_transport));
+        // The transports and protocols are bound to the request and response objects of this task, so they can be
+        // kept for all requests of the connection.
+        if (nullptr == m_protocols) {
+            boost::shared_ptr<in_transport_type> in_transport(new in_transport_type(request_p()));
+            boost::shared_ptr<out_transport_type> out_transport(new out_transport_type(response_p()));
+            m_protocols.reset(new protocol_set_type(in_transport, out_transport));
+        }
+        thrift_protocol in_protocol;
+        negotiate_thrift_protocol(request(), in_protocol, m_out_protocol_id);
+        m_in_protocol = m_protocols->in(in_protocol);
+        m_out_protocol = m_protocols->out(m_out_protocol_id);
 
         // Process message
-        m_handler.reset(new handler_type());
-        tdbg(get_string() << ": created handler " << m_handler.get() << std::endl);
-        m_handler->set_uwsgi_task(this);
-        m_handler->on_finish([this, out_protocol] {
-            if (m_handler->error()) {
-                tdbg(get_string() << ": handler " << m_handler.get() << " finished with error(" << m_handler->error()
-                                  << "): " << m_handler->error_message() << std::endl);
-                write_thrift_error(std::string("Handler Error: ") + m_handler->error_message(),
-                                   m_handler->service_name(), out_protocol);
-            } else {
-                tdbg(get_string() << ": handler " << m_handler.get() << " finished with no error" << std::endl);
-                // Fill the response back in.
-                out_protocol->writeMessageBegin(m_handler->service_name(), T_REPLY, m_seqid);
-                m_handler->result_base().__isset.success = true;
-                m_handler->result_base().write(out_protocol.get());
-                out_protocol->writeMessageEnd();
-                out_protocol->getTransport()->writeEnd();
-                out_protocol->getTransport()->flush();
-                response().set_status("200 OK");
-            }
-            response().set_header("Content-Type", "application/x-thrift");
-            // Make sure we run in the context of a worker thread
-            if (error_code() == tasks_error::UNSET) {
-                worker* worker = dispatcher::instance()->get_worker_by_task(this);
-                worker->exec_in_worker_ctx([this](struct ev_loop*) {
-                    send_response();
-                });
-            }
-            // Allow cleanup now
-            enable_dispose();
-        });
+        if (nullptr == m_handler || !uwsgi_thrift_handler_reuse<handler_type>::value) {
+            m_handler.reset(new handler_type());
+            tdbg(get_string() << ": created handler " << m_handler.get() << std::endl);
+            m_handler->set_uwsgi_task(this);
+            m_handler->on_finish([this] { handler_finished(); });
+        } else {
+            m_handler->reset();
+        }
 
+        std::string fname;
         try {
-            std::string fname;
             TMessageType mtype;
-            in_protocol->readMessageBegin(fname, mtype, m_seqid);
+            m_in_protocol->readMessageBegin(fname, mtype, m_seqid);
             if (mtype != protocol::T_CALL && mtype != protocol::T_ONEWAY) {
-                write_thrift_error("invalid message type", m_handler->service_name(), out_protocol);
+                write_thrift_error("invalid message type", fname, m_out_protocol);
                 send_thrift_response();
-            } else if (fname != m_handler->service_name()) {
-                write_thrift_error("invalid method name", m_handler->service_name(), out_protocol);
+            } else if (!m_handler->select(fname)) {
+                write_thrift_error("invalid method name", fname, m_out_protocol);
                 send_thrift_response();
             } else {
                 // read the args from the request
-                auto args = std::make_shared<typename handler_type::args_t>();
-                args->read(in_protocol.get());
-                in_protocol->readMessageEnd();
-                in_protocol->getTransport()->readEnd();
+                m_handler->read_args(m_in_protocol.get());
+                m_in_protocol->readMessageEnd();
+                m_in_protocol->getTransport()->readEnd();
                 // Make sure the object is kept until the m_handler finishes
                 disable_dispose();
                 // Call the m_handler
                 tdbg(get_string() << ": calling service on handler " << m_handler.get() << std::endl);
-                m_handler->service(args);
+                m_handler->call();
             }
         } catch (TException& e) {
-            write_thrift_error(std::string("TException: ") + e.what(), m_handler->service_name(), out_protocol);
+            write_thrift_error(std::string("TException: ") + e.what(), fname, m_out_protocol);
             send_thrift_response();
         }
 
@@ -117,7 +101,7 @@ class uwsgi_thrift_async_processor : public uwsgi_task {
 
     /// Send the thrift response back to the caller.
     inline void send_thrift_response() {
-        response().set_header("Content-Type", "application/x-thrift");
+        response().set_header("Content-Type", thrift_content_type(m_out_protocol_id));
         send_response();
     }
 
@@ -127,7 +111,7 @@ class uwsgi_thrift_async_processor : public uwsgi_task {
     /// \param service_name The name of the thrift service
     /// \param out_protocol The outgoing protocol object
     inline void write_thrift_error(std::string msg, std::string service_name,
-                                   boost::shared_ptr<protocol_type> out_protocol) {
+                                   boost::shared_ptr<TProtocol> out_protocol) {
         response().set_header("X-UWSGI_THRIFT_ASYNC_PROCESSOR_ERROR", msg);
         response().set_status("400 Bad Request");
         TApplicationException ae(msg);
@@ -141,6 +125,42 @@ class uwsgi_thrift_async_processor : public uwsgi_task {
   private:
     int32_t m_seqid = 0;
     std::unique_ptr<handler_type> m_handler;
+    std::unique_ptr<protocol_set_type> m_protocols;
+    boost::shared_ptr<TProtocol> m_in_protocol;
+    boost::shared_ptr<TProtocol> m_out_protocol;
+    thrift_protocol m_out_protocol_id = thrift_protocol::BINARY;
+
+    /// Called by the handler when the service call has finished.
+    void handler_finished() {
+        if (m_handler->error()) {
+            tdbg(get_string() << ": handler " << m_handler.get() << " finished with error(" << m_handler->error()
+                              << "): " << m_handler->error_message() << std::endl);
+            write_thrift_error(std::string("Handler Error: ") + m_handler->error_message(), m_handler->service_name(),
+                               m_out_protocol);
+        } else {
+            tdbg(get_string() << ": handler " << m_handler.get() << " finished with no error" << std::endl);
+            // Fill the response back in.
+            m_out_protocol->writeMessageBegin(m_handler->service_name(), T_REPLY, m_seqid);
+            m_handler->write_result(m_out_protocol.get());
+            m_out_protocol->writeMessageEnd();
+            m_out_protocol->getTransport()->writeEnd();
+            m_out_protocol->getTransport()->flush();
+            response().set_status("200 OK");
+        }
+        response().set_header("Content-Type", thrift_content_type(m_out_protocol_id));
+        // Make sure we run in the context of a worker thread
+        if (error_code() == tasks_error::UNSET) {
+            worker* worker = dispatcher::instance()->get_worker_by_task(this);
+            worker->exec_in_worker_ctx([this](struct ev_loop*) {
+                send_response();
+                // Allow cleanup now. If the task has been removed meanwhile, it is deleted right here.
+                enable_dispose();
+            });
+        } else {
+            // Allow cleanup now
+            enable_dispose();
+        }
+    }
 };
 
 }  // net
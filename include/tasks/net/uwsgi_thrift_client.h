@@ -9,6 +9,11 @@
 #define _UWSGI_THRIFT_CLIENT_H_
 
 #include <thrift/transport/TVirtualTransport.h>
+#include <chrono>
+#include <memory>
+
+#include <tasks/net/backend_group.h>
+#include <tasks/net/thrift_protocol.h>
 #include <tasks/net/uwsgi_request.h>
 #include <tasks/net/http_response.h>
 #include <tasks/net/socket.h>
@@ -17,29 +22,57 @@ namespace tasks {
 namespace net {
 
 /// A uwsgi blocking client.
+///
+/// The client is a transport, so the protocol is chosen by wrapping it into a TBinaryProtocol or TCompactProtocol.
+/// The chosen protocol has to be announced via set_protocol() to let the server respond with the same encoding.
+///
+/// A client that is created with a backend_group connects to the endpoint the group picks for each call.
 class uwsgi_thrift_client
     : public apache::thrift::transport::TVirtualTransport<uwsgi_thrift_client> {
   public:
     uwsgi_thrift_client(const std::string& host, int port) : m_request(host, port) {}
     uwsgi_thrift_client(const std::string& path) : m_request(path) {}
-    ~uwsgi_thrift_client() {}
+    uwsgi_thrift_client(std::shared_ptr<backend_group> group) : m_request(http_base::NO_VAL), m_group(group) {}
+    ~uwsgi_thrift_client() { cancel_backend(); }
 
     uint32_t read(uint8_t* data, int32_t size) { return m_response.read((char*)data, size); }
 
     void write(const uint8_t* data, uint32_t size) { m_request.write((const char*)data, size); }
 
     uint32_t readEnd() {
+        uint32_t bytes = static_cast<uint32_t>(m_response.content_length());
         m_request.clear();
         m_response.clear();
         // no keep alive for now
         m_socket.close();
-        open();
+        if (nullptr != m_group) {
+            release_backend(true);
+            // The next call picks its endpoint when it is flushed.
+        } else {
+            open();
+        }
+        return bytes;
     }
 
     void open() {
         if (!isOpen()) {
             m_socket.set_blocking();
-            if (m_request.host() != http_base::NO_VAL) {
+            if (nullptr != m_group) {
+                m_backend = m_group->acquire();
+                m_backend_start = std::chrono::steady_clock::now();
+                const backend_group::endpoint& ep = m_group->get_endpoint(m_backend);
+                try {
+                    if (ep.tcp()) {
+                        m_socket.connect(ep.host, ep.port);
+                    } else {
+                        m_socket.connect(ep.path);
+                    }
+                } catch (tasks_exception&) {
+                    m_socket.close();
+                    release_backend(false);
+                    throw;
+                }
+            } else if (m_request.host() != http_base::NO_VAL) {
                 m_socket.connect(m_request.host(), m_request.port());
             } else if (m_request.path() != http_base::NO_VAL) {
                 m_socket.connect(m_request.path());
@@ -47,14 +80,38 @@ class uwsgi_thrift_client
         }
     }
 
-    void close() { m_socket.close(); }
+    void close() {
+        m_socket.close();
+        cancel_backend();
+    }
+
+    /// Announce the protocol of the requests and the expected protocol of the responses to the server.
+    ///
+    /// \param p The protocol. Default is thrift_protocol::BINARY.
+    void set_protocol(thrift_protocol p) { m_protocol = p; }
+
+    /// \return The announced protocol.
+    thrift_protocol protocol() const { return m_protocol; }
 
     bool isOpen() { return m_socket.fd() != -1; }
 
     void flush() {
-        m_request.write_data(m_socket);
-        while (!m_response.done()) {
-            m_response.read_data(m_socket);
+        m_request.set_header("CONTENT_TYPE", thrift_content_type(m_protocol));
+        m_request.set_header("HTTP_ACCEPT", thrift_content_type(m_protocol));
+        if (nullptr == m_group) {
+            send();
+            return;
+        }
+        open();
+        try {
+            send();
+        } catch (tasks_exception&) {
+            // Report the failed endpoint, the next call connects again.
+            m_socket.close();
+            m_request.clear();
+            m_response.clear();
+            release_backend(false);
+            throw;
         }
     }
 
@@ -62,6 +119,33 @@ class uwsgi_thrift_client
     uwsgi_request m_request;
     http_response m_response;
     socket m_socket;
+    thrift_protocol m_protocol = thrift_protocol::BINARY;
+    std::shared_ptr<backend_group> m_group;
+    std::size_t m_backend = backend_group::NONE;
+    std::chrono::steady_clock::time_point m_backend_start;
+
+    inline void send() {
+        m_request.write_data(m_socket);
+        while (!m_response.done()) {
+            m_response.read_data(m_socket);
+        }
+    }
+
+    /// Report the outcome of the current call to the backend group.
+    inline void release_backend(bool success) {
+        if (backend_group::NONE != m_backend) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_backend_start).count();
+            m_group->release(m_backend, seconds, success);
+            m_backend = backend_group::NONE;
+        }
+    }
+
+    inline void cancel_backend() {
+        if (backend_group::NONE != m_backend) {
+            m_group->cancel(m_backend);
+            m_backend = backend_group::NONE;
+        }
+    }
 };
 
 }  // net
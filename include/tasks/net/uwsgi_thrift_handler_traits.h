@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _UWSGI_THRIFT_HANDLER_TRAITS_H_
+#define _UWSGI_THRIFT_HANDLER_TRAITS_H_
+
+#include <type_traits>
+
+namespace tasks {
+namespace net {
+
+/// Controls whether the thrift processors keep one handler object for all requests of a connection.
+///
+/// By default a new handler is created for each request, so handlers can keep per request state in members. Handlers
+/// that are safe to reuse can opt in by specializing this trait:
+///
+///   template <>
+///   struct uwsgi_thrift_handler_reuse<my_handler> : std::true_type {};
+///
+/// A reused asynchronous handler gets reset() before each request. It has to clear all per request state there.
+template <class handler_type>
+struct uwsgi_thrift_handler_reuse : std::false_type {};
+
+}  // net
+}  // tasks
+
+#endif  // _UWSGI_THRIFT_HANDLER_TRAITS_H_
@@ -10,9 +10,12 @@
 
 #include <arpa/inet.h>
 #include <boost/shared_ptr.hpp>
-#include <thrift/protocol/TBinaryProtocol.h>
 
+#include <memory>
+
+#include <tasks/net/thrift_protocol.h>
 #include <tasks/net/uwsgi_task.h>
+#include <tasks/net/uwsgi_thrift_handler_traits.h>
 #include <tasks/net/uwsgi_thrift_transport.h>
 
 namespace tasks {
@@ -21,29 +24,36 @@ namespace net {
 template <class processor_type, class handler_type>
 class uwsgi_thrift_processor : public tasks::net::uwsgi_task {
   public:
+    using in_transport_type = uwsgi_thrift_transport<uwsgi_request>;
+    using out_transport_type = uwsgi_thrift_transport<http_response>;
+    using protocol_set_type = thrift_protocol_set<in_transport_type, out_transport_type>;
+
     uwsgi_thrift_processor(net::socket& s) : uwsgi_task(s) {}
 
     virtual bool handle_request() {
-        using namespace apache::thrift::protocol;
         using namespace apache::thrift::transport;
-        typedef uwsgi_thrift_transport<uwsgi_request> in_transport_type;
-        typedef uwsgi_thrift_transport<http_response> out_transport_type;
-        typedef TBinaryProtocol protocol_type;
 
-        boost::shared_ptr<in_transport_type> in_transport(new in_transport_type(request_p()));
-        boost::shared_ptr<out_transport_type> out_transport(new out_transport_type(response_p()));
-        boost::shared_ptr<protocol_type> in_protocol(new protocol_type(in_transport));
-        boost::shared_ptr<protocol_type> out_protocol(new protocol_type(out_transport));
+        // The transports and protocols are bound to the request and response objects of this task, so they can be
+        // kept for all requests of the connection.
+        if (nullptr == m_protocols) {
+            boost::shared_ptr<in_transport_type> in_transport(new in_transport_type(request_p()));
+            boost::shared_ptr<out_transport_type> out_transport(new out_transport_type(response_p()));
+            m_protocols.reset(new protocol_set_type(in_transport, out_transport));
+        }
+        thrift_protocol in_protocol, out_protocol;
+        negotiate_thrift_protocol(request(), in_protocol, out_protocol);
 
         // Process message
         try {
-            boost::shared_ptr<handler_type> handler(new handler_type());
-            handler->set_uwsgi_task(this);
-            processor_type proc(handler);
+            if (nullptr == m_processor || !uwsgi_thrift_handler_reuse<handler_type>::value) {
+                m_handler.reset(new handler_type());
+                m_handler->set_uwsgi_task(this);
+                m_processor.reset(new processor_type(m_handler));
+            }
 
             // Read a thrift object from the request, call the handler and write the respnding
             // thrift object to the uwsgi response.
-            if (proc.process(in_protocol, out_protocol, NULL)) {
+            if (m_processor->process(m_protocols->in(in_protocol), m_protocols->out(out_protocol), NULL)) {
                 response().set_status("200 OK");
             } else {
                 response().set_status("400 Bad Request");
@@ -55,19 +65,19 @@ class uwsgi_thrift_processor : public tasks::net::uwsgi_task {
             response().set_status("400 Bad Request");
         }
 
-        response().set_header("Content-Type", "application/x-thrift");
+        response().set_header("Content-Type", thrift_content_type(out_protocol));
         send_response();
 
         return true;
     }
+
+  private:
+    std::unique_ptr<protocol_set_type> m_protocols;
+    boost::shared_ptr<handler_type> m_handler;
+    std::unique_ptr<processor_type> m_processor;
 };
 
 }  // net
 }  // tasks
 
 #endif  // _THRIFT_PROCESSOR_H_
-
-
-
-
-
@@ -8,20 +8,66 @@
 #ifndef _UWSGI_THRIFT_TRANSPORT_H_
 #define _UWSGI_THRIFT_TRANSPORT_H_
 
+#include <cstring>
+
 #include <thrift/transport/TVirtualTransport.h>
 
+#include <tasks/tools/buffer.h>
+
 namespace tasks {
 namespace net {
 
+/// A thrift transport on top of the content buffer of a request or response.
+///
+/// The content is contiguous in memory, so the transport implements thrift's borrow/consume interface. Protocols that
+/// are instantiated for this transport type (e.g. TBinaryProtocolT<uwsgi_thrift_transport<uwsgi_request>>) decode
+/// integers and strings directly from the buffer without virtual calls and intermediate copies.
 template <class T>
 class uwsgi_thrift_transport : public apache::thrift::transport::TVirtualTransport<uwsgi_thrift_transport<T> > {
   public:
     uwsgi_thrift_transport(T* r) : m_uwsgi_obj(r) {}
     ~uwsgi_thrift_transport() {}
 
-    uint32_t read(uint8_t* data, int32_t size) { return m_uwsgi_obj->read((char*)data, size); }
+    uint32_t read(uint8_t* data, uint32_t size) {
+        tools::buffer& buf = m_uwsgi_obj->content_buffer();
+        uint32_t avail = buf.to_read();
+        if (size > avail) {
+            size = avail;
+        }
+        std::memcpy(data, buf.ptr_read(), size);
+        buf.move_ptr_read(size);
+        return size;
+    }
+
+    void write(const uint8_t* data, uint32_t size) {
+        tools::buffer& buf = m_uwsgi_obj->content_buffer();
+        buf.reserve(size);
+        buf.write((const char*)data, size);
+    }
+
+    /// Return a pointer to the unread content if at least len bytes are available.
+    ///
+    /// \param len The number of bytes the caller needs. Gets set to the number of available bytes.
+    /// \return A pointer into the content buffer or NULL if less than len bytes are available.
+    const uint8_t* borrow(uint8_t* /* buf */, uint32_t* len) {
+        tools::buffer& buf = m_uwsgi_obj->content_buffer();
+        uint32_t avail = buf.to_read();
+        if (avail < *len) {
+            return NULL;
+        }
+        *len = avail;
+        return (const uint8_t*)buf.ptr_read();
+    }
 
-    void write(const uint8_t* data, uint32_t size) { m_uwsgi_obj->write((const char*)data, size); }
+    /// Mark bytes returned by borrow() as read.
+    void consume(uint32_t len) {
+        tools::buffer& buf = m_uwsgi_obj->content_buffer();
+        if (static_cast<std::streamsize>(len) > buf.to_read()) {
+            throw apache::thrift::transport::TTransportException(
+                apache::thrift::transport::TTransportException::BAD_ARGS, "consume did not follow a borrow");
+        }
+        buf.move_ptr_read(len);
+    }
 
     void flush() {}
 
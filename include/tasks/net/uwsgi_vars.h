@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _UWSGI_VARS_H_
+#define _UWSGI_VARS_H_
+
+#include <cstdint>
+#include <cstring>
+
+#include <tasks/tools/string_view.h>
+
+namespace tasks {
+namespace net {
+
+/// Well known CGI/uwsgi variables. Each of them owns a fixed slot in a uwsgi_request, so looking them up is a plain
+/// index read. The order has to match uwsgi_vars::names.
+enum class uwsgi_var : uint8_t {
+    REQUEST_METHOD,
+    REQUEST_URI,
+    QUERY_STRING,
+    PATH_INFO,
+    SCRIPT_NAME,
+    CONTENT_TYPE,
+    CONTENT_LENGTH,
+    DOCUMENT_ROOT,
+    REQUEST_SCHEME,
+    HTTPS,
+    SERVER_PROTOCOL,
+    SERVER_NAME,
+    SERVER_PORT,
+    SERVER_ADDR,
+    REMOTE_ADDR,
+    REMOTE_PORT,
+    HTTP_HOST,
+    HTTP_USER_AGENT,
+    HTTP_ACCEPT,
+    HTTP_ACCEPT_ENCODING,
+    HTTP_ACCEPT_LANGUAGE,
+    HTTP_CONNECTION,
+    HTTP_COOKIE,
+    HTTP_REFERER,
+    HTTP_X_FORWARDED_FOR,
+    HTTP_CONTENT_TYPE,
+    COUNT  // Has to be the last entry
+};
+
+/// Compile time perfect hash that maps the names of the well known variables to their uwsgi_var slot.
+///
+/// The hash only looks at the length and two characters of a key. The table is generated at compile time and a
+/// static_assert makes sure no two names collide. A hit is always verified by comparing the name, so unknown keys
+/// can't be mistaken for a well known one.
+namespace uwsgi_vars {
+
+constexpr std::size_t COUNT = static_cast<std::size_t>(uwsgi_var::COUNT);
+constexpr std::size_t TABLE_SIZE = 64;
+constexpr uint8_t EMPTY = 0xff;
+
+/// All well known names are at least this long, shorter keys are never looked up in the table.
+constexpr std::size_t MIN_LEN = 5;
+
+constexpr const char* names[COUNT] = {
+    "REQUEST_METHOD",  "REQUEST_URI",     "QUERY_STRING",         "PATH_INFO",            "SCRIPT_NAME",
+    "CONTENT_TYPE",    "CONTENT_LENGTH",  "DOCUMENT_ROOT",        "REQUEST_SCHEME",       "HTTPS",
+    "SERVER_PROTOCOL", "SERVER_NAME",     "SERVER_PORT",          "SERVER_ADDR",          "REMOTE_ADDR",
+    "REMOTE_PORT",     "HTTP_HOST",       "HTTP_USER_AGENT",      "HTTP_ACCEPT",          "HTTP_ACCEPT_ENCODING",
+    "HTTP_ACCEPT_LANGUAGE", "HTTP_CONNECTION", "HTTP_COOKIE",     "HTTP_REFERER",         "HTTP_X_FORWARDED_FOR",
+    "HTTP_CONTENT_TYPE"};
+
+struct table_t {
+    uint8_t slots[TABLE_SIZE];
+    bool perfect;
+};
+
+constexpr std::size_t length(const char* s) {
+    std::size_t len = 0;
+    while (s[len]) {
+        len++;
+    }
+    return len;
+}
+
+constexpr std::size_t hash(const char* s, std::size_t len) {
+    return (len * 7 + static_cast<uint8_t>(s[3]) * 3 + static_cast<uint8_t>(s[len - 2])) % TABLE_SIZE;
+}
+
+constexpr table_t make_table() {
+    table_t t{{0}, true};
+    for (std::size_t i = 0; i < TABLE_SIZE; i++) {
+        t.slots[i] = EMPTY;
+    }
+    for (std::size_t i = 0; i < COUNT; i++) {
+        std::size_t h = hash(names[i], length(names[i]));
+        if (EMPTY != t.slots[h]) {
+            t.perfect = false;
+        }
+        t.slots[h] = static_cast<uint8_t>(i);
+    }
+    return t;
+}
+
+constexpr table_t table = make_table();
+static_assert(table.perfect, "uwsgi_vars: hash collision, adjust uwsgi_vars::hash()");
+
+/// Find the slot for a variable name.
+///
+/// \param key A pointer to the name. The name does not need to be null terminated.
+/// \param len The length of the name.
+/// \return The slot or uwsgi_var::COUNT if the name is not a well known variable.
+inline uwsgi_var lookup(const char* key, std::size_t len) {
+    if (len >= MIN_LEN) {
+        uint8_t idx = table.slots[hash(key, len)];
+        if (EMPTY != idx && !std::strncmp(names[idx], key, len) && 0 == names[idx][len]) {
+            return static_cast<uwsgi_var>(idx);
+        }
+    }
+    return uwsgi_var::COUNT;
+}
+
+/// \copydoc uwsgi_vars::lookup(const char*, std::size_t)
+inline uwsgi_var lookup(tools::string_view key) { return lookup(key.data(), key.size()); }
+
+/// \return The name of a well known variable.
+inline const char* name(uwsgi_var var) { return names[static_cast<std::size_t>(var)]; }
+
+}  // uwsgi_vars
+
+}  // net
+}  // tasks
+
+#endif  // _UWSGI_VARS_H_
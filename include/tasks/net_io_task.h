@@ -9,6 +9,7 @@
 #define _TASKS_NET_IO_TASK_H_
 
 #include <tasks/io_task_base.h>
+#include <tasks/timer_wheel.h>
 #include <tasks/net/socket.h>
 
 namespace tasks {
@@ -20,7 +21,21 @@ class worker;
  */
 class net_io_task : public io_task_base {
   public:
-    net_io_task(int events) : io_task_base(events) {}
+    /// The timeouts of the phases of a connection in seconds. 0 disables a timeout. Servers track the phase a
+    /// connection is in with the deadline.
+    struct timeouts_t {
+        /// The time a connection can wait for a request.
+        double idle = 0.;
+        /// The time a connection can wait for more data of a request that has been read partially. The idle timeout
+        /// applies if 0.
+        double read = 0.;
+        /// The time the handler can take until it sends the response.
+        double request = 0.;
+        /// The time a connection can wait until more of the response can be written.
+        double write = 0.;
+    };
+
+    net_io_task(int events) : io_task_base(events), m_deadline([this] { expire_deadline(); }) {}
     net_io_task(net::socket& socket, int events);
     virtual ~net_io_task();
 
@@ -44,6 +59,15 @@ class net_io_task : public io_task_base {
     /// pointer.
     static void add_task(net_io_task* task);
 
+    /// Set a deadline. When it passes, the socket gets shut down. This wakes up the watcher and the next read or write
+    /// fails, so the task gets finished by its worker. Resetting the deadline is cheap and can be done on every read.
+    ///
+    /// \param timeout The timeout in seconds. Values <= 0 disarm the deadline.
+    inline void arm_deadline(double timeout) { m_deadline.arm(timeout); }
+
+    /// Disarm the deadline.
+    inline void disarm_deadline() { m_deadline.cancel(); }
+
   protected:
     void add_task(worker* worker, net_io_task* task);
 
@@ -63,6 +87,10 @@ class net_io_task : public io_task_base {
   private:
     net::socket m_socket;
     bool m_auto_close = true;
+    wheel_timer m_deadline;
+
+    /// Called by the timer wheel when the deadline has passed.
+    void expire_deadline();
 };
 
 }  // tasks
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _TASKS_PARALLEL_H_
+#define _TASKS_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <tasks/cpu_pool.h>
+#include <tasks/future.h>
+
+// The number of chunks per CPU pool thread parallel_for() and parallel_reduce() split a range into by default.
+#define PARALLEL_CHUNKS_PER_THREAD 8
+
+namespace tasks {
+
+namespace detail {
+
+/// The state shared by the copies of a task_group and its functors.
+struct task_group_state {
+    std::atomic<std::size_t> pending{1};  // the functors plus one for join()
+    std::atomic<bool> failed{false};
+    std::mutex mutex;
+    tasks_exception error;
+    promise<void> done;
+    worker* origin = nullptr;
+
+    /// Keep the first error.
+    void fail(const tasks_exception& e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failed) {
+            error = e;
+            failed = true;
+        }
+    }
+
+    /// Drop a reference and complete the group in the event loop of the origin worker if it was the last one.
+    static void release(std::shared_ptr<task_group_state> s) {
+        if (1 == s->pending.fetch_sub(1)) {
+            run_in_worker(s->origin, [s] {
+                if (s->failed) {
+                    s->done.set_exception(s->error);
+                } else {
+                    s->done.set_value();
+                }
+            });
+        }
+    }
+};
+
+/// The partial result of a chunk.
+template <class T>
+struct partial {
+    T value;
+};
+
+/// \return The chunk size to split a range into.
+inline std::size_t chunk_size(std::size_t len, std::size_t grain, std::size_t threads) {
+    if (grain > 0) {
+        return grain;
+    }
+    return std::max<std::size_t>(1, len / (threads * PARALLEL_CHUNKS_PER_THREAD));
+}
+
+}  // detail
+
+/// Runs CPU bound functors on the cpu_pool and joins them with a future.
+///
+///   task_group g;
+///   for (auto& c : candidates) {
+///       g.run([&c] { c.score = score(c); });
+///   }
+///   g.join().then([this](future<void> done) { ... });
+///
+/// A task_group is a handle, functors can capture a copy and run further functors of the same group, so work can be
+/// split recursively. The first exception thrown by a functor fails the group, functors that have not been started
+/// yet are skipped then.
+class task_group {
+  public:
+    /// \param pool The pool to run the functors on. It has to outlive the group.
+    task_group(cpu_pool* pool = cpu_pool::instance().get())
+        : m_pool(pool), m_state(std::make_shared<detail::task_group_state>()) {}
+
+    /// Queue a functor. After join() only the functors of the group can add further functors.
+    template <class F>
+    void run(F f) {
+        auto state = m_state;
+        state->pending++;
+        m_pool->submit([state, f]() mutable {
+            if (!state->failed) {
+                try {
+                    f();
+                } catch (tasks_exception& e) {
+                    state->fail(e);
+                } catch (std::exception& e) {
+                    state->fail(tasks_exception(tasks_error::FUTURE_EXCEPTION, e.what()));
+                }
+            }
+            detail::task_group_state::release(state);
+        });
+    }
+
+    /// Wait for the functors. Must be called once.
+    ///
+    /// \param w The worker that completes the returned future. The default is the calling worker, so continuations
+    ///   run in its event loop after a single wakeup. If nullptr, the future is completed by the pool thread that ran
+    ///   the last functor.
+    /// \return A future that becomes ready when all functors have been executed, or fails with the first error.
+    future<void> join(worker* w = worker::get()) {
+        m_state->origin = w;
+        future<void> result = m_state->done.get_future();
+        detail::task_group_state::release(m_state);
+        return result;
+    }
+
+    /// \return The pool of the group.
+    inline cpu_pool* pool() const { return m_pool; }
+
+  private:
+    cpu_pool* m_pool;
+    std::shared_ptr<detail::task_group_state> m_state;
+};
+
+namespace detail {
+
+/// Run f(chunk) for the chunks [lo, hi). The upper half is queued and the lower half is split further, so idle
+/// threads steal big pieces of work while the owner works through its own.
+template <class F>
+void split_chunks(task_group g, std::size_t lo, std::size_t hi, F f) {
+    while (hi - lo > 1) {
+        std::size_t mid = lo + (hi - lo) / 2;
+        g.run([g, mid, hi, f] { split_chunks(g, mid, hi, f); });
+        hi = mid;
+    }
+    f(lo);
+}
+
+}  // detail
+
+/// Call f(i) for every i in [first, last) on the cpu_pool.
+///
+/// \param first The first index.
+/// \param last The index after the last one.
+/// \param f The functor. It is called concurrently and must not block.
+/// \param grain The number of indices a pool thread handles at once. The default splits the range into
+///   PARALLEL_CHUNKS_PER_THREAD chunks per pool thread.
+/// \return A future that becomes ready in the event loop of the calling worker when all calls have returned.
+template <class F>
+future<void> parallel_for(std::size_t first, std::size_t last, F f, std::size_t grain = 0) {
+    task_group g;
+    if (first < last) {
+        std::size_t chunk = detail::chunk_size(last - first, grain, g.pool()->threads());
+        std::size_t chunks = (last - first + chunk - 1) / chunk;
+        auto body = std::make_shared<F>(std::move(f));
+        g.run([g, first, last, chunk, chunks, body] {
+            detail::split_chunks(g, 0, chunks, [first, last, chunk, body](std::size_t c) {
+                std::size_t end = std::min(last, first + (c + 1) * chunk);
+                for (std::size_t i = first + c * chunk; i < end; i++) {
+                    (*body)(i);
+                }
+            });
+        });
+    }
+    return g.join();
+}
+
+/// Map every i in [first, last) to a value and reduce the values on the cpu_pool.
+///
+///   parallel_reduce(0, candidates.size(), 0.0, [&](std::size_t i) { return score(candidates[i]); },
+///                   [](double a, double b) { return std::max(a, b); }).then([this](future<double> best) { ... });
+///
+/// \param first The first index.
+/// \param last The index after the last one.
+/// \param identity The identity of reduce.
+/// \param map The functor that maps an index to a value. It is called concurrently and must not block.
+/// \param reduce The functor that combines two values. It has to be associative, the values are combined in order.
+/// \param grain The number of indices a pool thread handles at once.
+/// \return A future for the result that becomes ready in the event loop of the calling worker.
+template <class T, class M, class R>
+future<T> parallel_reduce(std::size_t first, std::size_t last, T identity, M map, R reduce, std::size_t grain = 0) {
+    task_group g;
+    std::size_t chunks = 0;
+    std::size_t chunk = 1;
+    if (first < last) {
+        chunk = detail::chunk_size(last - first, grain, g.pool()->threads());
+        chunks = (last - first + chunk - 1) / chunk;
+    }
+    auto partials = std::make_shared<std::vector<detail::partial<T>>>(chunks, detail::partial<T>{identity});
+    auto fs = std::make_shared<std::pair<M, R>>(std::move(map), std::move(reduce));
+    if (chunks > 0) {
+        g.run([g, first, last, chunk, chunks, identity, partials, fs] {
+            detail::split_chunks(g, 0, chunks, [first, last, chunk, identity, partials, fs](std::size_t c) {
+                T acc = identity;
+                std::size_t end = std::min(last, first + (c + 1) * chunk);
+                for (std::size_t i = first + c * chunk; i < end; i++) {
+                    acc = fs->second(acc, fs->first(i));
+                }
+                (*partials)[c].value = std::move(acc);
+            });
+        });
+    }
+    return g.join().then([identity, partials, fs](future<void> done) {
+        done.get();
+        T result = identity;
+        for (auto& p : *partials) {
+            result = fs->second(result, p.value);
+        }
+        return result;
+    });
+}
+
+}  // tasks
+
+#endif  // _TASKS_PARALLEL_H_
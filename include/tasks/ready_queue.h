@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _TASKS_READY_QUEUE_H_
+#define _TASKS_READY_QUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+#include <tasks/event_task.h>
+
+// The number of events of higher priorities a worker handles before it handles an event of a waiting lower priority.
+#define READY_QUEUE_STARVATION_LIMIT 16
+
+namespace tasks {
+
+class worker;
+
+/// Put all queued events into a queue instead of handling them
+/// directly from handle_io_event as multiple events can fire and
+/// we want to promote the next leader after the ev_loop call
+/// returns to avoid calling it from multiple threads.
+struct event {
+    tasks::event_task* task;
+    int revents;
+    /// A functor deferred by worker::defer(). It runs instead of a handler, the task is null then.
+    std::function<void(worker*)> func = nullptr;
+};
+
+/// The fired events and the deferred functors of a worker with one FIFO per event priority.
+///
+/// pop() returns the oldest event of the highest priority. To protect lower priorities against starvation, a level
+/// that has been passed over READY_QUEUE_STARVATION_LIMIT times gets the next turn.
+class ready_queue {
+  public:
+    /// Queue an event with the priority of its task.
+    void push(const event& e);
+
+    /// Queue an event with a priority, e.g. a deferred functor.
+    void push(const event& e, event_priority p);
+
+    /// Take the next event. The queue must not be empty.
+    event pop();
+
+    /// \return True if no events are queued.
+    inline bool empty() const { return 0 == m_size; }
+
+    /// \return The number of queued events.
+    inline std::size_t size() const { return m_size; }
+
+  private:
+    std::deque<event> m_levels[EVENT_PRIORITIES];
+    uint32_t m_skipped[EVENT_PRIORITIES] = {};
+    std::size_t m_size = 0;
+
+    /// Take the oldest event of a level.
+    event take(std::size_t level);
+};
+
+}  // tasks
+
+#endif  // _TASKS_READY_QUEUE_H_
@@ -50,11 +50,23 @@ enum class tasks_error {
     HTTP_NO_CONTENT_LENGTH,
     HTTP_INVALID_STATUS_CODE,
     HTTP_INVALID_HEADER,
+    HTTP_INVALID_CHUNK,
+    HTTP_INVALID_REQUEST_LINE,
+    HTTP_PIPELINE_OVERFLOW,
+    HTTP_TOO_MANY_HEADERS,
+    HTTP_BODY_TOO_LARGE,
     /// UWSGI errors
     UWSGI_HEADER_ERROR,
     UWSGI_NOT_IMPL,
     UWSGI_THRIFT_TRANSPORT,
     UWSGI_THRIFT_HANDLER,
+    /// Thrift errors
+    THRIFT_INVALID_FRAME,
+    THRIFT_CLIENT,
+    /// Fan-out errors
+    FANOUT_DEADLINE,
+    /// Backend group errors
+    BACKEND_GROUP_EMPTY,
     /// Term errors
     TERM_NO_DEVICE,
     TERM_TCGETATTR,
@@ -68,6 +80,11 @@ enum class tasks_error {
     TERM_INVALID_MODE,
     /// Disk IO
     DISKIO_INVALID_EVENT,
+    DISKIO_ERROR,
+    /// Future errors
+    FUTURE_BROKEN_PROMISE,
+    FUTURE_ALREADY_SATISFIED,
+    FUTURE_EXCEPTION,
     UNSET
 };
 
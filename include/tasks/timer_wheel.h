@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _TASKS_TIMER_WHEEL_H_
+#define _TASKS_TIMER_WHEEL_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+#include <tasks/ev_wrapper.h>
+
+// The resolution of the timer wheels in milliseconds.
+#define TIMER_WHEEL_TICK_MS 10
+// Every level of a timer wheel has 2^TIMER_WHEEL_BITS slots. With 5 levels and a 10ms tick, timers up to ~124 days
+// can be set. Longer timeouts are cut.
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_LEVELS 5
+
+namespace tasks {
+
+class worker;
+class timer_wheel;
+
+/// A timer that is managed by the timer wheel of a worker.
+///
+/// Arming, resetting and canceling a timer are O(1), so a timer can be reset on every read of a connection. Unlike a
+/// timer_task, a wheel_timer is no event_task: the expire function gets called by the worker's event loop while the
+/// wheel is locked. It has to be short and must not arm or cancel timers.
+///
+/// A timer is armed by the worker that owns it, but it can be canceled from any thread, e.g. when a task gets disposed
+/// by a different thread.
+class wheel_timer {
+  public:
+    using expire_func_t = std::function<void()>;
+
+    /// \param f The function to call when the timer expires.
+    wheel_timer(expire_func_t f) : m_func(f) {}
+
+    ~wheel_timer() { cancel(); }
+
+    wheel_timer(const wheel_timer&) = delete;
+    wheel_timer& operator=(const wheel_timer&) = delete;
+
+    /// Set the timer to expire after timeout seconds. An armed timer gets reset. The timer is added to the wheel of
+    /// the calling worker.
+    ///
+    /// \param timeout The timeout in seconds. Values <= 0 cancel the timer.
+    void arm(double timeout);
+
+    /// Cancel the timer.
+    void cancel();
+
+    /// \return True if the timer is armed.
+    bool armed() const;
+
+  private:
+    friend class timer_wheel;
+
+    std::atomic<timer_wheel*> m_wheel{nullptr};  // the wheel the links belong to, changed with its mutex held
+    wheel_timer** m_slot = nullptr;               // the list head, null if the timer is not armed
+    wheel_timer* m_prev = nullptr;
+    wheel_timer* m_next = nullptr;
+    uint64_t m_expires = 0;  // in ticks
+    expire_func_t m_func;
+};
+
+/// A hierarchical timing wheel.
+///
+/// Level 0 has a slot for each of the next 2^TIMER_WHEEL_BITS ticks, every further level covers 2^TIMER_WHEEL_BITS
+/// times the range of the level below. Timers are put into the slot of the lowest level that covers their expiry
+/// and move down a level when the wheel reaches their slot. All timers of a tick expire in one pass.
+///
+/// Every worker owns a timer wheel. It is driven by a repeating ev_timer on the worker's event loop, that only runs
+/// while timers are armed.
+class timer_wheel {
+  public:
+    /// \param worker The worker that runs the wheel or nullptr to advance the wheel manually.
+    timer_wheel(worker* worker = nullptr);
+
+    ~timer_wheel();
+
+    timer_wheel(const timer_wheel&) = delete;
+    timer_wheel& operator=(const timer_wheel&) = delete;
+
+    /// Arm a timer. An armed timer gets reset, a timer that is armed in a different wheel is moved.
+    ///
+    /// \param timer The timer.
+    /// \param expires_ms The expiry in milliseconds, see now_ms().
+    void add(wheel_timer* timer, int64_t expires_ms);
+
+    /// Cancel a timer.
+    void remove(wheel_timer* timer);
+
+    /// Expire all timers up to a point in time.
+    ///
+    /// \param now_ms The time in milliseconds, see now_ms().
+    /// \return The number of expired timers.
+    std::size_t advance(int64_t now_ms);
+
+    /// \return The number of armed timers.
+    std::size_t size() const;
+
+    /// \return The current time in milliseconds of a monotonic clock.
+    static inline int64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /// Called by the event loop for every tick.
+    void tick(struct ev_loop* loop);
+
+  private:
+    friend class wheel_timer;
+
+    static constexpr uint64_t SLOTS = 1 << TIMER_WHEEL_BITS;
+    static constexpr uint64_t MASK = SLOTS - 1;
+
+    worker* m_worker;
+    mutable std::mutex m_mutex;
+    uint64_t m_now = 0;  // the next tick to process
+    std::size_t m_size = 0;
+    bool m_ticking = false;
+    ev_timer m_watcher;
+    wheel_timer* m_slots[TIMER_WHEEL_LEVELS][SLOTS];
+
+    /// Put a timer into its slot. Has to be called with the mutex held.
+    void link(wheel_timer* timer);
+
+    /// Take a timer out of its slot. Has to be called with the mutex held.
+    void unlink(wheel_timer* timer);
+
+    /// Move the timers of a slot to the levels below. Has to be called with the mutex held.
+    void cascade(std::size_t level, std::size_t idx);
+
+    /// Expire all timers up to a tick. Has to be called with the mutex held.
+    std::size_t advance_ticks(uint64_t target);
+};
+
+/// Callback for the timer wheel ticks.
+void timer_wheel_callback(struct ev_loop* loop, ev_timer* w, int e);
+
+}  // tasks
+
+#endif  // _TASKS_TIMER_WHEEL_H_
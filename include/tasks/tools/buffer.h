@@ -84,6 +84,19 @@ class buffer : public std::streambuf {
         setp(p_wr, ptr_end());
     }
 
+    /// Make sure the next writes of up to n bytes don't need to grow the buffer. The capacity grows geometrically, so
+    /// many small writes cause only a few reallocations.
+    inline void reserve(std::size_t n) {
+        if (m_buffer.size() < m_size + n) {
+            auto oread = offset_read();
+            auto owrite = offset_write();
+            std::size_t cap = m_buffer.size() * 2;
+            m_buffer.resize(cap > m_size + n ? cap : m_size + n);
+            setg(ptr_begin(), ptr_begin() + oread, ptr_end());
+            setp(ptr_begin() + owrite, ptr_end());
+        }
+    }
+
     inline void shrink() { m_buffer.resize(m_size); }
 
     inline std::size_t buffer_size() { return m_buffer.size(); }
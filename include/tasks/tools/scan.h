@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _SCAN_H_
+#define _SCAN_H_
+
+#include <cstring>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace tasks {
+namespace tools {
+
+/// Find the first occurrence of a character in a memory block.
+///
+/// Uses AVX2 or SSE4.2 if the library has been compiled for a CPU that supports it (see the WITH_NATIVE_ARCH cmake
+/// option) and falls back to memchr otherwise. The block does not need to be null terminated and no byte past end is
+/// read.
+///
+/// \param p The start of the block.
+/// \param end The end of the block.
+/// \param c The character to search for.
+/// \return A pointer to the character or end if it has not been found.
+inline const char* find_char(const char* p, const char* end, char c) {
+#if defined(__AVX2__)
+    const __m256i needle = _mm256_set1_epi8(c);
+    while (end - p >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+#elif defined(__SSE4_2__)
+    const __m128i needle = _mm_set1_epi8(c);
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int idx = _mm_cmpestri(needle, 1, block, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+        if (idx < 16) {
+            return p + idx;
+        }
+        p += 16;
+    }
+#endif
+    if (p < end) {
+        const void* r = std::memchr(p, c, end - p);
+        if (nullptr != r) {
+            return static_cast<const char*>(r);
+        }
+    }
+    return end;
+}
+
+/// Case insensitive comparison of a memory block with a lower case null terminated string.
+///
+/// \param s The block to compare.
+/// \param len The length of the block.
+/// \param lower The lower case string to compare with.
+/// \return True if both are equal.
+inline bool iequals_lower(const char* s, std::size_t len, const char* lower) {
+    std::size_t i = 0;
+    for (; i < len; i++) {
+        char c = s[i];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        if (0 == lower[i] || c != lower[i]) {
+            return false;
+        }
+    }
+    return 0 == lower[i];
+}
+
+}  // tools
+}  // tasks
+
+#endif  // _SCAN_H_
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifndef _STRING_VIEW_H_
+#define _STRING_VIEW_H_
+
+#include <cstdint>
+#include <boost/utility/string_ref.hpp>
+
+namespace tasks {
+namespace tools {
+
+/// A non owning reference to a character sequence. We build with C++14, so boost::string_ref is used until
+/// std::string_view becomes available.
+using string_view = boost::string_ref;
+
+/// Convert the decimal number a view points to. Parsing stops at the first non digit character.
+///
+/// \param s The view to parse.
+/// \return The parsed number or 0 if the view does not start with a digit.
+inline std::size_t to_size(string_view s) {
+    std::size_t n = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') {
+            break;
+        }
+        n = n * 10 + (c - '0');
+    }
+    return n;
+}
+
+}  // tools
+}  // tasks
+
+#endif  // _STRING_VIEW_H_
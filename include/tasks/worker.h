@@ -10,9 +10,12 @@
 
 #include <tasks/dispatcher.h>
 #include <tasks/event_task.h>
+#include <tasks/ready_queue.h>
 #include <tasks/logging.h>
 #include <tasks/ev_wrapper.h>
+#include <tasks/timer_wheel.h>
 #include <thread>
+#include <chrono>
 #include <atomic>
 #include <memory>
 #include <mutex>
@@ -27,9 +30,8 @@
 #define ENABLE_ADD_TIME 0
 #define ADD_TIME_BUCKETS 10
 
-#if ENABLE_ADD_TIME == 1
-#include <chrono>
-#endif
+// The default time budget of an event handler in microseconds. 0 disables the accounting.
+#define HANDLER_TIME_BUDGET 5000
 
 namespace tasks {
 
@@ -47,17 +49,10 @@ struct task_func_queue_t {
     std::mutex mutex;
 };
 
-/// Put all queued events into a queue instead of handling them
-/// directly from handle_io_event as multiple events can fire and
-/// we want to promote the next leader after the ev_loop call
-/// returns to avoid calling it from multiple threads.
-struct event {
-    tasks::event_task* task;
-    int revents;
-};
-
 class worker {
   public:
+    typedef std::function<void(worker* worker)> defer_func_t;
+
     worker(uint8_t id, std::unique_ptr<loop_t>& loop);
     virtual ~worker();
 
@@ -85,7 +80,7 @@ class worker {
                 loop = m_loop->ptr;
                 break;
             default:
-                loop = ev_default_loop(0);
+                loop = ev_default_loop(dispatcher::backend());
         }
         return loop;
     }
@@ -141,7 +136,7 @@ class worker {
         tdbg(get_string() << ": thread done" << std::endl);
     }
 
-    /// Add an event to the workers queue.
+    /// Add an event to the workers queue. Events of higher priorities are handled first.
     inline void add_event(event e) { m_events_queue.push(e); }
 
     /// Add an event to the workers queue from a different thread context.
@@ -161,12 +156,64 @@ class worker {
     /// Handle a timer event.
     //void handle_timer_event(ev_timer* watcher);
 
+    /// \return The timer wheel of the worker.
+    inline timer_wheel& wheel() { return m_timer_wheel; }
+
     /// Return the number of events the worker has handled until now.
     inline uint64_t events_count() const { return m_events_count; }
 
     /// Execute the event handler of a task, handle errors and deletion.
     void exec_event_handler(event& event);
 
+    /// Queue a functor in the ready queue of this worker. It runs after the events of the same or higher priorities
+    /// that are pending now and in the next batch at the earliest, so the leader polls its loop before. Must be called
+    /// in the worker thread, e.g. from an event handler.
+    ///
+    /// \param f The functor.
+    /// \param p The priority of the functor.
+    inline void defer(defer_func_t f, event_priority p = event_priority::NORMAL) {
+        assert(this == worker::get());
+        m_events_queue.push({nullptr, 0, std::move(f)}, p);
+    }
+
+    /// Yield the worker to other tasks. Call this from the event handler of a task and return: The event goes back to
+    /// the ready queue and the handler is called again with the same events after the pending events of the same or
+    /// higher priorities have been handled. The leader polls its loop before. The return value of the handler is
+    /// ignored until then.
+    ///
+    /// A long running handler can split its work and yield when its time slice is used up:
+    ///
+    ///   bool handle_event(worker* worker, int revents) {
+    ///       while (more_work()) {
+    ///           do_some_work();
+    ///           if (worker->should_yield()) {
+    ///               worker->yield(this);
+    ///               return true;
+    ///           }
+    ///       }
+    ///       ...
+    ///   }
+    inline void yield(event_task* task) {
+        assert(this == worker::get());
+        m_yielded = task;
+    }
+
+    /// \return True if the running event handler has exceeded the time budget.
+    inline bool should_yield() const {
+        if (0 == m_handler_budget) {
+            return false;
+        }
+        auto t = std::chrono::steady_clock::now() - m_handler_start;
+        return std::chrono::duration_cast<std::chrono::microseconds>(t).count() > (int64_t)m_handler_budget;
+    }
+
+    /// Set the time budget of event handlers in microseconds. Handlers that exceed it are counted and end the batch of
+    /// events the worker is handling, the rest is handled after the loop has been polled. 0 disables the accounting.
+    static void set_handler_budget(uint32_t micros) { m_handler_budget = micros; }
+
+    /// \return The number of event handlers that have exceeded the time budget.
+    inline uint64_t over_budget_count() const { return m_over_budget_count; }
+
 #if ENABLE_ADD_TIME == 1
     /// If you need some internal time measurements local to the worker threads, you can
     /// enable this method and drop times in microseconds into this. An average value will
@@ -219,7 +266,13 @@ class worker {
     std::atomic<bool> m_leader;
     std::mutex m_work_mutex;
     std::condition_variable m_work_cond;
-    std::queue<event> m_events_queue;
+    ready_queue m_events_queue;
+    timer_wheel m_timer_wheel;
+    std::chrono::steady_clock::time_point m_handler_start;
+    event_task* m_yielded = nullptr;
+    bool m_batch_over_budget = false;
+    uint64_t m_over_budget_count = 0;
+    static std::atomic<uint32_t> m_handler_budget;
 
 #if ENABLE_ADD_TIME == 1
     uint64_t m_time_total[ADD_TIME_BUCKETS];
@@ -253,6 +306,9 @@ class worker {
         }
     }
 
+    /// Handle the queued events and the deferred functors.
+    void handle_events();
+
     /// Main method of the thread.
     void run();
 };
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <exception>
+
+#include <tasks/cpu_pool.h>
+#include <tasks/logging.h>
+
+namespace tasks {
+
+std::shared_ptr<cpu_pool> cpu_pool::m_instance = nullptr;
+std::mutex cpu_pool::m_instance_mutex;
+thread_local cpu_pool* cpu_pool::m_pool_ptr = nullptr;
+thread_local std::size_t cpu_pool::m_idx = 0;
+
+cpu_pool::cpu_pool(std::size_t threads) {
+    if (0 == threads) {
+        threads = std::thread::hardware_concurrency();
+        if (0 == threads) {
+            threads = 1;
+        }
+    }
+    for (std::size_t i = 0; i < threads; i++) {
+        m_queues.emplace_back(new queue);
+    }
+    for (std::size_t i = 0; i < threads; i++) {
+        m_threads.emplace_back(new std::thread(&cpu_pool::run, this, i));
+    }
+    tdbg("cpu_pool: " << threads << " threads" << std::endl);
+}
+
+cpu_pool::~cpu_pool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_term = true;
+    }
+    m_cond.notify_all();
+    for (auto& t : m_threads) {
+        t->join();
+    }
+}
+
+void cpu_pool::init_threads(std::size_t threads) {
+    std::lock_guard<std::mutex> lock(m_instance_mutex);
+    if (nullptr == m_instance) {
+        m_instance = std::make_shared<cpu_pool>(threads);
+    }
+}
+
+std::shared_ptr<cpu_pool> cpu_pool::instance() {
+    std::lock_guard<std::mutex> lock(m_instance_mutex);
+    if (nullptr == m_instance) {
+        m_instance = std::make_shared<cpu_pool>(CPU_POOL_THREADS);
+    }
+    return m_instance;
+}
+
+void cpu_pool::submit(func_t f) {
+    // Pool threads keep their work local, other threads spread it.
+    std::size_t idx = this == m_pool_ptr ? m_idx : m_next++ % m_queues.size();
+    {
+        // Count first, so a waking thread never misses the functor.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queued++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queues[idx]->mutex);
+        m_queues[idx]->funcs.push_back(std::move(f));
+    }
+    m_cond.notify_one();
+}
+
+void cpu_pool::run(std::size_t idx) {
+    m_pool_ptr = this;
+    m_idx = idx;
+    func_t f;
+    while (true) {
+        if (take(idx, f)) {
+            m_queued--;
+            try {
+                f();
+            } catch (std::exception& e) {
+                terr("cpu_pool: uncaught exception: " << e.what() << std::endl);
+            }
+            f = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_term && 0 == m_queued) {
+            break;
+        }
+        m_cond.wait(lock, [this] { return m_term || m_queued > 0; });
+    }
+    m_pool_ptr = nullptr;
+}
+
+bool cpu_pool::take(std::size_t idx, func_t& f) {
+    {
+        queue& own = *m_queues[idx];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.funcs.empty()) {
+            f = std::move(own.funcs.back());
+            own.funcs.pop_back();
+            return true;
+        }
+    }
+    for (std::size_t i = 1; i < m_queues.size(); i++) {
+        queue& victim = *m_queues[(idx + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.funcs.empty()) {
+            f = std::move(victim.funcs.front());
+            victim.funcs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // tasks
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <tasks/disk_io.h>
+#include <tasks/disk_io_uring.h>
+#include <tasks/logging.h>
+#include <tasks/worker.h>
+
+namespace tasks {
+
+std::shared_ptr<disk_io> disk_io::m_instance = nullptr;
+std::mutex disk_io::m_instance_mutex;
+
+disk_io::disk_io(std::size_t threads) {
+#ifdef _WITH_IO_URING
+    try {
+        m_uring.reset(new disk_io_uring(DISK_IO_URING_ENTRIES));
+    } catch (tasks_exception& e) {
+        terr("disk_io: " << e.what() << ", using I/O threads only" << std::endl);
+    }
+#endif
+    for (std::size_t i = 0; i < threads; i++) {
+        m_threads.emplace_back(new std::thread(&disk_io::run, this));
+    }
+}
+
+disk_io::~disk_io() {
+#ifdef _WITH_IO_URING
+    // Wait for the ring first, its callbacks can queue new operations.
+    m_uring.reset();
+#endif
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_term = true;
+    }
+    m_cond.notify_all();
+    for (auto& t : m_threads) {
+        t->join();
+    }
+}
+
+void disk_io::init_threads(std::size_t threads) {
+    std::lock_guard<std::mutex> lock(m_instance_mutex);
+    if (nullptr == m_instance) {
+        m_instance = std::make_shared<disk_io>(threads);
+    }
+}
+
+std::shared_ptr<disk_io> disk_io::instance() {
+    std::lock_guard<std::mutex> lock(m_instance_mutex);
+    if (nullptr == m_instance) {
+        m_instance = std::make_shared<disk_io>(DISK_IO_THREADS);
+    }
+    return m_instance;
+}
+
+void disk_io::read(int fd, void* data, std::size_t len, complete_func_t f) {
+    submit(op_type::READ, fd, data, len, -1, {}, f);
+}
+
+void disk_io::pread(int fd, void* data, std::size_t len, off_t offset, complete_func_t f) {
+    submit(op_type::READ, fd, data, len, offset, {}, f);
+}
+
+void disk_io::preadv(int fd, std::vector<struct iovec> iov, off_t offset, complete_func_t f) {
+    submit(op_type::READV, fd, nullptr, 0, offset, std::move(iov), f);
+}
+
+void disk_io::write(int fd, const void* data, std::size_t len, complete_func_t f) {
+    submit(op_type::WRITE, fd, const_cast<void*>(data), len, -1, {}, f);
+}
+
+void disk_io::pwrite(int fd, const void* data, std::size_t len, off_t offset, complete_func_t f) {
+    submit(op_type::WRITE, fd, const_cast<void*>(data), len, offset, {}, f);
+}
+
+void disk_io::pwritev(int fd, std::vector<struct iovec> iov, off_t offset, complete_func_t f) {
+    submit(op_type::WRITEV, fd, nullptr, 0, offset, std::move(iov), f);
+}
+
+void disk_io::fsync(int fd, complete_func_t f) { submit(op_type::FSYNC, fd, nullptr, 0, -1, {}, f); }
+
+void disk_io::fdatasync(int fd, complete_func_t f) { submit(op_type::FDATASYNC, fd, nullptr, 0, -1, {}, f); }
+
+future<std::streamsize> disk_io::read(int fd, void* data, std::size_t len) {
+    promise<std::streamsize> p;
+    read(fd, data, len, promise_func(p));
+    return p.get_future();
+}
+
+future<std::streamsize> disk_io::pread(int fd, void* data, std::size_t len, off_t offset) {
+    promise<std::streamsize> p;
+    pread(fd, data, len, offset, promise_func(p));
+    return p.get_future();
+}
+
+future<std::streamsize> disk_io::preadv(int fd, std::vector<struct iovec> iov, off_t offset) {
+    promise<std::streamsize> p;
+    preadv(fd, std::move(iov), offset, promise_func(p));
+    return p.get_future();
+}
+
+future<std::streamsize> disk_io::write(int fd, const void* data, std::size_t len) {
+    promise<std::streamsize> p;
+    write(fd, data, len, promise_func(p));
+    return p.get_future();
+}
+
+future<std::streamsize> disk_io::pwrite(int fd, const void* data, std::size_t len, off_t offset) {
+    promise<std::streamsize> p;
+    pwrite(fd, data, len, offset, promise_func(p));
+    return p.get_future();
+}
+
+future<std::streamsize> disk_io::pwritev(int fd, std::vector<struct iovec> iov, off_t offset) {
+    promise<std::streamsize> p;
+    pwritev(fd, std::move(iov), offset, promise_func(p));
+    return p.get_future();
+}
+
+future<std::streamsize> disk_io::fsync(int fd) {
+    promise<std::streamsize> p;
+    fsync(fd, promise_func(p));
+    return p.get_future();
+}
+
+future<std::streamsize> disk_io::fdatasync(int fd) {
+    promise<std::streamsize> p;
+    fdatasync(fd, promise_func(p));
+    return p.get_future();
+}
+
+disk_io::complete_func_t disk_io::promise_func(promise<std::streamsize> p) {
+    return [p](std::streamsize result, const tasks_exception& e) mutable {
+        if (result < 0) {
+            p.set_exception(e);
+        } else {
+            p.set_value(result);
+        }
+    };
+}
+
+std::size_t disk_io::pending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ops.size();
+}
+
+void disk_io::submit(op_type type, int fd, void* data, std::size_t len, off_t offset, std::vector<struct iovec> iov,
+                     complete_func_t f) {
+    op o = {type, fd, data, len, offset, std::move(iov), f, worker::get()};
+#ifdef _WITH_IO_URING
+    if (nullptr != m_uring && m_uring->submit(o)) {
+        return;
+    }
+#endif
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ops.push_back(std::move(o));
+    }
+    m_cond.notify_one();
+}
+
+void disk_io::run() {
+    while (true) {
+        op o;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this] { return m_term || !m_ops.empty(); });
+            if (m_ops.empty()) {
+                // Terminated and all operations are done
+                return;
+            }
+            o = std::move(m_ops.front());
+            m_ops.pop_front();
+        }
+        std::streamsize result = exec(o);
+        complete(o, result, result < 0 ? errno : 0);
+    }
+}
+
+void disk_io::complete(op& o, std::streamsize result, int err) {
+    tasks_exception e;
+    if (result < 0) {
+        e = tasks_exception(tasks_error::DISKIO_ERROR, std::string("disk_io: ") + std::strerror(err), err);
+    }
+    tdbg("disk_io: fd " << o.fd << " op " << static_cast<int>(o.type) << " returned " << result << std::endl);
+    if (nullptr == o.origin) {
+        o.func(result, e);
+    } else {
+        complete_func_t func = std::move(o.func);
+        o.origin->exec_in_worker_ctx([func, result, e](struct ev_loop*) { func(result, e); });
+    }
+}
+
+std::size_t disk_io::iov_length(const op& o) {
+    std::size_t total = 0;
+    for (auto& v : o.iov) {
+        total += v.iov_len;
+    }
+    return total;
+}
+
+void disk_io::iov_advance(op& o, std::size_t bytes) {
+    o.done += bytes;
+    // Skip the buffers that have been written and continue within a partially written one.
+    while (o.idx < o.iov.size() && bytes >= o.iov[o.idx].iov_len) {
+        bytes -= o.iov[o.idx].iov_len;
+        o.idx++;
+    }
+    if (o.idx < o.iov.size()) {
+        o.iov[o.idx].iov_base = static_cast<char*>(o.iov[o.idx].iov_base) + bytes;
+        o.iov[o.idx].iov_len -= bytes;
+    }
+}
+
+std::streamsize disk_io::exec(op& o) {
+    switch (o.type) {
+        case op_type::READ: {
+            ssize_t n;
+            do {
+                n = o.offset < 0 ? ::read(o.fd, o.data, o.len) : ::pread(o.fd, o.data, o.len, o.offset);
+            } while (n < 0 && EINTR == errno);
+            return n;
+        }
+        case op_type::WRITE: {
+            // Write everything, a short write is retried with the rest.
+            std::size_t done = 0;
+            while (done < o.len) {
+                const char* p = static_cast<const char*>(o.data) + done;
+                ssize_t n = o.offset < 0 ? ::write(o.fd, p, o.len - done)
+                                         : ::pwrite(o.fd, p, o.len - done, o.offset + done);
+                if (n < 0) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+                    return -1;
+                }
+                done += n;
+            }
+            return done;
+        }
+        case op_type::READV: {
+            ssize_t n;
+            do {
+                n = ::preadv(o.fd, o.iov.data(), o.iov.size(), o.offset);
+            } while (n < 0 && EINTR == errno);
+            return n;
+        }
+        case op_type::WRITEV: {
+            std::size_t total = iov_length(o);
+            while (o.done < total) {
+                ssize_t n = ::pwritev(o.fd, o.iov.data() + o.idx, o.iov.size() - o.idx, o.offset + o.done);
+                if (n < 0) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+                    return -1;
+                }
+                iov_advance(o, n);
+            }
+            return o.done;
+        }
+        case op_type::FSYNC:
+            return ::fsync(o.fd);
+        case op_type::FDATASYNC:
+#ifdef _OS_LINUX_
+            return ::fdatasync(o.fd);
+#else
+            return ::fsync(o.fd);
+#endif
+    }
+    return -1;
+}
+
+}  // tasks
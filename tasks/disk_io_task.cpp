@@ -6,48 +6,52 @@
  */
 
 #include <tasks/worker.h>
+#include <tasks/disk_io.h>
 #include <tasks/disk_io_task.h>
 #include <tasks/logging.h>
-#include <unistd.h>
 
 namespace tasks {
 
-disk_io_task::disk_io_task(int fd, int events, tools::buffer* buf) : m_fd(fd), m_events(events), m_buf(buf) {
+disk_io_task::disk_io_task(int fd, int events, tools::buffer* buf, off_t offset)
+    : m_fd(fd), m_events(events), m_buf(buf), m_offset(offset) {
     tdbg(get_string() << ": ctor" << std::endl);
 }
 
 disk_io_task::~disk_io_task() { tdbg(get_string() << ": dtor" << std::endl); }
 
 std::shared_future<std::streamsize> disk_io_task::op() {
-    // run the io op in a separate thread
-    std::promise<std::streamsize> bytes_promise;
-    std::async(std::launch::async, [this, &bytes_promise] {
-        switch (m_events) {
-            case EV_READ:
-                tdbg(get_string() << ": calling read()" << std::endl);
-                m_bytes = read(m_fd, m_buf->ptr_write(), m_buf->to_write());
-                tdbg(get_string() << ": read() returned " << m_bytes << std::endl);
-                if (m_bytes > 0) {
-                    m_buf->move_ptr_write(m_bytes);
-                }
-                break;
-            case EV_WRITE:
-                tdbg(get_string() << ": calling write()" << std::endl);
-                m_bytes = write(m_fd, m_buf->ptr_read(), m_buf->to_read());
-                tdbg(get_string() << ": write() returned " << m_bytes << std::endl);
-                break;
-            default:
-                m_bytes = -1;
-                tasks_exception e(tasks_error::DISKIO_INVALID_EVENT,
-                                  get_string() + std::string(": events has to be either EV_READ or EV_WRITE"));
-                set_exception(e);
-        }
-        bytes_promise.set_value(m_bytes);
-        // fire an event
-        event e = {this, m_events};
-        worker::add_async_event(e);
-    });
-    return bytes_promise.get_future();
+    std::shared_future<std::streamsize> bytes = m_promise.get_future().share();
+    // Called by an I/O thread or the worker that added the task
+    auto f = [this](std::streamsize bytes, const tasks_exception& e) { op_finished(bytes, e); };
+    switch (m_events) {
+        case EV_READ:
+            tdbg(get_string() << ": reading" << std::endl);
+            disk_io::instance()->pread(m_fd, m_buf->ptr_write(), m_buf->to_write(), m_offset, f);
+            break;
+        case EV_WRITE:
+            tdbg(get_string() << ": writing" << std::endl);
+            disk_io::instance()->pwrite(m_fd, m_buf->ptr_read(), m_buf->to_read(), m_offset, f);
+            break;
+        default:
+            tasks_exception e(tasks_error::DISKIO_INVALID_EVENT,
+                              get_string() + std::string(": events has to be either EV_READ or EV_WRITE"));
+            op_finished(-1, e);
+    }
+    return bytes;
+}
+
+void disk_io_task::op_finished(std::streamsize bytes, const tasks_exception& e) {
+    tdbg(get_string() << ": op returned " << bytes << std::endl);
+    m_bytes = bytes;
+    if (tasks_error::UNSET != e.error_code()) {
+        set_exception(e);
+    } else if (EV_READ == m_events && m_bytes > 0) {
+        m_buf->move_ptr_write(m_bytes);
+    }
+    m_promise.set_value(m_bytes);
+    // fire an event
+    event ev = {this, m_events};
+    worker::add_async_event(ev);
 }
 
 bool disk_io_task::handle_event(worker* /* worker */, int /* events */) {
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifdef _WITH_IO_URING
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <tasks/disk_io_uring.h>
+#include <tasks/logging.h>
+
+namespace tasks {
+
+namespace {
+
+inline int io_uring_setup(unsigned entries, struct io_uring_params* p) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+inline int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+inline unsigned* ring_ptr(void* ring, uint32_t offset) {
+    return reinterpret_cast<unsigned*>(static_cast<char*>(ring) + offset);
+}
+
+}
+
+disk_io_uring::disk_io_uring(unsigned entries) {
+    struct io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+    m_fd = io_uring_setup(entries, &p);
+    if (m_fd < 0) {
+        int err = errno;
+        throw tasks_exception(tasks_error::DISKIO_ERROR, std::string("io_uring_setup: ") + std::strerror(err), err);
+    }
+    m_entries = p.sq_entries;
+    m_cq_entries = p.cq_entries;
+
+    m_sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    m_cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap && m_cq_ring_size > m_sq_ring_size) {
+        m_sq_ring_size = m_cq_ring_size;
+    }
+    m_sq_ring = ::mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+                       IORING_OFF_SQ_RING);
+    if (single_mmap) {
+        m_cq_ring = m_sq_ring;
+    } else if (MAP_FAILED != m_sq_ring) {
+        m_cq_ring = ::mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+                           IORING_OFF_CQ_RING);
+    }
+    m_sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    if (MAP_FAILED != m_sq_ring && MAP_FAILED != m_cq_ring) {
+        m_sqes = static_cast<struct io_uring_sqe*>(::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE,
+                                                          MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES));
+    }
+    if (MAP_FAILED == m_sq_ring || MAP_FAILED == m_cq_ring || MAP_FAILED == static_cast<void*>(m_sqes)) {
+        int err = errno;
+        unmap();
+        throw tasks_exception(tasks_error::DISKIO_ERROR, std::string("io_uring mmap: ") + std::strerror(err), err);
+    }
+
+    m_sq_tail = ring_ptr(m_sq_ring, p.sq_off.tail);
+    m_sq_mask = ring_ptr(m_sq_ring, p.sq_off.ring_mask);
+    m_sq_array = ring_ptr(m_sq_ring, p.sq_off.array);
+    m_cq_head = ring_ptr(m_cq_ring, p.cq_off.head);
+    m_cq_tail = ring_ptr(m_cq_ring, p.cq_off.tail);
+    m_cq_mask = ring_ptr(m_cq_ring, p.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<struct io_uring_cqe*>(static_cast<char*>(m_cq_ring) + p.cq_off.cqes);
+
+    tdbg("disk_io_uring: ring with " << m_entries << " entries" << std::endl);
+    m_thread.reset(new std::thread(&disk_io_uring::run, this));
+}
+
+disk_io_uring::~disk_io_uring() {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_term = true;
+            // A NOP wakes up the completion thread.
+            if (0 == push(nullptr)) {
+                break;
+            }
+        }
+        // Retry after the completion thread has made room.
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    m_thread->join();
+    unmap();
+}
+
+bool disk_io_uring::submit(disk_io::op& o) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Keep a slot for the NOP of the destructor and never overflow the completion queue.
+    if (m_term || m_in_flight + 1 >= m_entries || m_in_flight + 1 >= m_cq_entries) {
+        return false;
+    }
+    disk_io::op* p = new disk_io::op(std::move(o));
+    if (0 != push(p)) {
+        // Let the I/O threads execute the operation.
+        o = std::move(*p);
+        delete p;
+        return false;
+    }
+    m_in_flight++;
+    return true;
+}
+
+int disk_io_uring::push(disk_io::op* o) {
+    unsigned tail = *m_sq_tail;
+    unsigned idx = tail & *m_sq_mask;
+    struct io_uring_sqe* sqe = &m_sqes[idx];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = reinterpret_cast<uint64_t>(o);
+    if (nullptr == o) {
+        sqe->opcode = IORING_OP_NOP;
+    } else {
+        sqe->fd = o->fd;
+        // -1 uses the current file position
+        sqe->off = o->offset < 0 ? static_cast<uint64_t>(-1) : o->offset + o->done;
+        switch (o->type) {
+            case disk_io::op_type::READ:
+                sqe->opcode = IORING_OP_READ;
+                sqe->addr = reinterpret_cast<uint64_t>(o->data);
+                sqe->len = o->len;
+                break;
+            case disk_io::op_type::WRITE:
+                sqe->opcode = IORING_OP_WRITE;
+                sqe->addr = reinterpret_cast<uint64_t>(static_cast<char*>(o->data) + o->done);
+                sqe->len = o->len - o->done;
+                break;
+            case disk_io::op_type::READV:
+                sqe->opcode = IORING_OP_READV;
+                sqe->addr = reinterpret_cast<uint64_t>(o->iov.data());
+                sqe->len = o->iov.size();
+                break;
+            case disk_io::op_type::WRITEV:
+                sqe->opcode = IORING_OP_WRITEV;
+                sqe->addr = reinterpret_cast<uint64_t>(o->iov.data() + o->idx);
+                sqe->len = o->iov.size() - o->idx;
+                break;
+            case disk_io::op_type::FSYNC:
+                sqe->opcode = IORING_OP_FSYNC;
+                sqe->off = 0;
+                break;
+            case disk_io::op_type::FDATASYNC:
+                sqe->opcode = IORING_OP_FSYNC;
+                sqe->off = 0;
+                sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+                break;
+        }
+    }
+    m_sq_array[idx] = idx;
+    __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+    int ret;
+    do {
+        ret = io_uring_enter(m_fd, 1, 0, 0);
+    } while (ret < 0 && EINTR == errno);
+    if (ret < 0) {
+        int err = errno;
+        terr("disk_io_uring: io_uring_enter failed: " << std::strerror(err) << std::endl);
+        // The kernel did not consume the entry. Take it back, so it can't be submitted with a later entry.
+        __atomic_store_n(m_sq_tail, tail, __ATOMIC_RELEASE);
+        return err;
+    }
+    return 0;
+}
+
+void disk_io_uring::run() {
+    bool term = false;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (term && 0 == m_in_flight) {
+                return;
+            }
+        }
+        int ret = io_uring_enter(m_fd, 0, 1, IORING_ENTER_GETEVENTS);
+        if (ret < 0 && EINTR != errno) {
+            terr("disk_io_uring: io_uring_enter failed: " << std::strerror(errno) << std::endl);
+        }
+        unsigned head = *m_cq_head;
+        unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            struct io_uring_cqe* cqe = &m_cqes[head & *m_cq_mask];
+            disk_io::op* o = reinterpret_cast<disk_io::op*>(cqe->user_data);
+            int res = cqe->res;
+            __atomic_store_n(m_cq_head, head + 1, __ATOMIC_RELEASE);
+            if (nullptr == o) {
+                term = true;
+            } else if (completed(o, res)) {
+                delete o;
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_in_flight--;
+            }
+        }
+    }
+}
+
+bool disk_io_uring::completed(disk_io::op* o, int res) {
+    if (res < 0) {
+        disk_io::complete(*o, -1, -res);
+        return true;
+    }
+    switch (o->type) {
+        case disk_io::op_type::WRITE:
+            o->done += res;
+            if (res > 0 && o->done < o->len) {
+                break;
+            }
+            disk_io::complete(*o, o->done, 0);
+            return true;
+        case disk_io::op_type::WRITEV:
+            disk_io::iov_advance(*o, res);
+            if (res > 0 && o->idx < o->iov.size()) {
+                break;
+            }
+            disk_io::complete(*o, o->done, 0);
+            return true;
+        default:
+            disk_io::complete(*o, res, 0);
+            return true;
+    }
+    // Submit the rest of a short write.
+    int err;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        err = push(o);
+    }
+    if (0 != err) {
+        disk_io::complete(*o, -1, err);
+        return true;
+    }
+    return false;
+}
+
+void disk_io_uring::unmap() {
+    if (nullptr != m_sqes && MAP_FAILED != static_cast<void*>(m_sqes)) {
+        ::munmap(m_sqes, m_sqes_size);
+    }
+    if (nullptr != m_cq_ring && MAP_FAILED != m_cq_ring && m_cq_ring != m_sq_ring) {
+        ::munmap(m_cq_ring, m_cq_ring_size);
+    }
+    if (nullptr != m_sq_ring && MAP_FAILED != m_sq_ring) {
+        ::munmap(m_sq_ring, m_sq_ring_size);
+    }
+    if (m_fd > -1) {
+        ::close(m_fd);
+    }
+}
+
+}  // tasks
+
+#endif  // _WITH_IO_URING
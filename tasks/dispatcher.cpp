@@ -13,7 +13,6 @@
 #include <tasks/disposable.h>
 #include <tasks/event_task.h>
 #include <tasks/exec_task.h>
-#include <tasks/cleanup_task.h>
 #include <cassert>
 #include <cstdarg>
 #include <chrono>
@@ -22,6 +21,7 @@ namespace tasks {
 
 std::shared_ptr<dispatcher> dispatcher::m_instance = nullptr;
 dispatcher::mode dispatcher::m_run_mode = mode::SINGLE_LOOP;
+unsigned int dispatcher::m_backend = 0;
 
 dispatcher::dispatcher(uint8_t num_workers)
     : m_term(false),
@@ -65,12 +65,12 @@ void dispatcher::run(std::vector<tasks::task*>& tasks) {
 
 void dispatcher::start() {
     // The first thread becomes the leader or each thread gets its own loop
-    struct ev_loop* loop_raw = ev_default_loop(0);
+    struct ev_loop* loop_raw = ev_default_loop(m_backend);
     for (uint8_t i = 0; i < m_num_workers; i++) {
         std::unique_ptr<loop_t> loop = nullptr;
         if (mode::MULTI_LOOP == m_run_mode) {
             if (nullptr == loop_raw) {
-                loop_raw = ev_loop_new(0);
+                loop_raw = ev_loop_new(m_backend);
             }
             assert(loop_raw != nullptr);
             loop.reset(new loop_t(loop_raw));
@@ -91,7 +91,7 @@ void dispatcher::start() {
         }
         // Promote the first leader
         std::unique_ptr<loop_t> loop(new loop_t);
-        loop->ptr = ev_default_loop(0);
+        loop->ptr = ev_default_loop(m_backend);
         m_workers_busy.unset(0);
         m_workers[0]->set_event_loop(loop);
     }
@@ -255,16 +255,11 @@ void dispatcher::remove_event_task(event_task* task) {
         if (nullptr != disp) {
             worker* worker = get_worker_by_task(task);
             tdbg("remove_event_task: deposing event_task " << task << " using worker " << worker << std::endl);
-            if (disp->can_dispose()) {
+            if (disp->request_dispose(worker)) {
                 disp->dispose(worker);
             } else {
-                // Try later
-                cleanup_task* ct = new cleanup_task(disp);
-                tdbg("remove_event_task: delayed deposing event_task "
-                     << disp << "/" << task << " using worker " << worker << " and cleanup_task " << ct << std::endl);
-                ct->init_watcher();
-                ct->assign_worker(worker);
-                ct->start_watcher(worker);
+                // The last enable_dispose() call disposes the task.
+                tdbg("remove_event_task: delayed deposing event_task " << disp << "/" << task << std::endl);
             }
             return;
         }
@@ -297,7 +292,7 @@ void dispatcher::add_signal_handler(int sig, signal_func_t func) {
     signal_func_t* pfunc = new signal_func_t(func);
     ev_signal_init(es, handle_signal, sig);
     es->data = pfunc;
-    ev_signal_start(ev_default_loop(0), es);
+    ev_signal_start(ev_default_loop(m_backend), es);
 }
 
 }  // tasks
@@ -8,6 +8,7 @@
 #include <tasks/exec.h>
 #include <tasks/exec_task.h>
 #include <tasks/dispatcher.h>
+#include <tasks/worker.h>
 
 namespace tasks {
 
@@ -15,7 +16,13 @@ void exec(exec_task::func_t f) { dispatcher::instance()->add_task(new exec_task(
 
 void exec(exec_task::func_t f, task::finish_func_void_t ff) {
     exec_task* t = new exec_task(f);
-    t->on_finish(ff);
+    worker* origin = worker::get();
+    if (nullptr == origin) {
+        t->on_finish(ff);
+    } else {
+        // Finish in the calling worker instead of the executor thread.
+        t->on_finish([origin, ff] { origin->async_call([ff](struct ev_loop* /* loop */) { ff(); }); });
+    }
     dispatcher::instance()->add_task(t);
 }
 
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <random>
+#include <sstream>
+
+#include <tasks/logging.h>
+#include <tasks/tasks_exception.h>
+#include <tasks/net/backend_group.h>
+
+namespace tasks {
+namespace net {
+
+constexpr std::size_t backend_group::NONE;
+
+std::string backend_group::endpoint::get_string() const {
+    std::ostringstream os;
+    if (tcp()) {
+        os << host << ":" << port;
+    } else {
+        os << path;
+    }
+    return os.str();
+}
+
+backend_group::backend_group(std::vector<endpoint> endpoints)
+    : m_endpoints(std::move(endpoints)), m_stats(new stats[m_endpoints.size()]) {
+    if (m_endpoints.empty()) {
+        throw tasks_exception(tasks_error::BACKEND_GROUP_EMPTY, "backend_group: no endpoints");
+    }
+}
+
+void backend_group::set_ejection(uint32_t max_errors, double seconds) {
+    m_max_errors = max_errors;
+    m_ejection_ms = static_cast<int64_t>(seconds * 1000);
+}
+
+void backend_group::set_ewma_weight(double weight) { m_ewma_weight = weight; }
+
+std::size_t backend_group::acquire() {
+    std::size_t n = m_endpoints.size();
+    std::size_t idx = 0;
+    if (n > 1) {
+        int64_t now = now_ms();
+        std::size_t a = random();
+        // Pick a second endpoint that differs from the first one.
+        std::size_t b = (a + 1 + random() % (n - 1)) % n;
+        bool a_ok = !ejected(a, now);
+        bool b_ok = !ejected(b, now);
+        if (a_ok && b_ok) {
+            idx = load(a) <= load(b) ? a : b;
+        } else if (a_ok || b_ok) {
+            idx = a_ok ? a : b;
+        } else {
+            // Both are ejected, use the first healthy endpoint or a if there is none.
+            idx = a;
+            for (std::size_t i = 0; i < n; i++) {
+                if (!ejected(i, now)) {
+                    idx = i;
+                    break;
+                }
+            }
+        }
+    }
+    m_stats[idx].in_flight.fetch_add(1, std::memory_order_relaxed);
+    return idx;
+}
+
+void backend_group::release(std::size_t idx, double seconds, bool success) {
+    stats& s = m_stats[idx];
+    s.in_flight.fetch_sub(1, std::memory_order_relaxed);
+    if (success) {
+        s.errors.store(0, std::memory_order_relaxed);
+        // Fast failures must not make an endpoint look attractive, so only successful requests are sampled.
+        double old = s.ewma.load(std::memory_order_relaxed);
+        double val;
+        do {
+            val = 0. == old ? seconds : old + m_ewma_weight * (seconds - old);
+        } while (!s.ewma.compare_exchange_weak(old, val, std::memory_order_relaxed));
+    } else if (m_max_errors > 0 && s.errors.fetch_add(1, std::memory_order_relaxed) + 1 >= m_max_errors) {
+        tdbg("backend_group: ejecting " << m_endpoints[idx].get_string() << std::endl);
+        s.errors.store(0, std::memory_order_relaxed);
+        s.ejected_until.store(now_ms() + m_ejection_ms, std::memory_order_relaxed);
+    }
+}
+
+std::size_t backend_group::random() const {
+    thread_local std::minstd_rand rng(std::random_device{}());
+    return rng() % m_endpoints.size();
+}
+
+}  // net
+}  // tasks
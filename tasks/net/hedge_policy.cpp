@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <algorithm>
+
+#include <tasks/net/hedge_policy.h>
+
+namespace tasks {
+namespace net {
+
+hedge_policy::hedge_policy(double initial_delay, double quantile, double min_delay)
+    : m_quantile(quantile), m_min_delay(min_delay), m_delay(std::max(initial_delay, min_delay)) {
+    m_samples.reserve(HEDGE_POLICY_SAMPLES);
+}
+
+void hedge_policy::record(double seconds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_samples.size() < HEDGE_POLICY_SAMPLES) {
+        m_samples.push_back(seconds);
+    } else {
+        m_samples[m_next] = seconds;
+    }
+    m_next = (m_next + 1) % HEDGE_POLICY_SAMPLES;
+    if (0 == ++m_count % HEDGE_POLICY_UPDATE) {
+        update();
+    }
+}
+
+std::size_t hedge_policy::samples() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_count;
+}
+
+void hedge_policy::update() {
+    std::vector<double> sorted(m_samples);
+    std::size_t idx = static_cast<std::size_t>(m_quantile * (sorted.size() - 1));
+    std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+    m_delay.store(std::max(sorted[idx], m_min_delay), std::memory_order_relaxed);
+}
+
+}  // net
+}  // tasks
@@ -6,6 +6,8 @@
  */
 
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <algorithm>
 #include <tasks/logging.h>
 
 #include <tasks/net/http_base.h>
@@ -24,9 +26,13 @@ void http_base::write_data(socket& sock) {
     }
     // Write data buffer
     if (io_state::WRITE_DATA == m_state) {
-        write_headers(sock);
+        if (m_content_buffer.to_read()) {
+            write_headers_and_content(sock);
+        } else {
+            write_headers(sock);
+        }
         if (!m_data_buffer.to_read()) {
-            if (m_content_buffer.size()) {
+            if (m_content_buffer.to_read()) {
                 m_state = io_state::WRITE_CONTENT;
             } else {
                 m_state = io_state::DONE;
@@ -50,6 +56,22 @@ void http_base::write_headers(socket& sock) {
     }
 }
 
+void http_base::write_headers_and_content(socket& sock) {
+    struct iovec iov[2];
+    std::size_t headers_size = m_data_buffer.to_read();
+    iov[0].iov_base = m_data_buffer.ptr_read();
+    iov[0].iov_len = headers_size;
+    iov[1].iov_base = m_content_buffer.ptr_read();
+    iov[1].iov_len = m_content_buffer.to_read();
+    std::streamsize bytes = sock.writev(iov, 2);
+    if (bytes > 0) {
+        tdbg("http_base: wrote data and content successfully, " << bytes << " bytes" << std::endl);
+        std::size_t from_headers = std::min(static_cast<std::size_t>(bytes), headers_size);
+        m_data_buffer.move_ptr_read(from_headers);
+        m_content_buffer.move_ptr_read(bytes - from_headers);
+    }
+}
+
 void http_base::write_content(socket& sock) {
     std::streamsize bytes = sock.write(m_content_buffer.ptr_read(), m_content_buffer.to_read());
     if (bytes > 0) {
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <sys/socket.h>
+#include <mutex>
+
+#include <tasks/net/http_fanout.h>
+#include <tasks/net/http_sender.h>
+
+namespace tasks {
+namespace net {
+
+namespace {
+
+/// Passes the response of a fan-out request to the fan-out.
+class fanout_response_handler : public http_response_handler {
+  public:
+    // Required by http_sender, the fan-out always passes a handler.
+    fanout_response_handler() {}
+    fanout_response_handler(http_fanout::reply_func_t reply) : m_reply(reply) {}
+
+    bool handle_response(std::shared_ptr<http_response> response) {
+        m_replied = true;
+        tasks_exception ok;
+        m_reply(response, ok);
+        // Fan-out connections are not reused.
+        return false;
+    }
+
+    /// Report an error if the sender finished without a response.
+    void finished(const tasks_exception& e) {
+        if (!m_replied) {
+            m_replied = true;
+            std::shared_ptr<http_response> none;
+            m_reply(none, e);
+        }
+    }
+
+  private:
+    http_fanout::reply_func_t m_reply;
+    bool m_replied = false;
+};
+
+/// The socket of a running sender. The fd is reset before the sender closes its socket, so a late cancel can't shut
+/// down a reused fd.
+struct sender_socket {
+    std::mutex mutex;
+    int fd = -1;
+};
+
+}  // namespace
+
+http_fanout::cancel_func_t http_fanout::send(std::shared_ptr<http_base> request, reply_func_t reply) {
+    if (nullptr == request) {
+        throw tasks_exception(tasks_error::HTTP_SENDER_INVALID_REMOTE, "http_fanout: no request");
+    }
+    auto handler = std::make_shared<fanout_response_handler>(reply);
+    auto sock = std::make_shared<sender_socket>();
+    auto* sender = new http_sender<fanout_response_handler>(handler);
+    sender->on_finish([sender, handler, sock] {
+        {
+            std::lock_guard<std::mutex> lock(sock->mutex);
+            sock->fd = -1;
+        }
+        if (sender->error()) {
+            handler->finished(sender->exception());
+        } else {
+            handler->finished(tasks_exception(tasks_error::SOCKET_NOCON, "http_fanout: connection closed"));
+        }
+    });
+    {
+        // The sender can finish in a worker thread right after send(), hold the lock until the fd has been read.
+        std::lock_guard<std::mutex> lock(sock->mutex);
+        try {
+            sender->send(request);
+        } catch (tasks_exception&) {
+            delete sender;
+            throw;
+        }
+        sock->fd = sender->socket().fd();
+    }
+    return [sock] {
+        std::lock_guard<std::mutex> lock(sock->mutex);
+        if (-1 != sock->fd) {
+            // Wakes up the sender, it fails and gets disposed by its worker.
+            ::shutdown(sock->fd, SHUT_RDWR);
+        }
+    };
+}
+
+future<std::shared_ptr<http_response>> http_fanout::send(std::shared_ptr<http_base> request) {
+    promise<std::shared_ptr<http_response>> p;
+    try {
+        send(request, [p](std::shared_ptr<http_response>& response, const tasks_exception& e) mutable {
+            if (e.error_code() != tasks_error::UNSET) {
+                p.set_exception(e);
+            } else {
+                p.set_value(response);
+            }
+        });
+    } catch (tasks_exception& e) {
+        p.set_exception(e);
+    }
+    return p.get_future();
+}
+
+}  // net
+}  // tasks
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cstdlib>
+
+#include <tasks/net/http_base.h>
+#include <tasks/net/http_header_template.h>
+
+namespace tasks {
+namespace net {
+
+http_header_template::http_header_template(const std::string& status, const headers_t& headers, bool date)
+    : m_status(status), m_status_code(std::atoi(status.c_str())), m_date(date) {
+    m_block = "HTTP/1.1 " + m_status + CRLF;
+    for (auto& kv : headers) {
+        m_block += kv.first + ": " + kv.second + CRLF;
+    }
+}
+
+}  // net
+}  // tasks
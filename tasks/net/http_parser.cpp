@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cstring>
+
+#include <tasks/logging.h>
+#include <tasks/net/http_parser.h>
+#include <tasks/tools/scan.h>
+
+namespace tasks {
+namespace net {
+
+bool http_parser::parse(tools::buffer& buf) {
+    char* base = buf.ptr_begin();
+    std::size_t end = buf.offset_write();
+    tools::string_view line;
+    while (true) {
+        switch (m_state) {
+            case state::START_LINE:
+                if (!next_line(buf, line)) {
+                    return false;
+                }
+                // Tolerate empty lines in front of a message (RFC 7230 3.5)
+                if (!line.empty()) {
+                    if (mode::RESPONSE == m_mode) {
+                        parse_status_line(line);
+                    } else {
+                        parse_request_line(line);
+                    }
+                    m_state = state::HEADERS;
+                }
+                break;
+            case state::HEADERS:
+                if (!next_line(buf, line)) {
+                    return false;
+                }
+                if (line.empty()) {
+                    headers_complete();
+                } else {
+                    parse_header(line);
+                }
+                break;
+            case state::BODY_LENGTH:
+                if (end - m_pos < m_remaining) {
+                    m_remaining -= end - m_pos;
+                    m_pos = m_body_end = end;
+                    return false;
+                }
+                m_pos += m_remaining;
+                m_body_end = m_pos;
+                m_remaining = 0;
+                m_state = state::DONE;
+                break;
+            case state::CHUNK_SIZE:
+                if (!next_line(buf, line)) {
+                    return false;
+                }
+                parse_chunk_size(line);
+                break;
+            case state::CHUNK_DATA: {
+                std::size_t n = end - m_pos;
+                if (n > m_remaining) {
+                    n = m_remaining;
+                }
+                // Decode in place by moving the chunk data over the already consumed chunk headers.
+                if (m_body_end != m_pos) {
+                    std::memmove(base + m_body_end, base + m_pos, n);
+                }
+                m_body_end += n;
+                m_pos += n;
+                m_scan = m_pos;
+                m_remaining -= n;
+                if (m_remaining) {
+                    return false;
+                }
+                m_state = state::CHUNK_END;
+                break;
+            }
+            case state::CHUNK_END:
+                if (!next_line(buf, line)) {
+                    return false;
+                }
+                if (!line.empty()) {
+                    throw tasks_exception(tasks_error::HTTP_INVALID_CHUNK, "http_parser: Missing CRLF after chunk");
+                }
+                m_state = state::CHUNK_SIZE;
+                break;
+            case state::TRAILERS:
+                if (!next_line(buf, line)) {
+                    return false;
+                }
+                if (line.empty()) {
+                    m_state = state::DONE;
+                } else {
+                    parse_header(line);
+                }
+                break;
+            case state::BODY_CLOSE:
+                // Everything up to the connection close belongs to the body.
+                m_pos = m_scan = m_body_end = end;
+                return false;
+            case state::DONE:
+                return true;
+        }
+    }
+}
+
+bool http_parser::finish_eof() {
+    if (state::BODY_CLOSE == m_state) {
+        tdbg("http_parser: Connection closed, close delimited body has " << content_length() << " bytes"
+                                                                         << std::endl);
+        m_state = state::DONE;
+        return true;
+    }
+    return false;
+}
+
+bool http_parser::next_line(tools::buffer& buf, tools::string_view& line) {
+    const char* base = buf.ptr_begin();
+    std::size_t end = buf.offset_write();
+    std::size_t scan = m_scan > m_pos ? m_scan : m_pos;
+    const char* eol = tools::find_char(base + scan, base + end, '\n');
+    if (base + end == eol) {
+        m_scan = end;
+        if (end - m_pos > HTTP_PARSER_MAX_LINE) {
+            throw tasks_exception(tasks_error::HTTP_INVALID_HEADER, "http_parser: Line too long");
+        }
+        return false;
+    }
+    std::size_t len = eol - (base + m_pos);
+    if (len && '\r' == base[m_pos + len - 1]) {
+        len--;
+    }
+    line = tools::string_view(base + m_pos, len);
+    m_pos = eol - base + 1;
+    m_scan = m_pos;
+    return true;
+}
+
+void http_parser::parse_status_line(tools::string_view line) {
+    // HTTP/#.# ### text
+    if (line.size() < 12 || line.substr(0, 5) != "HTTP/") {
+        throw tasks_exception(tasks_error::HTTP_INVALID_STATUS_CODE,
+                              "http_parser: Invalid status line " + line.to_string());
+    }
+    m_http11 = line.substr(5, 3) != "1.0";
+    std::size_t space = line.find(' ');
+    if (tools::string_view::npos == space) {
+        throw tasks_exception(tasks_error::HTTP_INVALID_STATUS_CODE,
+                              "http_parser: Invalid status line " + line.to_string());
+    }
+    tools::string_view status = line.substr(space + 1);
+    m_status_code = static_cast<int>(tools::to_size(status));
+    if (m_status_code < 100 || m_status_code > 999) {
+        throw tasks_exception(tasks_error::HTTP_INVALID_STATUS_CODE,
+                              "http_parser: Invalid status code " + std::to_string(m_status_code));
+    }
+    m_handler->on_status_line(m_status_code, status);
+}
+
+void http_parser::parse_request_line(tools::string_view line) {
+    // METHOD URL HTTP/#.#
+    std::size_t sp1 = line.find(' ');
+    std::size_t sp2 = line.rfind(' ');
+    if (tools::string_view::npos == sp1 || sp1 == sp2 || 0 == sp1 || line.size() - sp2 < 9 ||
+        line.substr(sp2 + 1, 5) != "HTTP/") {
+        throw tasks_exception(tasks_error::HTTP_INVALID_REQUEST_LINE,
+                              "http_parser: Invalid request line " + line.to_string());
+    }
+    m_http11 = line.substr(sp2 + 6, 3) != "1.0";
+    m_handler->on_request_line(line.substr(0, sp1), line.substr(sp1 + 1, sp2 - sp1 - 1));
+}
+
+void http_parser::parse_header(tools::string_view line) {
+    std::size_t colon = line.find(':');
+    if (tools::string_view::npos == colon || 0 == colon) {
+        throw tasks_exception(tasks_error::HTTP_INVALID_HEADER, "http_parser: Invalid header: " + line.to_string());
+    }
+    tools::string_view name = line.substr(0, colon);
+    tools::string_view value = line.substr(colon + 1);
+    while (!value.empty() && (' ' == value.front() || '\t' == value.front())) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && (' ' == value.back() || '\t' == value.back())) {
+        value.remove_suffix(1);
+    }
+    // Only the headers that frame the message are interpreted here. The checks compare the length first, so most
+    // headers are skipped without looking at their characters.
+    if (tools::iequals_lower(name.data(), name.size(), "content-length")) {
+        if (value.empty() || value.front() < '0' || value.front() > '9') {
+            throw tasks_exception(tasks_error::HTTP_INVALID_HEADER,
+                                  "http_parser: Invalid Content-Length: " + value.to_string());
+        }
+        m_remaining = tools::to_size(value);
+        m_has_content_length = true;
+    } else if (tools::iequals_lower(name.data(), name.size(), "transfer-encoding")) {
+        // chunked has to be the last encoding
+        m_chunked = value.size() >= 7 && tools::iequals_lower(value.data() + value.size() - 7, 7, "chunked");
+    } else if (tools::iequals_lower(name.data(), name.size(), "connection")) {
+        m_conn_close = tools::iequals_lower(value.data(), value.size(), "close");
+        m_conn_keepalive = tools::iequals_lower(value.data(), value.size(), "keep-alive");
+    }
+    m_handler->on_header(name, value);
+}
+
+void http_parser::parse_chunk_size(tools::string_view line) {
+    std::size_t size = 0;
+    std::size_t digits = 0;
+    for (char c : line) {
+        int d;
+        if (c >= '0' && c <= '9') {
+            d = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            d = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            d = c - 'A' + 10;
+        } else {
+            // chunk extensions are ignored
+            break;
+        }
+        if (++digits > sizeof(std::size_t) * 2 - 1) {
+            throw tasks_exception(tasks_error::HTTP_INVALID_CHUNK, "http_parser: Chunk size too big");
+        }
+        size = (size << 4) | d;
+    }
+    if (!digits) {
+        throw tasks_exception(tasks_error::HTTP_INVALID_CHUNK, "http_parser: Invalid chunk size " + line.to_string());
+    }
+    tdbg("http_parser: Chunk of " << size << " bytes" << std::endl);
+    m_remaining = size;
+    m_state = size ? state::CHUNK_DATA : state::TRAILERS;
+}
+
+void http_parser::headers_complete() {
+    m_content_start = m_body_end = m_pos;
+    tdbg("http_parser: Content starts at " << m_content_start << std::endl);
+    if (mode::RESPONSE == m_mode && (m_status_code < 200 || 204 == m_status_code || 304 == m_status_code)) {
+        // No body allowed
+        m_remaining = 0;
+        m_state = state::DONE;
+    } else if (m_chunked) {
+        m_state = state::CHUNK_SIZE;
+    } else if (m_has_content_length) {
+        m_state = m_remaining ? state::BODY_LENGTH : state::DONE;
+    } else if (mode::REQUEST == m_mode) {
+        // Requests without Content-Length or chunked encoding have no body.
+        m_state = state::DONE;
+    } else {
+        m_close_delimited = true;
+        m_state = state::BODY_CLOSE;
+    }
+}
+
+}  // net
+}  // tasks
@@ -16,11 +16,11 @@ void http_request::prepare_data_buffer() {
     assert(m_url.length() > 0);
     std::string ctlen;
     // GET/POST
+    std::string m = method();
+    m_data_buffer.write(m.c_str(), m.length());
+    m_data_buffer.write(" ", 1);
     if (m_content_buffer.size()) {
-        m_data_buffer.write("POST ", 5);
         ctlen = "Content-Length: " + std::to_string(m_content_buffer.size());
-    } else {
-        m_data_buffer.write("GET ", 4);
     }
     m_data_buffer.write(m_url.c_str(), m_url.length());
     m_data_buffer.write(" HTTP/1.1", 9);
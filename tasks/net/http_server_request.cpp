@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <tasks/logging.h>
+#include <tasks/net/http_server_request.h>
+#include <tasks/net/socket.h>
+#include <tasks/tools/scan.h>
+
+namespace tasks {
+namespace net {
+
+void http_server_request::read_data(socket& sock) {
+    if (io_state::DONE == m_state) {
+        // The client is pipelining while the current request is being handled.
+        char buf[READ_BUFFER_SIZE_BLOCK];
+        std::streamsize bytes = 0;
+        do {
+            bytes = sock.read(buf, sizeof(buf));
+            if (bytes > 0) {
+                // Check before buffering, a client must not make us drain the socket into memory.
+                if (m_surplus.size() + bytes > HTTP_SERVER_MAX_PIPELINE) {
+                    throw tasks_exception(tasks_error::HTTP_PIPELINE_OVERFLOW,
+                                          "http_server_request: Too many pipelined bytes");
+                }
+                m_surplus.insert(m_surplus.end(), buf, buf + bytes);
+            }
+        } while (static_cast<std::streamsize>(sizeof(buf)) == bytes);
+        return;
+    }
+    if (io_state::READY == m_state) {
+        m_content_buffer.set_size(READ_BUFFER_SIZE_BLOCK);
+        m_state = io_state::READ_DATA;
+    }
+    std::streamsize towrite = 0, bytes = 0;
+    do {
+        // Keep one byte to terminate the content
+        towrite = m_content_buffer.to_write() - 1;
+        if (towrite < READ_BUFFER_SIZE_BLOCK - 1) {
+            m_content_buffer.set_size(m_content_buffer.buffer_size() + READ_BUFFER_SIZE_BLOCK);
+            towrite = m_content_buffer.to_write() - 1;
+        }
+        bytes = sock.read(m_content_buffer.ptr_write(), towrite);
+        if (bytes > 0) {
+            m_content_buffer.move_ptr_write(bytes);
+            tdbg("http_server_request: read data successfully, " << bytes << " bytes" << std::endl);
+            if (m_parser.parse(m_content_buffer)) {
+                finish_content();
+            } else {
+                check_body();
+            }
+        }
+    } while (towrite == bytes && io_state::DONE != m_state);
+}
+
+void http_server_request::read_pipelined() {
+    if (io_state::READ_DATA == m_state && m_parser.parse(m_content_buffer)) {
+        finish_content();
+    }
+}
+
+void http_server_request::clear() {
+    http_base::clear();
+    m_method.clear();
+    m_url.clear();
+    m_header_count = 0;
+    m_parser.reset();
+    if (!m_surplus.empty()) {
+        tdbg("http_server_request: " << m_surplus.size() << " pipelined bytes" << std::endl);
+        m_content_buffer.write(m_surplus.data(), m_surplus.size());
+        m_surplus.clear();
+        m_state = io_state::READ_DATA;
+    }
+}
+
+void http_server_request::check_body() const {
+    // Chunked bodies are counted with their chunk headers.
+    if (m_parser.get_state() >= http_parser::state::BODY_LENGTH &&
+        m_content_buffer.offset_write() - m_parser.content_start() > HTTP_SERVER_MAX_BODY) {
+        throw tasks_exception(tasks_error::HTTP_BODY_TOO_LARGE, "http_server_request: Body too large");
+    }
+}
+
+void http_server_request::finish_content() {
+    std::size_t end = m_parser.message_end();
+    std::size_t received = m_content_buffer.offset_write();
+    if (received > end) {
+        m_surplus.assign(m_content_buffer.ptr(end), m_content_buffer.ptr(received));
+    }
+    m_content_length = m_parser.content_length();
+    std::size_t content_end = m_parser.content_start() + m_content_length;
+    // Terminate the string for convenience
+    m_content_buffer.set_size(content_end + 1);
+    m_content_buffer.move_ptr_write_abs(content_end);
+    *(m_content_buffer.ptr(content_end)) = 0;
+    m_content_buffer.set_size(content_end);
+    m_content_buffer.move_ptr_read_abs(m_parser.content_start());
+    m_state = io_state::DONE;
+}
+
+void http_server_request::on_request_line(tools::string_view method, tools::string_view url) {
+    m_method = method.to_string();
+    m_url = url.to_string();
+    tdbg("http_server_request: " << m_method << " " << m_url << std::endl);
+}
+
+void http_server_request::on_header(tools::string_view name, tools::string_view value) {
+    if (++m_header_count > HTTP_SERVER_MAX_HEADERS) {
+        throw tasks_exception(tasks_error::HTTP_TOO_MANY_HEADERS, "http_server_request: Too many headers");
+    }
+    // Refuse a body that is too large before reading it. More than 19 digits would overflow the length.
+    if (tools::iequals_lower(name.data(), name.size(), "content-length") &&
+        (value.size() > 19 || tools::to_size(value) > HTTP_SERVER_MAX_BODY)) {
+        throw tasks_exception(tasks_error::HTTP_BODY_TOO_LARGE, "http_server_request: Content-Length too large");
+    }
+    auto pair = m_headers.insert(std::make_pair(name.to_string(), value.to_string()));
+    if (pair.second) {
+        tdbg("http_server_request: Header: " << pair.first->first << " = " << pair.first->second << std::endl);
+    }
+}
+
+}  // net
+}  // tasks
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <tasks/logging.h>
+#include <tasks/net/http_server_task.h>
+
+namespace tasks {
+namespace net {
+
+http_server_task::timeouts_t http_server_task::m_default_timeouts;
+
+void http_server_task::send_response() {
+    worker* w = worker::get();
+    assert(nullptr != w);
+    if (!reuse_connection()) {
+        m_response.set_header("Connection", "close");
+    } else if (!m_request.http11()) {
+        m_response.set_header("Connection", "keep-alive");
+    }
+    set_events(EV_WRITE);
+    update_watcher(w);
+    arm_deadline(m_timeouts.write);
+}
+
+bool http_server_task::handle_event(tasks::worker* worker, int revents) {
+    bool success = true;
+    try {
+        if (EV_READ & revents) {
+            // Data read while a request is being handled belongs to the next request.
+            bool busy = m_request.done();
+            m_request.read_data(socket());
+            if (!busy) {
+                if (m_request.done()) {
+                    arm_deadline(m_timeouts.request);
+                    success = handle_request();
+                } else {
+                    // Reading a request counts as activity.
+                    arm_deadline(m_timeouts.read > 0. ? m_timeouts.read : m_timeouts.idle);
+                }
+            }
+        } else if (EV_WRITE & revents) {
+            m_response.write_data(socket());
+            if (m_response.done()) {
+                bool reuse = reuse_connection();
+                finish_request();
+                if (reuse) {
+                    m_request.clear();
+                    set_events(EV_READ);
+                    update_watcher(worker);
+                    // Answer pipelined requests that have been read already.
+                    m_request.read_pipelined();
+                    if (m_request.done()) {
+                        arm_deadline(m_timeouts.request);
+                        success = handle_request();
+                    } else {
+                        arm_deadline(m_timeouts.idle);
+                    }
+                } else {
+                    success = false;
+                }
+            } else {
+                arm_deadline(m_timeouts.write);
+            }
+        }
+    } catch (tasks::tasks_exception& e) {
+        if (tasks_error::SOCKET_NOCON == e.error_code()) {
+            tdbg("http_server_task(" << this << "): client disconnected" << std::endl);
+            success = false;
+        } else if (reject_request(e)) {
+            tdbg("http_server_task(" << this << "): rejecting request: " << e.what() << std::endl);
+        } else {
+            tdbg("http_server_task(" << this << "): exception: " << e.what() << std::endl);
+            set_exception(e);
+            success = false;
+        }
+    }
+    return success;
+}
+
+bool http_server_task::reject_request(const tasks_exception& e) {
+    switch (e.error_code()) {
+        case tasks_error::HTTP_TOO_MANY_HEADERS:
+            m_response.set_status("431 Request Header Fields Too Large");
+            break;
+        case tasks_error::HTTP_BODY_TOO_LARGE:
+            m_response.set_status("413 Payload Too Large");
+            break;
+        default:
+            return false;
+    }
+    // The rest of the request can't be parsed, so the connection gets closed after the response.
+    m_reject = true;
+    send_response();
+    return true;
+}
+
+}  // net
+}  // tasks
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <tasks/logging.h>
+#include <tasks/worker.h>
+#include <tasks/net/http_fanout.h>
+#include <tasks/net/http_singleflight.h>
+
+namespace tasks {
+namespace net {
+
+bool http_singleflight::send(std::shared_ptr<http_request> request, response_func_t f) {
+    if (request->content_buffer().size()) {
+        // Requests with a body can have side effects and their key does not cover the body.
+        send(std::string(), request, f);
+        return true;
+    }
+    return send(key(*request), request, f);
+}
+
+bool http_singleflight::send(const std::string& key, std::shared_ptr<http_base> request, response_func_t f) {
+    waiter w = {f, worker::get()};
+    std::shared_ptr<flight> fl = std::make_shared<flight>();
+    fl->waiters.push_back(w);
+    if (!key.empty()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_flights.find(key);
+        if (m_flights.end() != it) {
+            tdbg("http_singleflight: joining " << key << std::endl);
+            it->second->waiters.push_back(w);
+            return false;
+        }
+        m_flights[key] = fl;
+    }
+    tdbg("http_singleflight: sending " << key << std::endl);
+    try {
+        http_fanout::send(request, [this, key, fl](std::shared_ptr<http_response>& response, const tasks_exception& e) {
+            complete(key, fl, response, e);
+        });
+    } catch (tasks_exception& e) {
+        complete(key, fl, nullptr, e);
+    }
+    return true;
+}
+
+std::size_t http_singleflight::in_flight() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_flights.size();
+}
+
+std::string http_singleflight::key(const http_request& request) {
+    return request.method() + " " + request.host() + ":" + std::to_string(request.port()) + request.url();
+}
+
+void http_singleflight::complete(const std::string& key, std::shared_ptr<flight> f,
+                                 std::shared_ptr<http_response> response, const tasks_exception& e) {
+    std::vector<waiter> waiters;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!key.empty()) {
+            auto it = m_flights.find(key);
+            if (m_flights.end() != it && it->second == f) {
+                m_flights.erase(it);
+            }
+        }
+        // Late joiners are added under the lock, so the list is complete now.
+        waiters.swap(f->waiters);
+    }
+    tdbg("http_singleflight: " << key << " done, " << waiters.size() << " waiters" << std::endl);
+    for (auto& w : waiters) {
+        if (nullptr == w.origin) {
+            w.func(response, e);
+        } else {
+            response_func_t func = w.func;
+            w.origin->exec_in_worker_ctx([func, response, e](struct ev_loop*) { func(response, e); });
+        }
+    }
+}
+
+}  // net
+}  // tasks
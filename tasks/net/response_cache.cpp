@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <tasks/logging.h>
+#include <tasks/timer_wheel.h>
+#include <tasks/net/response_cache.h>
+#include <tasks/net/uwsgi_request.h>
+
+namespace tasks {
+namespace net {
+
+response_cache::response_cache(std::size_t max_bytes, double ttl, std::vector<std::string> key_vars,
+                               std::size_t shards)
+    : m_key_vars(std::move(key_vars)), m_ttl_ms(static_cast<int64_t>(ttl * 1000)) {
+    std::size_t n = 1;
+    while (n < shards) {
+        n <<= 1;
+    }
+    for (std::size_t i = 0; i < n; i++) {
+        m_shards.emplace_back(new shard());
+    }
+    m_shard_bytes = max_bytes / n;
+}
+
+bool response_cache::key(const uwsgi_request& request, std::string& key) const {
+    // Only requests without side effects are answered from the cache.
+    if (request.var(uwsgi_var::REQUEST_METHOD) != "GET") {
+        return false;
+    }
+    key.clear();
+    for (auto& name : m_key_vars) {
+        tools::string_view val = request.var_view(name);
+        key.append(val.data(), val.size());
+        key.push_back('\0');
+    }
+    return true;
+}
+
+response_cache::entry_t response_cache::get(const std::string& key) {
+    shard& s = get_shard(key);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.index.find(key);
+    if (s.index.end() == it) {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    if (it->second->expires_ms <= timer_wheel::now_ms()) {
+        erase(s, it->second);
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    s.lru.splice(s.lru.begin(), s.lru, it->second);
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return it->second->bytes;
+}
+
+void response_cache::put(const std::string& key, std::string bytes) {
+    shard& s = get_shard(key);
+    std::size_t size = bytes.size();
+    if (size > m_shard_bytes) {
+        return;
+    }
+    entry e = {key, std::make_shared<const std::string>(std::move(bytes)), timer_wheel::now_ms() + m_ttl_ms};
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.index.find(key);
+    if (s.index.end() != it) {
+        erase(s, it->second);
+    }
+    s.lru.push_front(std::move(e));
+    s.index[key] = s.lru.begin();
+    s.bytes += size;
+    while (s.bytes > m_shard_bytes) {
+        tdbg("response_cache: evicting " << s.lru.back().bytes->size() << " bytes" << std::endl);
+        erase(s, std::prev(s.lru.end()));
+    }
+}
+
+void response_cache::clear() {
+    for (auto& s : m_shards) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        s->lru.clear();
+        s->index.clear();
+        s->bytes = 0;
+    }
+}
+
+std::size_t response_cache::size() const {
+    std::size_t count = 0;
+    for (auto& s : m_shards) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        count += s->lru.size();
+    }
+    return count;
+}
+
+std::size_t response_cache::bytes() const {
+    std::size_t count = 0;
+    for (auto& s : m_shards) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        count += s->bytes;
+    }
+    return count;
+}
+
+void response_cache::erase(shard& s, std::list<entry>::iterator it) {
+    s.bytes -= it->bytes->size();
+    s.index.erase(it->key);
+    s.lru.erase(it);
+}
+
+}  // net
+}  // tasks
@@ -144,7 +144,7 @@ socket socket::accept() {
     return socket(client);
 }
 
-void socket::connect(const std::string& path) {
+bool socket::connect(const std::string& path, bool wait) {
     m_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
     if (m_fd < 0) {
         throw tasks_exception(tasks_error::SOCKET_SOCKET, "socket failed: " + std::string(std::strerror(errno)), errno);
@@ -162,27 +162,14 @@ void socket::connect(const std::string& path) {
     std::strcpy(addr.sun_path, path.c_str());
 
 #ifdef _OS_LINUX_
-    if (::connect(m_fd, (struct sockaddr *)&addr, sizeof(addr.sun_family) + path.length())) {
-        throw tasks_exception(tasks_error::SOCKET_CONNECT, "connect failed: " + std::string(std::strerror(errno)),
-                              errno);
-    }
+    return connect((struct sockaddr *)&addr, sizeof(addr.sun_family) + path.length(), wait);
 #else
     addr.sun_len = SUN_LEN(&addr);
-    if (::connect(m_fd, (struct sockaddr *)&addr, SUN_LEN(&addr))) {
-        throw tasks_exception(tasks_error::SOCKET_CONNECT, "connect failed: " + std::string(std::strerror(errno)),
-                              errno);
-    }
+    return connect((struct sockaddr *)&addr, SUN_LEN(&addr), wait);
 #endif
-
-    if (!m_blocking) {
-        if (fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL, 0) | O_NONBLOCK)) {
-            throw tasks_exception(tasks_error::SOCKET_FNCTL, "fcntl failed: " + std::string(std::strerror(errno)),
-                                  errno);
-        }
-    }
 }
 
-void socket::connect(const std::string& host, int port) {
+bool socket::connect(const std::string& host, int port, bool wait) {
     struct hostent *remote = gethostbyname(host.c_str());
     if (nullptr == remote) {
         throw tasks_exception(tasks_error::SOCKET_NOHOST, "Host " + host + " not found");
@@ -203,15 +190,41 @@ void socket::connect(const std::string& host, int port) {
     addr.sin_family = AF_INET;
     std::memcpy(&addr.sin_addr, remote->h_addr_list[0], remote->h_length);
     addr.sin_port = htons(port);
-    if (::connect(m_fd, (struct sockaddr *)&addr, sizeof(addr))) {
+    return connect((struct sockaddr *)&addr, sizeof(addr), wait);
+}
+
+bool socket::connect(const struct sockaddr* addr, socklen_t addr_len, bool wait) {
+    if (!wait) {
+        // Switch to non-blocking mode first, so the connect returns right away.
+        set_nonblocking();
+    }
+    if (::connect(m_fd, addr, addr_len)) {
+        if (!wait && EINPROGRESS == errno) {
+            return false;
+        }
         throw tasks_exception(tasks_error::SOCKET_CONNECT, "connect failed: " + std::string(std::strerror(errno)),
                               errno);
     }
-    if (!m_blocking) {
-        if (fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL, 0) | O_NONBLOCK)) {
-            throw tasks_exception(tasks_error::SOCKET_FNCTL, "fcntl failed: " + std::string(std::strerror(errno)),
-                                  errno);
-        }
+    if (wait && !m_blocking) {
+        set_nonblocking();
+    }
+    return true;
+}
+
+void socket::finish_connect() {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &err, &len)) {
+        err = errno;
+    }
+    if (err) {
+        throw tasks_exception(tasks_error::SOCKET_CONNECT, "connect failed: " + std::string(std::strerror(err)), err);
+    }
+}
+
+void socket::set_nonblocking() {
+    if (fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL, 0) | O_NONBLOCK)) {
+        throw tasks_exception(tasks_error::SOCKET_FNCTL, "fcntl failed: " + std::string(std::strerror(errno)), errno);
     }
 }
 
@@ -248,6 +261,21 @@ std::streamsize socket::write(const char *data, std::size_t len, int port, std::
     return bytes;
 }
 
+std::streamsize socket::writev(const struct iovec *iov, int iovcnt) {
+    // sendmsg instead of writev to pass SEND_RECV_FLAGS
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = const_cast<struct iovec *>(iov);
+    msg.msg_iovlen = iovcnt;
+    ssize_t bytes = sendmsg(m_fd, &msg, SEND_RECV_FLAGS);
+    if (bytes < 0 && errno != EAGAIN) {
+        std::stringstream s;
+        s << "error writing to client file descriptor " << m_fd << ": " << std::strerror(errno);
+        throw tasks_exception(tasks_error::SOCKET_WRITE, s.str(), errno);
+    }
+    return bytes;
+}
+
 std::streamsize socket::read(char *data, std::size_t len) {
     sockaddr *addr = nullptr;
     socklen_t addr_len = 0;
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <cstring>
+#include <vector>
+
+#include <tasks/dispatcher.h>
+#include <tasks/worker.h>
+#include <tasks/logging.h>
+#include <tasks/net/thrift_client_connection.h>
+
+namespace tasks {
+namespace net {
+
+thrift_client_connection::thrift_client_connection(const std::string& host, int port) : net_io_task(EV_READ) {
+    tdbg(get_string() << ": connecting " << host << ":" << port << std::endl);
+    m_connecting = !socket().connect(host, port, false);
+    if (m_connecting) {
+        set_events(EV_WRITE);
+    }
+}
+
+thrift_client_connection::thrift_client_connection(const std::string& path) : net_io_task(EV_READ) {
+    tdbg(get_string() << ": connecting " << path << std::endl);
+    m_connecting = !socket().connect(path, false);
+    if (m_connecting) {
+        set_events(EV_WRITE);
+    }
+}
+
+bool thrift_client_connection::handle_event(tasks::worker* worker, int revents) {
+    try {
+        if (m_connecting) {
+            // The socket became writable, the connect has completed.
+            socket().finish_connect();
+            tdbg(get_string() << ": connected" << std::endl);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_connecting = false;
+        }
+        if (EV_READ & revents) {
+            m_in.read_data(socket());
+            dispatch_replies();
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (EV_WRITE & revents) {
+            m_out.write_data(socket());
+        }
+        update_events(worker);
+    } catch (tasks::tasks_exception& e) {
+        tdbg(get_string() << ": " << e.what() << std::endl);
+        close_connection(e);
+        return false;
+    }
+    return true;
+}
+
+void thrift_client_connection::init_watcher() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    net_io_task::init_watcher();
+    m_added = true;
+}
+
+bool thrift_client_connection::send(const char* data, std::size_t len, int32_t seqid, reply_func_t f) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_closed) {
+            return false;
+        }
+        std::size_t start = m_out.begin_frame();
+        m_out.content_buffer().write(data, len);
+        m_out.end_frame(start);
+        m_calls[seqid] = std::move(f);
+        if (!m_added) {
+            // The watcher gets initialized with these events.
+            update_events(nullptr);
+            return true;
+        }
+        // Keep the connection until the watcher has been updated.
+        disable_dispose();
+    }
+    // The watcher belongs to the event loop. No worker gets assigned in single loop mode, so the dispatcher picks it.
+    dispatcher::instance()->get_worker_by_task(this)->exec_in_worker_ctx([this](struct ev_loop* loop) {
+        // Update the watcher in the worker that runs the loop now.
+        worker* worker = (tasks::worker*)ev_userdata(loop);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_closed) {
+                update_events(worker);
+            }
+        }
+        // The connection can be gone right after this.
+        enable_dispose();
+    });
+    return true;
+}
+
+std::size_t thrift_client_connection::pending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_calls.size();
+}
+
+bool thrift_client_connection::closed() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_closed;
+}
+
+void thrift_client_connection::shutdown() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_closed) {
+        // The worker sees the connection closing and fails the calls in flight.
+        ::shutdown(socket().fd(), SHUT_RDWR);
+    }
+}
+
+void thrift_client_connection::dispatch_replies() {
+    tools::buffer& buf = m_in.content_buffer();
+    std::size_t frame_end;
+    while (m_in.next_frame(frame_end)) {
+        int32_t seqid;
+        reply_func_t f;
+        if (!parse_seqid(buf.ptr_read(), frame_end - buf.offset_read(), seqid)) {
+            throw tasks_exception(tasks_error::THRIFT_INVALID_FRAME, "thrift_client_connection: Invalid reply header");
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_calls.find(seqid);
+            if (m_calls.end() != it) {
+                f = std::move(it->second);
+                m_calls.erase(it);
+            }
+        }
+        if (f) {
+            // No lock is held, so the callback can send the next call.
+            f(&m_in, tasks_exception());
+        } else {
+            tdbg(get_string() << ": dropping reply for unknown seqid " << seqid << std::endl);
+        }
+        buf.move_ptr_read_abs(frame_end);
+    }
+    m_in.compact();
+}
+
+void thrift_client_connection::close_connection(const tasks_exception& e) {
+    std::unordered_map<int32_t, reply_func_t> calls;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        calls.swap(m_calls);
+    }
+    for (auto& c : calls) {
+        c.second(nullptr, e);
+    }
+    if (m_close_func) {
+        m_close_func(this);
+    }
+}
+
+void thrift_client_connection::update_events(worker* worker) {
+    if (m_connecting) {
+        // Calls are buffered until the connection has been established.
+        set_events(EV_WRITE);
+    } else {
+        set_events(m_out.pending() ? EV_READ | EV_WRITE : EV_READ);
+    }
+    if (nullptr != worker) {
+        update_watcher(worker);
+    }
+}
+
+namespace {
+
+inline int32_t read_i32(const char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return static_cast<int32_t>(ntohl(v));
+}
+
+}  // anon
+
+bool thrift_client_connection::parse_seqid(const char* data, std::size_t len, int32_t& seqid) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    if (len < 1) {
+        return false;
+    }
+    if (0x82 == p[0]) {
+        // compact: protocol id, version and type, varint seqid, name
+        std::size_t pos = 2;
+        uint32_t v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (pos >= len) {
+                return false;
+            }
+            uint8_t b = p[pos++];
+            v |= static_cast<uint32_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                seqid = static_cast<int32_t>(v);
+                return true;
+            }
+        }
+        return false;
+    }
+    if (len < 8) {
+        return false;
+    }
+    int32_t first = read_i32(data);
+    std::size_t pos;
+    if (first < 0) {
+        // strict binary: version and type, name length, name, seqid
+        std::size_t name_len = static_cast<uint32_t>(read_i32(data + 4));
+        pos = 8 + name_len;
+    } else {
+        // old binary: name length, name, type, seqid
+        pos = 4 + static_cast<std::size_t>(first) + 1;
+    }
+    if (pos + 4 > len) {
+        return false;
+    }
+    seqid = read_i32(data + pos);
+    return true;
+}
+
+}  // net
+}  // tasks
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include <tasks/logging.h>
+#include <tasks/net/thrift_client_pool.h>
+
+namespace tasks {
+namespace net {
+
+thrift_client_pool::thrift_client_pool(const std::string& host, int port, std::size_t max_connections)
+    : m_state(std::make_shared<state>()) {
+    init({backend_group::endpoint(host, port)}, max_connections);
+}
+
+thrift_client_pool::thrift_client_pool(const std::string& path, std::size_t max_connections)
+    : m_state(std::make_shared<state>()) {
+    init({backend_group::endpoint(path)}, max_connections);
+}
+
+thrift_client_pool::thrift_client_pool(std::shared_ptr<backend_group> group, std::size_t max_connections)
+    : m_state(std::make_shared<state>()) {
+    std::vector<backend_group::endpoint> endpoints;
+    for (std::size_t i = 0; i < group->size(); i++) {
+        endpoints.push_back(group->get_endpoint(i));
+    }
+    init(endpoints, max_connections);
+    m_state->group = group;
+}
+
+void thrift_client_pool::init(std::vector<backend_group::endpoint> endpoints, std::size_t max_connections) {
+    m_state->conns.resize(endpoints.size());
+    m_state->endpoints = std::move(endpoints);
+    m_state->max_connections = std::max<std::size_t>(max_connections, 1);
+}
+
+thrift_client_pool::~thrift_client_pool() {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    for (auto& conns : m_state->conns) {
+        for (auto* conn : conns) {
+            conn->shutdown();
+        }
+        conns.clear();
+    }
+}
+
+void thrift_client_pool::send(const char* data, std::size_t len, int32_t seqid,
+                              thrift_client_connection::reply_func_t f) {
+    std::size_t idx = 0;
+    std::shared_ptr<backend_group> group = m_state->group;
+    if (nullptr != group) {
+        idx = group->acquire();
+        auto start = std::chrono::steady_clock::now();
+        f = [f, group, idx, start](thrift_frame_buffer* reply, const tasks_exception& e) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            group->release(idx, seconds, tasks_error::UNSET == e.error_code());
+            f(reply, e);
+        };
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    try {
+        // A connection can close between picking and sending, try again with another one then.
+        std::size_t attempts = 1;
+        while (!get_connection(idx)->send(data, len, seqid, f)) {
+            if (++attempts > THRIFT_CLIENT_POOL_SEND_ATTEMPTS) {
+                throw tasks_exception(tasks_error::THRIFT_CLIENT, "thrift_client_pool: Connections keep closing");
+            }
+        }
+    } catch (tasks_exception&) {
+        // No connection could be used, f has not been registered.
+        if (nullptr != group) {
+            group->release(idx, 0., false);
+        }
+        throw;
+    }
+}
+
+std::size_t thrift_client_pool::connections() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    std::size_t count = 0;
+    for (auto& conns : m_state->conns) {
+        count += conns.size();
+    }
+    return count;
+}
+
+thrift_client_connection* thrift_client_pool::get_connection(std::size_t idx) {
+    auto& conns = m_state->conns[idx];
+    // Forget connections that are about to close.
+    conns.erase(std::remove_if(conns.begin(), conns.end(), [](thrift_client_connection* c) { return c->closed(); }),
+                conns.end());
+    thrift_client_connection* best = nullptr;
+    std::size_t best_pending = 0;
+    for (auto* conn : conns) {
+        std::size_t pending = conn->pending();
+        if (nullptr == best || pending < best_pending) {
+            best = conn;
+            best_pending = pending;
+        }
+    }
+    if (nullptr != best && (0 == best_pending || conns.size() >= m_state->max_connections)) {
+        return best;
+    }
+    const backend_group::endpoint& ep = m_state->endpoints[idx];
+    thrift_client_connection* conn;
+    if (ep.tcp()) {
+        conn = new thrift_client_connection(ep.host, ep.port);
+    } else {
+        conn = new thrift_client_connection(ep.path);
+    }
+    tdbg("thrift_client_pool: new connection " << conn << " to " << ep.get_string() << std::endl);
+    std::weak_ptr<state> weak_state = m_state;
+    conn->on_close([weak_state, idx](thrift_client_connection* c) {
+        auto s = weak_state.lock();
+        if (nullptr != s) {
+            std::lock_guard<std::mutex> lock(s->mutex);
+            auto& conns = s->conns[idx];
+            conns.erase(std::remove(conns.begin(), conns.end(), c), conns.end());
+        }
+    });
+    net_io_task::add_task(conn);
+    conns.push_back(conn);
+    return conn;
+}
+
+}  // net
+}  // tasks
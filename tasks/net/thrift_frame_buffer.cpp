@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <arpa/inet.h>
+#include <cstring>
+
+#include <tasks/tasks_exception.h>
+#include <tasks/net/thrift_frame_buffer.h>
+
+namespace tasks {
+namespace net {
+
+void thrift_frame_buffer::read_data(socket& sock) {
+    // Once a frame of the maximum size can be complete, the rest stays in the socket until the frames have been
+    // consumed.
+    while (m_buffer.to_read() <= THRIFT_MAX_FRAME + 4) {
+        m_buffer.reserve(THRIFT_READ_BLOCK);
+        std::streamsize bytes = sock.read(m_buffer.ptr_write(), THRIFT_READ_BLOCK);
+        if (bytes > 0) {
+            m_buffer.set_size(m_buffer.size() + bytes);
+            m_buffer.move_ptr_write(bytes);
+        }
+        // Don't read the rest of a frame that is too big.
+        if (m_buffer.to_read() >= 4) {
+            frame_length();
+        }
+        if (THRIFT_READ_BLOCK != bytes) {
+            break;
+        }
+    }
+}
+
+void thrift_frame_buffer::write_data(socket& sock) {
+    while (m_buffer.to_read() > 0) {
+        std::streamsize bytes = sock.write(m_buffer.ptr_read(), m_buffer.to_read());
+        if (bytes <= 0) {
+            break;
+        }
+        m_buffer.move_ptr_read(bytes);
+    }
+    if (0 == m_buffer.to_read()) {
+        m_buffer.clear();
+    }
+}
+
+bool thrift_frame_buffer::next_frame(std::size_t& frame_end) {
+    if (m_buffer.to_read() < 4) {
+        return false;
+    }
+    uint32_t len = frame_length();
+    if (m_buffer.to_read() - 4 < static_cast<std::streamsize>(len)) {
+        return false;
+    }
+    m_buffer.move_ptr_read(4);
+    frame_end = m_buffer.offset_read() + len;
+    return true;
+}
+
+uint32_t thrift_frame_buffer::frame_length() const {
+    uint32_t len;
+    std::memcpy(&len, m_buffer.ptr_read(), 4);
+    len = ntohl(len);
+    if (len > THRIFT_MAX_FRAME) {
+        throw tasks_exception(tasks_error::THRIFT_INVALID_FRAME,
+                              "thrift_frame_buffer: Frame size " + std::to_string(len) + " too big");
+    }
+    return len;
+}
+
+void thrift_frame_buffer::compact() {
+    std::size_t left = m_buffer.to_read();
+    if (left && m_buffer.offset_read()) {
+        std::memmove(m_buffer.ptr_begin(), m_buffer.ptr_read(), left);
+    }
+    m_buffer.clear();
+    m_buffer.set_size(left);
+    m_buffer.move_ptr_write(left);
+}
+
+std::size_t thrift_frame_buffer::begin_frame() {
+    std::size_t start = m_buffer.size();
+    uint32_t len = 0;
+    m_buffer.write(reinterpret_cast<const char*>(&len), 4);
+    return start;
+}
+
+void thrift_frame_buffer::end_frame(std::size_t start) {
+    uint32_t len = htonl(static_cast<uint32_t>(m_buffer.size() - start - 4));
+    std::memcpy(m_buffer.ptr(start), &len, 4);
+}
+
+}  // net
+}  // tasks
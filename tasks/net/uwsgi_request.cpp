@@ -35,9 +35,8 @@ void uwsgi_request::read_vars(socket& sock) {
         if (UWSGI_VARS == m_header.modifier1) {
             parse_vars();
             // Check if a http body needs to be read
-            std::string content_len_s = var("CONTENT_LENGTH");
-            if (NO_VAL != content_len_s) {
-                std::size_t content_len_i = std::atoi(content_len_s.c_str());
+            std::size_t content_len_i = tools::to_size(var(uwsgi_var::CONTENT_LENGTH));
+            if (content_len_i) {
                 m_content_buffer.set_size(content_len_i);
                 m_state = io_state::READ_CONTENT;
             } else {
@@ -74,6 +73,7 @@ void uwsgi_request::read_data(socket& sock) {
 }
 
 void uwsgi_request::parse_vars() {
+    bool copy = uwsgi_parse_mode::COPY == m_parse_mode;
     std::size_t pos = 0;
     while (pos < m_data_buffer.size()) {
         uint16_t key_len = *((uint16_t*)m_data_buffer.ptr(pos));
@@ -81,12 +81,58 @@ void uwsgi_request::parse_vars() {
         uint16_t val_len = *((uint16_t*)m_data_buffer.ptr(key_start + key_len));
         uint16_t val_start = key_start + key_len + 2;
         if (key_len && val_len) {
-            std::string key(m_data_buffer.ptr(key_start), key_len);
-            std::string val(m_data_buffer.ptr(val_start), val_len);
-            set_header(std::ref(key), std::ref(val));
+            tools::string_view key(m_data_buffer.ptr(key_start), key_len);
+            tools::string_view val(m_data_buffer.ptr(val_start), val_len);
+            uwsgi_var slot = uwsgi_vars::lookup(key);
+            if (uwsgi_var::COUNT != slot) {
+                m_var_slots[static_cast<std::size_t>(slot)] = val;
+            } else if (!copy) {
+                m_var_fallback.push_back(std::make_pair(key, val));
+            }
+            if (copy) {
+                set_header(key.to_string(), val.to_string());
+            }
         }
         pos = val_start + val_len;
     }
+    m_vars_materialized = copy;
+}
+
+tools::string_view uwsgi_request::var_view(tools::string_view key) const {
+    uwsgi_var slot = uwsgi_vars::lookup(key);
+    if (uwsgi_var::COUNT != slot) {
+        return m_var_slots[static_cast<std::size_t>(slot)];
+    }
+    if (uwsgi_parse_mode::COPY == m_parse_mode) {
+        auto h = m_headers.find(key.to_string());
+        if (m_headers.end() != h) {
+            return h->second;
+        }
+    } else {
+        for (auto& kv : m_var_fallback) {
+            if (kv.first == key) {
+                return kv.second;
+            }
+        }
+    }
+    return tools::string_view();
+}
+
+void uwsgi_request::materialize_vars() const {
+    if (m_vars_materialized || uwsgi_parse_mode::COPY == m_parse_mode) {
+        return;
+    }
+    // The headers map is a cache of the views in zero copy mode, so filling it does not change the logical state.
+    uwsgi_request* self = const_cast<uwsgi_request*>(this);
+    for (std::size_t i = 0; i < uwsgi_vars::COUNT; i++) {
+        if (!m_var_slots[i].empty()) {
+            self->set_header(uwsgi_vars::names[i], m_var_slots[i].to_string());
+        }
+    }
+    for (auto& kv : m_var_fallback) {
+        self->set_header(kv.first.to_string(), kv.second.to_string());
+    }
+    self->m_vars_materialized = true;
 }
 
 void uwsgi_request::prepare_data_buffer() {
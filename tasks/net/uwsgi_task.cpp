@@ -8,19 +8,97 @@
 #include <tasks/logging.h>
 #include <tasks/net/uwsgi_task.h>
 
+#include <strings.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <cctype>
 #include <sstream>
 
 namespace tasks {
 namespace net {
 
-bool uwsgi_task::handle_event(tasks::worker* /* worker */, int revents) {
+namespace {
+
+/// \return True if the line starting at pos is the header name.
+inline bool is_header(const std::string& bytes, std::size_t pos, const char* name, std::size_t len) {
+    return bytes.size() > pos + len && ':' == bytes[pos + len] && 0 == strncasecmp(bytes.data() + pos, name, len);
+}
+
+/// \return True if the value of the header line from pos to eol contains the token, ignoring the case.
+inline bool header_contains(const std::string& bytes, std::size_t pos, std::size_t eol, const std::string& token) {
+    std::string value = bytes.substr(pos, eol - pos);
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return std::tolower(c); });
+    return std::string::npos != value.find(token, value.find(':'));
+}
+
+/// \return True if a serialized response is meant for a single client. It sets a cookie, depends on request headers
+/// the cache key does not cover, or forbids shared caching.
+inline bool is_private(const std::string& bytes, std::size_t pos, std::size_t eol) {
+    return is_header(bytes, pos, "Set-Cookie", 10) || is_header(bytes, pos, "Vary", 4) ||
+           (is_header(bytes, pos, "Cache-Control", 13) &&
+            (header_contains(bytes, pos, eol, "no-store") || header_contains(bytes, pos, eol, "private")));
+}
+
+/// Remove the headers that only apply to the first response from a serialized response. A cached response gets a
+/// current Date header when it is written and the Connection header depends on the connection it was written to.
+///
+/// \return False if the response must not be cached.
+bool strip_headers(std::string& bytes) {
+    std::size_t end = bytes.find("\r\n\r\n");
+    if (std::string::npos == end) {
+        return false;
+    }
+    std::string stripped;
+    stripped.reserve(bytes.size());
+    // Keep the status line.
+    std::size_t pos = bytes.find("\r\n") + 2;
+    stripped.append(bytes, 0, pos);
+    while (pos < end + 2) {
+        std::size_t eol = bytes.find("\r\n", pos) + 2;
+        if (is_private(bytes, pos, eol)) {
+            return false;
+        }
+        if (!is_header(bytes, pos, "Date", 4) && !is_header(bytes, pos, "Connection", 10)) {
+            stripped.append(bytes, pos, eol - pos);
+        }
+        pos = eol;
+    }
+    stripped.append(bytes, pos, std::string::npos);
+    bytes.swap(stripped);
+    return true;
+}
+
+}  // anon
+
+bool uwsgi_task::m_default_keep_alive = false;
+uwsgi_task::timeouts_t uwsgi_task::m_default_timeouts;
+std::shared_ptr<response_cache> uwsgi_task::m_default_cache;
+
+bool uwsgi_task::handle_event(tasks::worker* worker, int revents) {
     bool success = true;
     try {
         if (EV_READ & revents) {
             m_request.read_data(socket());
             if (m_request.done()) {
+                arm_deadline(m_timeouts.request);
                 if (UWSGI_VARS == m_request.uwsgi_header().modifier1) {
-                    success = handle_request();
+                    if (m_keep_alive) {
+                        // Leave pipelined requests in the socket buffer until the response has been written.
+                        set_events(EV_NONE);
+                        update_watcher(worker);
+                    }
+                    if (nullptr != m_cache && lookup_cached()) {
+                        tdbg("uwsgi_task(" << this << "): cache hit, " << m_cached->size() << " bytes" << std::endl);
+                        if (write_cached()) {
+                            success = response_written(worker);
+                        } else {
+                            set_events(EV_WRITE);
+                            update_watcher(worker);
+                            arm_deadline(m_timeouts.write);
+                        }
+                    } else {
+                        success = handle_request();
+                    }
                     m_request.clear();
                 } else {
                     // No suuport for anything else for now
@@ -33,26 +111,112 @@ bool uwsgi_task::handle_event(tasks::worker* /* worker */, int revents) {
                     set_exception(e);
                     success = false;
                 }
+            } else {
+                // Reading a request counts as activity.
+                arm_deadline(m_timeouts.read > 0. ? m_timeouts.read : m_timeouts.idle);
             }
         } else if (EV_WRITE & revents) {
-            m_response.write_data(socket());
-            if (m_response.done()) {
-                finish_request();
-#if UWSGI_KEEPALIVE == 1
-                set_events(EV_READ);
-                update_watcher(worker);
-#else
-                success = false;
-#endif
+            if (nullptr != m_cached) {
+                if (write_cached()) {
+                    success = response_written(worker);
+                } else {
+                    arm_deadline(m_timeouts.write);
+                }
+            } else {
+                m_response.write_data(socket());
+                if (m_response.done()) {
+                    if (!m_cache_key.empty()) {
+                        if (200 == m_response.status_code()) {
+                            store_cached();
+                        }
+                        m_cache_key.clear();
+                    }
+                    success = response_written(worker);
+                } else {
+                    arm_deadline(m_timeouts.write);
+                }
             }
         }
     } catch (tasks::tasks_exception& e) {
-        tdbg("uwsgi_task(" << this << "): exception: " << e.what() << std::endl);
-        set_exception(e);
+        if (tasks_error::SOCKET_NOCON == e.error_code() && io_state::READ_HEADER == m_request.state()) {
+            // The peer closed an idle connection.
+            tdbg("uwsgi_task(" << this << "): client disconnected" << std::endl);
+        } else {
+            tdbg("uwsgi_task(" << this << "): exception: " << e.what() << std::endl);
+            set_exception(e);
+        }
         success = false;
     }
     return success;
 }
 
+bool uwsgi_task::lookup_cached() {
+    if (!m_cache->key(m_request, m_cache_key)) {
+        m_cache_key.clear();
+        return false;
+    }
+    m_cached = m_cache->get(m_cache_key);
+    if (nullptr == m_cached) {
+        // The handler creates the response, it gets stored when it has been written.
+        return false;
+    }
+    m_cache_key.clear();
+    m_cached_offset = 0;
+    m_cached_split = m_cached->find("\r\n") + 2;
+    tools::string_view date = http_response::date_header();
+    m_cached_date.assign(date.data(), date.size());
+    return true;
+}
+
+void uwsgi_task::store_cached() {
+    std::string bytes;
+    m_response.append_serialized(bytes);
+    if (strip_headers(bytes)) {
+        m_cache->put(m_cache_key, std::move(bytes));
+    } else {
+        tdbg("uwsgi_task(" << this << "): not caching a private response" << std::endl);
+    }
+}
+
+bool uwsgi_task::write_cached() {
+    // The status line, the Date header and the rest of the response. Usually all of it goes out with this single
+    // write.
+    const char* data[3] = {m_cached->data(), m_cached_date.data(), m_cached->data() + m_cached_split};
+    std::size_t len[3] = {m_cached_split, m_cached_date.size(), m_cached->size() - m_cached_split};
+    struct iovec iov[3];
+    int iovcnt = 0;
+    std::size_t skip = m_cached_offset;
+    for (int i = 0; i < 3; i++) {
+        if (skip >= len[i]) {
+            skip -= len[i];
+            continue;
+        }
+        iov[iovcnt].iov_base = const_cast<char*>(data[i] + skip);
+        iov[iovcnt].iov_len = len[i] - skip;
+        iovcnt++;
+        skip = 0;
+    }
+    std::streamsize bytes = socket().writev(iov, iovcnt);
+    if (bytes > 0) {
+        m_cached_offset += bytes;
+    }
+    if (m_cached_offset < m_cached->size() + m_cached_date.size()) {
+        return false;
+    }
+    m_cached.reset();
+    return true;
+}
+
+bool uwsgi_task::response_written(tasks::worker* worker) {
+    finish_request();
+    if (m_keep_alive) {
+        set_events(EV_READ);
+        update_watcher(worker);
+        arm_deadline(m_timeouts.idle);
+        return true;
+    }
+    return false;
+}
+
 }  // net
 }  // tasks
@@ -5,6 +5,8 @@
  * Author: Andreas Pohl
  */
 
+#include <sys/socket.h>
+
 #include <tasks/worker.h>
 #include <tasks/net_io_task.h>
 #include <tasks/logging.h>
@@ -22,6 +24,8 @@ net_io_task::net_io_task(net::socket& socket, int events) : net_io_task(events)
 net_io_task::~net_io_task() {
     tdbg(get_string() << ": dtor" << std::endl);
     // NOTE: The watcher will be stoped by dispose().
+    // Cancel the deadline before the fd can be reused.
+    m_deadline.cancel();
     if (m_auto_close) {
         tdbg(get_string() << ": closing socket" << std::endl);
         m_socket.close();
@@ -39,4 +43,10 @@ void net_io_task::add_task(worker* worker, net_io_task* task) {
 
 void net_io_task::add_task(net_io_task* task) { dispatcher::instance()->add_task(task); }
 
+void net_io_task::expire_deadline() {
+    tdbg(get_string() << ": deadline passed, shutting down" << std::endl);
+    // Runs in the event loop, the task itself may be busy in another thread.
+    ::shutdown(m_socket.fd(), SHUT_RDWR);
+}
+
 }  // tasks
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cassert>
+
+#include <tasks/ready_queue.h>
+
+namespace tasks {
+
+void ready_queue::push(const event& e) { push(e, e.task->priority()); }
+
+void ready_queue::push(const event& e, event_priority p) {
+    m_levels[static_cast<std::size_t>(p)].push_back(e);
+    m_size++;
+}
+
+event ready_queue::pop() {
+    assert(!empty());
+    std::size_t level = 0;
+    while (m_levels[level].empty()) {
+        level++;
+    }
+    // A lower level that has been passed over too often goes first.
+    for (std::size_t l = level + 1; l < EVENT_PRIORITIES; l++) {
+        if (m_skipped[l] >= READY_QUEUE_STARVATION_LIMIT && !m_levels[l].empty()) {
+            level = l;
+            break;
+        }
+    }
+    for (std::size_t l = level + 1; l < EVENT_PRIORITIES; l++) {
+        if (!m_levels[l].empty()) {
+            m_skipped[l]++;
+        }
+    }
+    return take(level);
+}
+
+event ready_queue::take(std::size_t level) {
+    event e = std::move(m_levels[level].front());
+    m_levels[level].pop_front();
+    m_skipped[level] = 0;
+    m_size--;
+    return e;
+}
+
+}  // tasks
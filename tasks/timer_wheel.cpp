@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <tasks/timer_wheel.h>
+#include <tasks/worker.h>
+
+namespace tasks {
+
+void wheel_timer::arm(double timeout) {
+    if (timeout <= 0.) {
+        cancel();
+        return;
+    }
+    worker* w = worker::get();
+    if (nullptr == w) {
+        w = dispatcher::instance()->last_worker();
+    }
+    w->wheel().add(this, timer_wheel::now_ms() + static_cast<int64_t>(timeout * 1000));
+}
+
+void wheel_timer::cancel() {
+    timer_wheel* wheel = m_wheel;
+    if (nullptr != wheel) {
+        wheel->remove(this);
+    }
+}
+
+bool wheel_timer::armed() const {
+    timer_wheel* wheel = m_wheel;
+    if (nullptr == wheel) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(wheel->m_mutex);
+    // The timer might have been moved to a different wheel in the meantime.
+    return wheel == m_wheel && nullptr != m_slot;
+}
+
+timer_wheel::timer_wheel(worker* worker) : m_worker(worker) {
+    for (auto& level : m_slots) {
+        for (auto& slot : level) {
+            slot = nullptr;
+        }
+    }
+    m_now = now_ms() / TIMER_WHEEL_TICK_MS;
+    ev_timer_init(&m_watcher, timer_wheel_callback, TIMER_WHEEL_TICK_MS / 1000., TIMER_WHEEL_TICK_MS / 1000.);
+    m_watcher.data = this;
+}
+
+timer_wheel::~timer_wheel() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& level : m_slots) {
+        for (auto& slot : level) {
+            for (wheel_timer* t = slot; nullptr != t; t = t->m_next) {
+                t->m_slot = nullptr;
+                t->m_wheel = nullptr;
+            }
+            slot = nullptr;
+        }
+    }
+}
+
+void timer_wheel::add(wheel_timer* timer, int64_t expires_ms) {
+    timer_wheel* old = timer->m_wheel;
+    if (nullptr != old && this != old) {
+        // The connection moved to a different worker.
+        old->remove(timer);
+    }
+    bool start = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        timer->m_wheel = this;
+        if (nullptr != timer->m_slot) {
+            unlink(timer);
+        }
+        if (0 == m_size) {
+            // Skip the ticks the wheel has been idle.
+            uint64_t now = now_ms() / TIMER_WHEEL_TICK_MS;
+            if (now > m_now) {
+                m_now = now;
+            }
+        }
+        timer->m_expires = (expires_ms + TIMER_WHEEL_TICK_MS - 1) / TIMER_WHEEL_TICK_MS;
+        link(timer);
+        if (!m_ticking && nullptr != m_worker) {
+            m_ticking = true;
+            start = true;
+        }
+    }
+    if (start) {
+        m_worker->exec_in_worker_ctx([this](struct ev_loop* loop) {
+            if (!ev_is_active(&m_watcher)) {
+                ev_timer_start(loop, &m_watcher);
+            }
+        });
+    }
+}
+
+void timer_wheel::remove(wheel_timer* timer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Only touch the links if they belong to this wheel, a concurrent add() might have moved the timer.
+    if (this == timer->m_wheel && nullptr != timer->m_slot) {
+        unlink(timer);
+    }
+}
+
+std::size_t timer_wheel::advance(int64_t now_ms) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return advance_ticks(now_ms / TIMER_WHEEL_TICK_MS);
+}
+
+std::size_t timer_wheel::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+
+void timer_wheel::tick(struct ev_loop* loop) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t expired = advance_ticks(now_ms() / TIMER_WHEEL_TICK_MS);
+    if (expired) {
+        tdbg("timer_wheel(" << this << "): " << expired << " timers expired" << std::endl);
+    }
+    if (0 == m_size) {
+        // Stop ticking until the next timer gets armed.
+        m_ticking = false;
+        ev_timer_stop(loop, &m_watcher);
+    }
+}
+
+void timer_wheel::link(wheel_timer* timer) {
+    if (timer->m_expires < m_now) {
+        timer->m_expires = m_now;
+    }
+    uint64_t delta = timer->m_expires - m_now;
+    std::size_t level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (uint64_t(1) << (TIMER_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    uint64_t max_delta = (uint64_t(1) << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1;
+    if (delta > max_delta) {
+        timer->m_expires = m_now + max_delta;
+    }
+    wheel_timer** slot = &m_slots[level][(timer->m_expires >> (TIMER_WHEEL_BITS * level)) & MASK];
+    timer->m_slot = slot;
+    timer->m_prev = nullptr;
+    timer->m_next = *slot;
+    if (nullptr != *slot) {
+        (*slot)->m_prev = timer;
+    }
+    *slot = timer;
+    m_size++;
+}
+
+void timer_wheel::unlink(wheel_timer* timer) {
+    if (nullptr != timer->m_prev) {
+        timer->m_prev->m_next = timer->m_next;
+    } else {
+        *timer->m_slot = timer->m_next;
+    }
+    if (nullptr != timer->m_next) {
+        timer->m_next->m_prev = timer->m_prev;
+    }
+    timer->m_slot = nullptr;
+    timer->m_prev = nullptr;
+    timer->m_next = nullptr;
+    m_size--;
+}
+
+void timer_wheel::cascade(std::size_t level, std::size_t idx) {
+    wheel_timer* t = m_slots[level][idx];
+    m_slots[level][idx] = nullptr;
+    while (nullptr != t) {
+        wheel_timer* next = t->m_next;
+        m_size--;
+        link(t);
+        t = next;
+    }
+}
+
+std::size_t timer_wheel::advance_ticks(uint64_t target) {
+    std::size_t expired = 0;
+    while (m_now <= target) {
+        if (0 == m_size) {
+            m_now = target + 1;
+            break;
+        }
+        std::size_t idx = m_now & MASK;
+        if (0 == idx) {
+            // Level 0 wrapped, pull the timers of the next slots of the upper levels down.
+            for (std::size_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+                std::size_t upper_idx = (m_now >> (TIMER_WHEEL_BITS * level)) & MASK;
+                cascade(level, upper_idx);
+                if (0 != upper_idx) {
+                    break;
+                }
+            }
+        }
+        wheel_timer* t = m_slots[0][idx];
+        while (nullptr != t) {
+            wheel_timer* next = t->m_next;
+            unlink(t);
+            t->m_func();
+            expired++;
+            t = next;
+        }
+        m_now++;
+    }
+    return expired;
+}
+
+void timer_wheel_callback(struct ev_loop* loop, ev_timer* w, int /* e */) {
+    timer_wheel* wheel = (timer_wheel*)w->data;
+    wheel->tick(loop);
+}
+
+}  // tasks
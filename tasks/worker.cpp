@@ -10,13 +10,16 @@
 
 namespace tasks {
 
+std::atomic<uint32_t> worker::m_handler_budget(HANDLER_TIME_BUDGET);
+
 #ifndef __clang__
 thread_local worker* worker::m_worker_ptr = nullptr;
 #else
 __thread worker* worker::m_worker_ptr = nullptr;
 #endif
 
-worker::worker(uint8_t id, std::unique_ptr<loop_t>& loop) : m_id(id), m_term(false), m_leader(false) {
+worker::worker(uint8_t id, std::unique_ptr<loop_t>& loop)
+    : m_id(id), m_term(false), m_leader(false), m_timer_wheel(this) {
     // Initialize and add the threads async watcher
     ev_async_init(&m_signal_watcher, tasks_async_callback);
     m_signal_watcher.data = new task_func_queue_t;
@@ -29,7 +32,7 @@ worker::worker(uint8_t id, std::unique_ptr<loop_t>& loop) : m_id(id), m_term(fal
         ev_set_userdata(m_loop->ptr, this);
         loop_raw = m_loop->ptr;
     } else {
-        loop_raw = ev_default_loop(0);
+        loop_raw = ev_default_loop(dispatcher::backend());
     }
     ev_async_start(loop_raw, &m_signal_watcher);
     m_thread.reset(new std::thread(&worker::run, this));
@@ -60,21 +63,16 @@ void worker::run() {
         // Became leader, so execute the event loop
         while (m_leader && !m_term) {
             tdbg(get_string() << ": running event loop" << std::endl);
-            ev_loop(m_loop->ptr, EVLOOP_ONESHOT);
+            // Do not block if work is left from the last batch, it gets handled with the events that are pending now.
+            ev_loop(m_loop->ptr, m_events_queue.empty() ? EVLOOP_ONESHOT : EVLOOP_NONBLOCK);
             tdbg(get_string() << ": event loop returned" << std::endl);
-            // Check if events got fired
+            // Check if events got fired or functors have been deferred
             if (!m_events_queue.empty()) {
                 tdbg(get_string() << ": executing events" << std::endl);
                 // Now promote the next leader and call the event
                 // handlers
                 promote_leader();
-                // Handle events
-                while (!m_events_queue.empty()) {
-                    m_events_count++;
-                    event event = m_events_queue.front();
-                    exec_event_handler(event);
-                    m_events_queue.pop();
-                }
+                handle_events();
             }
         }
 
@@ -90,8 +88,54 @@ void worker::run() {
     }
 }
 
+void worker::handle_events() {
+    do {
+        // Events and functors that get queued by this batch, like the ones of yielding handlers, are handled in the next
+        // one.
+        std::size_t batch = m_events_queue.size();
+        m_batch_over_budget = false;
+        while (batch-- > 0 && !m_batch_over_budget) {
+            event event = m_events_queue.pop();
+            if (nullptr == event.task) {
+                event.func(this);
+            } else {
+                m_events_count++;
+                exec_event_handler(event);
+            }
+        }
+        // A follower has no loop to poll for new events, so it handles the rest right away. The leader polls its loop
+        // first.
+    } while (!m_leader && !m_term && !m_events_queue.empty());
+}
+
 void worker::exec_event_handler(event& event) {
+    // Handlers can be nested, e.g. by timer_task::start_watcher.
+    auto outer_start = m_handler_start;
+    event_task* outer_yielded = m_yielded;
+    m_handler_start = std::chrono::steady_clock::now();
+    m_yielded = nullptr;
     bool cont = event.task->handle_event(this, event.revents);
+    uint32_t budget = m_handler_budget;
+    if (budget > 0) {
+        auto t = std::chrono::steady_clock::now() - m_handler_start;
+        int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(t).count();
+        if (micros > (int64_t)budget) {
+            m_over_budget_count++;
+            // The rest of the batch waits until the loop has been polled, so new events of higher priorities, like
+            // health checks, get ahead of it.
+            m_batch_over_budget = true;
+            tdbg(get_string() << ": handler of " << event.task << " took " << micros << " micros, budget is "
+                              << budget << std::endl);
+        }
+    }
+    bool yielded = event.task == m_yielded;
+    m_handler_start = outer_start;
+    m_yielded = outer_yielded;
+    if (yielded) {
+        // Call the handler again after the events that are pending now. The watcher stays stopped until then.
+        m_events_queue.push(event);
+        return;
+    }
     // Trigger the error callbacks if needed.
     if (event.task->error()) {
         event.task->notify_error(this);
@@ -25,6 +25,29 @@
 #include "test_bitset.h"
 #include "test_exec.h"
 #include "test_timer_task.h"
+#include "test_worker.h"
+#include "test_uwsgi_request.h"
+#include "test_http_parser.h"
+#include "test_http_server_request.h"
+#include "test_http_response.h"
+#include "test_thrift_server.h"
+#include "test_uwsgi_thrift_async_bundle.h"
+#include "test_thrift_client_connection.h"
+#include "test_fanout.h"
+#include "test_backend_group.h"
+#include "test_http_singleflight.h"
+#include "test_response_cache.h"
+#include "test_timer_wheel.h"
+#include "test_disposable.h"
+#include "test_disk_io.h"
+#include "test_disk_io_uring.h"
+#include "test_future.h"
+#include "test_coro.h"
+#include "test_parallel.h"
+#include "test_ready_queue.h"
+#include "test_uwsgi_task.h"
+#include "test_http_server_task.h"
+#include "test_thrift_protocol.h"
 
 #include <tasks/dispatcher.h>
 #include <tasks/executor.h>
@@ -41,6 +64,33 @@ CPPUNIT_TEST_SUITE_REGISTRATION(test_uwsgi_thrift_async);
 CPPUNIT_TEST_SUITE_REGISTRATION(test_bitset);
 CPPUNIT_TEST_SUITE_REGISTRATION(test_exec);
 CPPUNIT_TEST_SUITE_REGISTRATION(test_timer_task);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_worker);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_uwsgi_request);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_http_parser);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_http_server_request);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_http_response);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_thrift_server);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_uwsgi_thrift_async_bundle);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_thrift_client_connection);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_fanout);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_backend_group);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_http_singleflight);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_response_cache);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_timer_wheel);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_disposable);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_disk_io);
+#ifdef _WITH_IO_URING
+CPPUNIT_TEST_SUITE_REGISTRATION(test_disk_io_uring);
+#endif
+CPPUNIT_TEST_SUITE_REGISTRATION(test_future);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_parallel);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_ready_queue);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_uwsgi_task);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_http_server_task);
+CPPUNIT_TEST_SUITE_REGISTRATION(test_thrift_protocol);
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+CPPUNIT_TEST_SUITE_REGISTRATION(test_coro);
+#endif
 
 int main(int argc, char** argv) {
     if (argc > 1 && std::string(argv[1]) == "multi") {
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <tasks/net/backend_group.h>
+
+#include "test_backend_group.h"
+
+using namespace tasks::net;
+
+namespace {
+
+std::vector<backend_group::endpoint> endpoints() {
+    return {backend_group::endpoint("localhost", 1), backend_group::endpoint("localhost", 2)};
+}
+
+/// Acquire until the given endpoint gets picked.
+std::size_t acquire(backend_group& g, std::size_t idx) {
+    while (true) {
+        std::size_t i = g.acquire();
+        if (i == idx) {
+            return i;
+        }
+        g.cancel(i);
+    }
+}
+
+}  // namespace
+
+void test_backend_group::in_flight() {
+    backend_group g(endpoints());
+    // With two endpoints both are compared for every pick, so the requests are spread evenly.
+    for (int i = 0; i < 10; i++) {
+        g.acquire();
+    }
+    CPPUNIT_ASSERT_EQUAL(5u, g.in_flight(0));
+    CPPUNIT_ASSERT_EQUAL(5u, g.in_flight(1));
+    g.release(0, 0.01, true);
+    g.cancel(1);
+    CPPUNIT_ASSERT_EQUAL(4u, g.in_flight(0));
+    CPPUNIT_ASSERT_EQUAL(4u, g.in_flight(1));
+}
+
+void test_backend_group::latency() {
+    backend_group g(endpoints());
+    g.set_ewma_weight(0.5);
+    std::size_t idx = g.acquire();
+    g.release(idx, 0.1, true);
+    std::size_t other = g.acquire();
+    CPPUNIT_ASSERT(idx != other);
+    g.release(other, 0.01, true);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.1, g.latency(idx), 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01, g.latency(other), 1e-9);
+    // The first sample sets the EWMA, later samples are weighted.
+    idx = g.acquire();
+    CPPUNIT_ASSERT(idx == other);
+    g.release(idx, 0.03, true);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.02, g.latency(idx), 1e-9);
+    // The faster endpoint wins as long as its load is lower.
+    for (int i = 0; i < 4; i++) {
+        CPPUNIT_ASSERT(other == g.acquire());
+    }
+    // 0.02 * 5 > 0.1 * 1
+    CPPUNIT_ASSERT(other != g.acquire());
+}
+
+void test_backend_group::ejection() {
+    backend_group g(endpoints());
+    g.set_ejection(3, 10.);
+    // Errors are only counted in a row.
+    g.release(acquire(g, 0), 0., false);
+    g.release(acquire(g, 0), 0., false);
+    g.release(acquire(g, 0), 0., true);
+    g.release(acquire(g, 0), 0., false);
+    g.release(acquire(g, 0), 0., false);
+    CPPUNIT_ASSERT(!g.ejected(0));
+    g.release(acquire(g, 0), 0., false);
+    CPPUNIT_ASSERT(g.ejected(0));
+    CPPUNIT_ASSERT(!g.ejected(1));
+    for (int i = 0; i < 10; i++) {
+        std::size_t idx = g.acquire();
+        CPPUNIT_ASSERT_EQUAL(std::size_t(1), idx);
+        g.cancel(idx);
+    }
+    // If all endpoints are ejected, they are used anyway.
+    for (int i = 0; i < 3; i++) {
+        g.release(acquire(g, 1), 0., false);
+    }
+    CPPUNIT_ASSERT(g.ejected(1));
+    std::size_t idx = g.acquire();
+    CPPUNIT_ASSERT(idx < 2);
+    CPPUNIT_ASSERT_EQUAL(1u, g.in_flight(0) + g.in_flight(1));
+}
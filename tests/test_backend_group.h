@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class test_backend_group : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_backend_group);
+    CPPUNIT_TEST(in_flight);
+    CPPUNIT_TEST(latency);
+    CPPUNIT_TEST(ejection);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void in_flight();
+    void latency();
+    void ejection();
+};
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+
+#include <tasks/coro.h>
+#include <tasks/dispatcher.h>
+
+#include "test_coro.h"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+using namespace tasks;
+
+namespace {
+
+future<int> add(future<int> a, future<int> b) {
+    int x = co_await a;
+    int y = co_await b;
+    co_return x + y;
+}
+
+future<std::string> describe(future<int> a, future<int> b) {
+    int sum = co_await add(a, b);
+    co_return std::to_string(sum);
+}
+
+future<int> fail(future<void> f) {
+    co_await f;
+    throw tasks_exception(tasks_error::SOCKET_READ, "read failed");
+}
+
+/// Echoes blocks of four bytes.
+class echo_task : public coro_io_task {
+  public:
+    echo_task(net::socket& s) : coro_io_task(s, EV_READ) {}
+
+    future<void> run() {
+        char buf[4];
+        while (true) {
+            co_await read_exact(buf, sizeof(buf));
+            co_await write_all(buf, sizeof(buf));
+        }
+    }
+};
+
+/// Echoes a byte after a delay.
+class delay_task : public coro_io_task {
+  public:
+    delay_task(net::socket& s) : coro_io_task(s, EV_READ) {}
+
+    future<void> run() {
+        char c;
+        co_await read_exact(&c, 1);
+        co_await tasks::delay(0.2);
+        co_await write_all(&c, 1);
+    }
+};
+
+/// Writes the result of an offloaded function and whether the coroutine was resumed in the task's handler.
+class offload_task : public coro_io_task {
+  public:
+    offload_task(net::socket& s) : coro_io_task(s, EV_READ) {}
+
+    future<void> run() {
+        char c;
+        co_await read_exact(&c, 1);
+        std::string s = co_await tasks::offload([c] { return std::string(3, c); });
+        s += this == coro_io_task::current() ? "+" : "-";
+        co_await write_all(s.data(), s.size());
+    }
+};
+
+}  // namespace
+
+void test_coro::await() {
+    // Outside of a worker a coroutine is resumed in the thread that sets the value.
+    promise<int> a, b;
+    future<int> sum = add(a.get_future(), b.get_future());
+    CPPUNIT_ASSERT(!sum.ready());
+    a.set_value(1);
+    CPPUNIT_ASSERT(!sum.ready());
+    b.set_value(2);
+    CPPUNIT_ASSERT_EQUAL(3, sum.get());
+
+    // Ready futures do not suspend.
+    CPPUNIT_ASSERT_EQUAL(5, add(make_ready_future(2), make_ready_future(3)).get());
+}
+
+void test_coro::error() {
+    promise<void> p;
+    future<int> f = fail(p.get_future());
+    p.set_value();
+    CPPUNIT_ASSERT(f.failed());
+    CPPUNIT_ASSERT(tasks_error::SOCKET_READ == f.error().error_code());
+
+    // Errors of awaited futures are thrown.
+    promise<int> a;
+    future<int> sum = add(a.get_future(), make_ready_future(1));
+    a.set_exception(tasks_exception(tasks_error::FANOUT_DEADLINE, "late"));
+    CPPUNIT_ASSERT(sum.failed());
+    CPPUNIT_ASSERT(tasks_error::FANOUT_DEADLINE == sum.error().error_code());
+}
+
+void test_coro::nested() {
+    promise<int> a, b;
+    future<std::string> s = describe(a.get_future(), b.get_future());
+    b.set_value(20);
+    a.set_value(22);
+    CPPUNIT_ASSERT_EQUAL(std::string("42"), s.get());
+}
+
+void test_coro::frame_pool() {
+    add(make_ready_future(1), make_ready_future(1));
+    // The frame went back to the pool of this thread and gets reused.
+    std::size_t frames = coro_frame_pool::free_frames();
+    CPPUNIT_ASSERT(frames > 0);
+    add(make_ready_future(1), make_ready_future(1));
+    CPPUNIT_ASSERT_EQUAL(frames, coro_frame_pool::free_frames());
+
+    void* p = coro_frame_pool::allocate(100);
+    coro_frame_pool::deallocate(p, 100);
+    CPPUNIT_ASSERT(p == coro_frame_pool::allocate(128));
+    coro_frame_pool::deallocate(p, 128);
+}
+
+template <class task_type>
+int test_coro::start_task() {
+    int fds[2];
+    CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    CPPUNIT_ASSERT(0 == fcntl(fds[1], F_SETFL, O_NONBLOCK));
+    net::socket sock(fds[1]);
+    dispatcher::instance()->add_task(new task_type(sock));
+    return fds[0];
+}
+
+std::string test_coro::read(int fd, std::size_t len) {
+    std::string data;
+    char buf[64];
+    while (data.size() < len) {
+        pollfd pfd = {fd, POLLIN, 0};
+        CPPUNIT_ASSERT(1 == poll(&pfd, 1, 2000));
+        ssize_t bytes = ::read(fd, buf, std::min(sizeof(buf), len - data.size()));
+        CPPUNIT_ASSERT(bytes > 0);
+        data.append(buf, bytes);
+    }
+    return data;
+}
+
+void test_coro::echo() {
+    int fd = start_task<echo_task>();
+    // A block that arrives in pieces is read completely before it is echoed.
+    CPPUNIT_ASSERT(2 == ::write(fd, "ab", 2));
+    usleep(50000);
+    CPPUNIT_ASSERT(6 == ::write(fd, "cdefgh", 6));
+    CPPUNIT_ASSERT_EQUAL(std::string("abcdefgh"), read(fd, 8));
+    CPPUNIT_ASSERT(4 == ::write(fd, "ijkl", 4));
+    CPPUNIT_ASSERT_EQUAL(std::string("ijkl"), read(fd, 4));
+    ::close(fd);
+}
+
+void test_coro::delay() {
+    int fd = start_task<delay_task>();
+    auto start = std::chrono::steady_clock::now();
+    CPPUNIT_ASSERT(1 == ::write(fd, "x", 1));
+    CPPUNIT_ASSERT_EQUAL(std::string("x"), read(fd, 1));
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    CPPUNIT_ASSERT_MESSAGE("ms=" + std::to_string(ms), ms >= 190);
+    // The task has finished and closed its end.
+    pollfd pfd = {fd, POLLIN, 0};
+    CPPUNIT_ASSERT(1 == poll(&pfd, 1, 2000));
+    char c;
+    CPPUNIT_ASSERT(0 == ::read(fd, &c, 1));
+    ::close(fd);
+}
+
+void test_coro::offload() {
+    int fd = start_task<offload_task>();
+    CPPUNIT_ASSERT(1 == ::write(fd, "o", 1));
+    CPPUNIT_ASSERT_EQUAL(std::string("ooo+"), read(fd, 4));
+    ::close(fd);
+}
+
+#endif  // __cpp_impl_coroutine
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class test_coro : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_coro);
+    CPPUNIT_TEST(await);
+    CPPUNIT_TEST(error);
+    CPPUNIT_TEST(nested);
+    CPPUNIT_TEST(frame_pool);
+    CPPUNIT_TEST(echo);
+    CPPUNIT_TEST(delay);
+    CPPUNIT_TEST(offload);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void await();
+    void error();
+    void nested();
+    void frame_pool();
+    void echo();
+    void delay();
+    void offload();
+
+   private:
+    /// Start a coro_io_task on one end of a socket pair.
+    ///
+    /// \return The other end of the socket pair.
+    template <class task_type>
+    int start_task();
+
+    /// Read len bytes with a timeout of two seconds.
+    std::string read(int fd, std::size_t len);
+};
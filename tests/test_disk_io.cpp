@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <future>
+#include <string>
+
+#include <tasks/disk_io.h>
+
+#include "test_disk_io.h"
+
+using namespace tasks;
+
+namespace {
+
+struct result {
+    std::streamsize bytes;
+    tasks_error error;
+};
+
+/// Wait for the completion of an operation.
+class completion {
+  public:
+    disk_io::complete_func_t func() {
+        return [this](std::streamsize bytes, const tasks_exception& e) {
+            m_promise.set_value(result{bytes, e.error_code()});
+        };
+    }
+
+    result get() { return m_promise.get_future().get(); }
+
+  private:
+    std::promise<result> m_promise;
+};
+
+}
+
+void test_disk_io::positional() {
+    std::string fname = "/tmp/disk_io_positional";
+    int fd = open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    CPPUNIT_ASSERT(fd > -1);
+
+    // Writes at offsets can complete in any order.
+    completion w1, w2, s;
+    disk_io::instance()->pwrite(fd, "world", 5, 6, w2.func());
+    disk_io::instance()->pwrite(fd, "hello ", 6, 0, w1.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(5), w2.get().bytes);
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(6), w1.get().bytes);
+    disk_io::instance()->fdatasync(fd, s.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(0), s.get().bytes);
+
+    char buf[16] = {0};
+    completion r1, r2;
+    disk_io::instance()->pread(fd, buf, 5, 6, r1.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(5), r1.get().bytes);
+    CPPUNIT_ASSERT_EQUAL(std::string("world"), std::string(buf, 5));
+    // Short read at the end of the file
+    disk_io::instance()->pread(fd, buf, sizeof(buf), 0, r2.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(11), r2.get().bytes);
+    CPPUNIT_ASSERT_EQUAL(std::string("hello world"), std::string(buf, 11));
+
+    close(fd);
+    unlink(fname.c_str());
+}
+
+void test_disk_io::vectored() {
+    std::string fname = "/tmp/disk_io_vectored";
+    int fd = open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    CPPUNIT_ASSERT(fd > -1);
+
+    std::string header = "header:", body = "body\n";
+    completion w, s;
+    disk_io::instance()->pwritev(fd, {{(void*)header.data(), header.size()}, {(void*)body.data(), body.size()}}, 0,
+                                 w.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(12), w.get().bytes);
+    disk_io::instance()->fsync(fd, s.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(0), s.get().bytes);
+
+    char b1[7], b2[5];
+    completion r;
+    disk_io::instance()->preadv(fd, {{b1, sizeof(b1)}, {b2, sizeof(b2)}}, 0, r.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(12), r.get().bytes);
+    CPPUNIT_ASSERT_EQUAL(header, std::string(b1, sizeof(b1)));
+    CPPUNIT_ASSERT_EQUAL(body, std::string(b2, sizeof(b2)));
+
+    close(fd);
+    unlink(fname.c_str());
+}
+
+void test_disk_io::error() {
+    char buf[16];
+    completion r;
+    disk_io::instance()->pread(-1, buf, sizeof(buf), 0, r.func());
+    result res = r.get();
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(-1), res.bytes);
+    CPPUNIT_ASSERT(tasks_error::DISKIO_ERROR == res.error);
+}
+
+void test_disk_io::futures() {
+    std::string fname = "/tmp/disk_io_futures";
+    int fd = open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    CPPUNIT_ASSERT(fd > -1);
+
+    char buf[16] = {0};
+    std::promise<std::string> done;
+    disk_io::instance()
+        ->pwrite(fd, "chained", 7, 0)
+        .then([fd, &buf](tasks::future<std::streamsize> bytes) {
+            return disk_io::instance()->pread(fd, buf, bytes.get(), 0);
+        })
+        .then([&buf, &done](tasks::future<std::streamsize> bytes) {
+            done.set_value(std::string(buf, bytes.get()));
+        });
+    CPPUNIT_ASSERT_EQUAL(std::string("chained"), done.get_future().get());
+
+    std::promise<tasks_error> failed;
+    disk_io::instance()->fsync(-1).then([&failed](tasks::future<std::streamsize> r) {
+        failed.set_value(r.error().error_code());
+    });
+    CPPUNIT_ASSERT(tasks_error::DISKIO_ERROR == failed.get_future().get());
+
+    close(fd);
+    unlink(fname.c_str());
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class test_disk_io : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_disk_io);
+    CPPUNIT_TEST(positional);
+    CPPUNIT_TEST(vectored);
+    CPPUNIT_TEST(error);
+    CPPUNIT_TEST(futures);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void positional();
+    void vectored();
+    void error();
+    void futures();
+};
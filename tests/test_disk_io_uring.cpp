@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifdef _WITH_IO_URING
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <future>
+#include <string>
+
+#include <tasks/disk_io.h>
+#include <tasks/disk_io_uring.h>
+
+#include "test_disk_io_uring.h"
+
+using namespace tasks;
+
+namespace {
+
+struct result {
+    std::streamsize bytes;
+    tasks_error error;
+    int err;
+};
+
+/// Wait for the completion of an operation.
+class completion {
+  public:
+    disk_io::complete_func_t func() {
+        return [this](std::streamsize bytes, const tasks_exception& e) {
+            m_promise.set_value(result{bytes, e.error_code(), e.sys_errno()});
+        };
+    }
+
+    result get() { return m_promise.get_future().get(); }
+
+  private:
+    std::promise<result> m_promise;
+};
+
+}
+
+bool test_disk_io_uring::supported() {
+    try {
+        disk_io_uring ring(4);
+        return true;
+    } catch (tasks_exception& e) {
+        return false;
+    }
+}
+
+void test_disk_io_uring::read_write() {
+    if (!supported()) {
+        return;
+    }
+    // Without I/O threads every operation has to go through the ring.
+    disk_io io(0);
+    std::string fname = "/tmp/disk_io_uring_read_write";
+    int fd = open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    CPPUNIT_ASSERT(fd > -1);
+
+    completion w1, w2, s;
+    io.pwrite(fd, "world", 5, 6, w2.func());
+    io.pwrite(fd, "hello ", 6, 0, w1.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(5), w2.get().bytes);
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(6), w1.get().bytes);
+    io.fsync(fd, s.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(0), s.get().bytes);
+
+    char buf[16] = {0};
+    completion r1, r2;
+    io.pread(fd, buf, 5, 6, r1.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(5), r1.get().bytes);
+    CPPUNIT_ASSERT_EQUAL(std::string("world"), std::string(buf, 5));
+    // Short read at the end of the file
+    io.pread(fd, buf, sizeof(buf), 0, r2.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(11), r2.get().bytes);
+    CPPUNIT_ASSERT_EQUAL(std::string("hello world"), std::string(buf, 11));
+
+    close(fd);
+    unlink(fname.c_str());
+}
+
+void test_disk_io_uring::vectored() {
+    if (!supported()) {
+        return;
+    }
+    disk_io io(0);
+    std::string fname = "/tmp/disk_io_uring_vectored";
+    int fd = open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    CPPUNIT_ASSERT(fd > -1);
+
+    std::string header = "header:", body = "body\n";
+    completion w;
+    io.pwritev(fd, {{(void*)header.data(), header.size()}, {(void*)body.data(), body.size()}}, 0, w.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(12), w.get().bytes);
+
+    char h[7], b[5];
+    completion r;
+    io.preadv(fd, {{h, sizeof(h)}, {b, sizeof(b)}}, 0, r.func());
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(12), r.get().bytes);
+    CPPUNIT_ASSERT_EQUAL(header, std::string(h, sizeof(h)));
+    CPPUNIT_ASSERT_EQUAL(body, std::string(b, sizeof(b)));
+
+    close(fd);
+    unlink(fname.c_str());
+}
+
+void test_disk_io_uring::error() {
+    if (!supported()) {
+        return;
+    }
+    disk_io io(0);
+    // The kernel reports the error with the completion.
+    char buf[4];
+    completion r;
+    io.pread(-1, buf, sizeof(buf), 0, r.func());
+    result res = r.get();
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(-1), res.bytes);
+    CPPUNIT_ASSERT(tasks_error::DISKIO_ERROR == res.error);
+    CPPUNIT_ASSERT_EQUAL(EBADF, res.err);
+
+    int fd = open("/dev/null", O_RDONLY);
+    CPPUNIT_ASSERT(fd > -1);
+    completion w;
+    io.pwrite(fd, "data", 4, 0, w.func());
+    res = w.get();
+    CPPUNIT_ASSERT_EQUAL(std::streamsize(-1), res.bytes);
+    CPPUNIT_ASSERT_EQUAL(EBADF, res.err);
+    close(fd);
+}
+
+#endif  // _WITH_IO_URING
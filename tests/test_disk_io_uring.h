@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#ifdef _WITH_IO_URING
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class test_disk_io_uring : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_disk_io_uring);
+    CPPUNIT_TEST(read_write);
+    CPPUNIT_TEST(vectored);
+    CPPUNIT_TEST(error);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void read_write();
+    void vectored();
+    void error();
+
+   private:
+    /// \return True if the kernel supports io_uring.
+    bool supported();
+};
+
+#endif  // _WITH_IO_URING
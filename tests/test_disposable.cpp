@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <tasks/disposable.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "test_disposable.h"
+
+using namespace std;
+
+namespace tasks {
+
+class dispose_test : public disposable {
+  public:
+    void dispose(worker* w) {
+        disposed++;
+        worker = w;
+    }
+
+    atomic<int> disposed{0};
+    tasks::worker* worker = nullptr;
+};
+
+void test_disposable::immediate() {
+    dispose_test d;
+    CPPUNIT_ASSERT(d.can_dispose());
+    CPPUNIT_ASSERT(d.request_dispose(nullptr));
+    CPPUNIT_ASSERT_EQUAL(0, d.disposed.load());
+}
+
+void test_disposable::deferred() {
+    dispose_test d;
+    worker* w = reinterpret_cast<worker*>(&d);
+    d.disable_dispose();
+    d.disable_dispose();
+    CPPUNIT_ASSERT(!d.can_dispose());
+    CPPUNIT_ASSERT(!d.request_dispose(w));
+    d.enable_dispose();
+    CPPUNIT_ASSERT_EQUAL(0, d.disposed.load());
+    // The last reference disposes the task on the worker that removed it.
+    d.enable_dispose();
+    CPPUNIT_ASSERT_EQUAL(1, d.disposed.load());
+    CPPUNIT_ASSERT(w == d.worker);
+}
+
+void test_disposable::threads() {
+    for (int i = 0; i < 100; i++) {
+        dispose_test d;
+        for (int j = 0; j < 4; j++) {
+            d.disable_dispose();
+        }
+        vector<thread> threads;
+        for (int j = 0; j < 4; j++) {
+            threads.emplace_back([&d] { d.enable_dispose(); });
+        }
+        bool now = d.request_dispose(nullptr);
+        for (auto& t : threads) {
+            t.join();
+        }
+        // Either the remover or the last releaser disposes the task, never both.
+        CPPUNIT_ASSERT_EQUAL(1, d.disposed.load() + (now ? 1 : 0));
+    }
+}
+
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace tasks {
+
+class test_disposable : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_disposable);
+    CPPUNIT_TEST(immediate);
+    CPPUNIT_TEST(deferred);
+    CPPUNIT_TEST(threads);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void immediate();
+    void deferred();
+    void threads();
+};
+
+}
@@ -11,7 +11,10 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <future>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "test_exec.h"
 
@@ -90,6 +93,36 @@ void test_exec::run() {
     */
 }
 
+void test_exec::futures() {
+    // Outside of a worker the future is set in the executor thread.
+    std::promise<std::string> done;
+    exec<int>([] { return 20; }).then([](future<int> v) { return v.get() + 22; }).then([&done](future<int> v) {
+        done.set_value(std::to_string(v.get()));
+    });
+    CPPUNIT_ASSERT_EQUAL(std::string("42"), done.get_future().get());
+
+    std::promise<tasks_error> failed;
+    exec<void>([] { throw tasks_exception(tasks_error::SOCKET_CONNECT, "connect failed"); })
+        .then([&failed](future<void> f) { failed.set_value(f.error().error_code()); });
+    CPPUNIT_ASSERT(tasks_error::SOCKET_CONNECT == failed.get_future().get());
+}
+
+void test_exec::batch() {
+    std::vector<std::function<int()>> fs;
+    for (int i = 0; i < 10; i++) {
+        fs.push_back([i] { return i; });
+    }
+    std::promise<int> sum;
+    when_all(exec_batch<int>(fs)).then([&sum](future<std::vector<future<int>>> all) {
+        int s = 0;
+        for (auto& f : all.get()) {
+            s += f.get();
+        }
+        sum.set_value(s);
+    });
+    CPPUNIT_ASSERT_EQUAL(45, sum.get_future().get());
+}
+
 bool test_exec::check_state(std::atomic<int>& state, int expected) {
     std::unique_lock<std::mutex> lock(g_mutex);
     return g_cond.wait_for(lock, std::chrono::seconds(10), [&state, expected] { return state == expected; });
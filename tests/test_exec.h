@@ -14,6 +14,8 @@ namespace tasks {
 class test_exec : public CppUnit::TestFixture {
     CPPUNIT_TEST_SUITE(test_exec);
     CPPUNIT_TEST(run);
+    CPPUNIT_TEST(futures);
+    CPPUNIT_TEST(batch);
     CPPUNIT_TEST_SUITE_END();
 
    public:
@@ -22,6 +24,8 @@ class test_exec : public CppUnit::TestFixture {
 
    protected:
     void run();
+    void futures();
+    void batch();
 
     bool check_state(std::atomic<int>& state, int expected);
 };
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <tasks/dispatcher.h>
+#include <tasks/net/fanout.h>
+
+#include "test_fanout.h"
+
+using namespace tasks;
+using namespace tasks::net;
+
+using int_fanout = fanout<int>;
+
+namespace {
+
+/// Wait until the flag is set or a timeout of two seconds has passed.
+bool wait_for(std::atomic<bool>& flag) {
+    for (int i = 0; i < 200 && !flag; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return flag;
+}
+
+}  // namespace
+
+void test_fanout::all() {
+    int_fanout f(3, [](std::size_t idx, bool, int_fanout::reply_func_t reply) {
+        int v = static_cast<int>(idx) * 2;
+        reply(v, tasks_exception());
+        return int_fanout::cancel_func_t();
+    });
+    std::atomic<bool> done(false);
+    int_fanout::results_t results;
+    f.start([&](int_fanout::results_t& r) {
+        results = r;
+        done = true;
+    });
+    CPPUNIT_ASSERT(wait_for(done));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), results.size());
+    for (std::size_t i = 0; i < results.size(); i++) {
+        CPPUNIT_ASSERT(tasks_error::UNSET == results[i].error.error_code());
+        CPPUNIT_ASSERT_EQUAL(static_cast<int>(i) * 2, results[i].value);
+        CPPUNIT_ASSERT(!results[i].hedged);
+    }
+}
+
+void test_fanout::deadline() {
+    // The second request never answers on its own.
+    int_fanout::reply_func_t late;
+    std::atomic<bool> cancelled(false);
+    int_fanout f(2, [&](std::size_t idx, bool, int_fanout::reply_func_t reply) {
+        if (0 == idx) {
+            int v = 1;
+            reply(v, tasks_exception());
+            return int_fanout::cancel_func_t();
+        }
+        late = reply;
+        return int_fanout::cancel_func_t([&cancelled] { cancelled = true; });
+    });
+    f.set_deadline(0.2);
+    std::atomic<bool> done(false);
+    int_fanout::results_t results;
+    auto start = std::chrono::steady_clock::now();
+    f.start([&](int_fanout::results_t& r) {
+        results = r;
+        done = true;
+    });
+    CPPUNIT_ASSERT(wait_for(done));
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    CPPUNIT_ASSERT_MESSAGE("ms=" + std::to_string(ms), ms >= 190);
+    CPPUNIT_ASSERT(cancelled);
+    CPPUNIT_ASSERT(tasks_error::UNSET == results[0].error.error_code());
+    CPPUNIT_ASSERT_EQUAL(1, results[0].value);
+    CPPUNIT_ASSERT(tasks_error::FANOUT_DEADLINE == results[1].error.error_code());
+
+    // A late reply is ignored.
+    done = false;
+    int v = 2;
+    late(v, tasks_exception());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CPPUNIT_ASSERT(!done);
+}
+
+void test_fanout::hedge() {
+    // The primary requests hang, the hedged requests answer right away.
+    std::vector<int_fanout::reply_func_t> hanging;
+    std::atomic<int> cancelled(0);
+    std::mutex mutex;
+    int_fanout f(2, [&](std::size_t idx, bool hedge, int_fanout::reply_func_t reply) {
+        if (hedge) {
+            int v = static_cast<int>(idx) + 10;
+            reply(v, tasks_exception());
+            return int_fanout::cancel_func_t();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        hanging.push_back(reply);
+        return int_fanout::cancel_func_t([&cancelled] { cancelled++; });
+    });
+    auto policy = std::make_shared<tasks::net::hedge_policy>(0.05);
+    f.set_hedging(policy);
+    f.set_deadline(1.);
+    std::atomic<bool> done(false);
+    int_fanout::results_t results;
+    auto start = std::chrono::steady_clock::now();
+    f.start([&](int_fanout::results_t& r) {
+        results = r;
+        done = true;
+    });
+    CPPUNIT_ASSERT(wait_for(done));
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    CPPUNIT_ASSERT_MESSAGE("ms=" + std::to_string(ms), ms < 900);
+    CPPUNIT_ASSERT_EQUAL(2, cancelled.load());
+    for (std::size_t i = 0; i < results.size(); i++) {
+        CPPUNIT_ASSERT(tasks_error::UNSET == results[i].error.error_code());
+        CPPUNIT_ASSERT_EQUAL(static_cast<int>(i) + 10, results[i].value);
+        CPPUNIT_ASSERT(results[i].hedged);
+    }
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), policy->samples());
+    // Release the state held by the hanging requests.
+    for (auto& reply : hanging) {
+        int v = 0;
+        reply(v, tasks_exception());
+    }
+}
+
+void test_fanout::hedge_policy() {
+    tasks::net::hedge_policy p(0.05);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.05, p.delay(), 1e-9);
+    // Samples of 1ms to 96ms, the p95 is the 91st value.
+    for (int i = 1; i <= 96; i++) {
+        p.record(i / 1000.);
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.091, p.delay(), 1e-9);
+    // The delay never drops below the minimum.
+    tasks::net::hedge_policy fast(0.05, 0.95, 0.002);
+    for (int i = 0; i < 32; i++) {
+        fast.record(0.0001);
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.002, fast.delay(), 1e-9);
+}
+
+void test_fanout::timers() {
+    // A fan-out that completes early cancels its timers. It is started in a worker, so the timers use its wheel.
+    std::atomic<bool> started(false);
+    std::atomic<bool> done(false);
+    std::atomic<std::size_t> before(0);
+    std::atomic<std::size_t> armed(0);
+    std::atomic<worker*> w(nullptr);
+    // The replies are sent after the worker has counted the armed timers.
+    std::vector<int_fanout::reply_func_t> replies;
+    std::mutex mutex;
+    dispatcher::instance()->last_worker()->exec_in_worker_ctx([&](struct ev_loop* /* loop */) {
+        w = worker::get();
+        before = w.load()->wheel().size();
+        int_fanout f(2, [&](std::size_t, bool, int_fanout::reply_func_t reply) {
+            std::lock_guard<std::mutex> lock(mutex);
+            replies.push_back(reply);
+            return int_fanout::cancel_func_t();
+        });
+        f.set_hedging(std::make_shared<tasks::net::hedge_policy>(10.));
+        f.set_deadline(10.);
+        f.start([&](int_fanout::results_t&) { done = true; });
+        armed = w.load()->wheel().size();
+        started = true;
+    });
+    CPPUNIT_ASSERT(wait_for(started));
+    CPPUNIT_ASSERT_EQUAL(before + 2, armed.load());
+    for (auto& reply : replies) {
+        int v = 1;
+        reply(v, tasks_exception());
+    }
+    CPPUNIT_ASSERT(wait_for(done));
+    CPPUNIT_ASSERT_EQUAL(before.load(), w.load()->wheel().size());
+}
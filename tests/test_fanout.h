@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class test_fanout : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_fanout);
+    CPPUNIT_TEST(all);
+    CPPUNIT_TEST(deadline);
+    CPPUNIT_TEST(hedge);
+    CPPUNIT_TEST(hedge_policy);
+    CPPUNIT_TEST(timers);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void all();
+    void deadline();
+    void hedge();
+    void hedge_policy();
+    void timers();
+};
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tasks/future.h>
+
+#include "test_future.h"
+
+using namespace tasks;
+
+void test_future::chain() {
+    // Outside of a worker continuations run in the thread that sets the value.
+    promise<int> p;
+    std::string out;
+    future<void> done = p.get_future()
+                            .then([](future<int> v) { return v.get() * 2; })
+                            .then([](future<int> v) { return std::to_string(v.get()); })
+                            .then([&out](future<std::string> s) { out = s.get(); });
+    CPPUNIT_ASSERT(!done.ready());
+    p.set_value(21);
+    CPPUNIT_ASSERT(done.ready());
+    CPPUNIT_ASSERT(!done.failed());
+    CPPUNIT_ASSERT_EQUAL(std::string("42"), out);
+
+    // Continuations of a ready future run right away.
+    int v = 0;
+    make_ready_future(7).then([&v](future<int> f) { v = f.get(); });
+    CPPUNIT_ASSERT_EQUAL(7, v);
+}
+
+void test_future::error() {
+    promise<int> p;
+    bool called = false;
+    future<int> last = p.get_future()
+                           .then([&called](future<int> v) {
+                               called = true;
+                               return v.get() + 1;
+                           })
+                           .then([](future<int> v) { return v.get() + 1; });
+    p.set_exception(tasks_exception(tasks_error::DISKIO_ERROR, "failed"));
+    // The first continuation runs and rethrows, the error reaches the end of the chain.
+    CPPUNIT_ASSERT(called);
+    CPPUNIT_ASSERT(last.failed());
+    CPPUNIT_ASSERT(tasks_error::DISKIO_ERROR == last.error().error_code());
+    CPPUNIT_ASSERT_THROW(last.get(), tasks_exception);
+
+    // A value can be set only once.
+    CPPUNIT_ASSERT_THROW(p.set_value(1), tasks_exception);
+
+    // Exceptions thrown by continuations fail the next future.
+    future<void> f = make_ready_future().then([](future<void>) { throw std::runtime_error("oops"); });
+    CPPUNIT_ASSERT(f.failed());
+    CPPUNIT_ASSERT(tasks_error::FUTURE_EXCEPTION == f.error().error_code());
+    CPPUNIT_ASSERT_EQUAL(std::string("oops"), f.error().message());
+
+    // Errors can be recovered from.
+    future<int> r = make_exceptional_future<int>(tasks_exception(tasks_error::SOCKET_READ, "read"))
+                        .then([](future<int> v) { return v.failed() ? -1 : v.get(); });
+    CPPUNIT_ASSERT_EQUAL(-1, r.get());
+}
+
+void test_future::unwrap() {
+    promise<int> inner;
+    future<std::string> f = make_ready_future(1)
+                                .then([inner](future<int>) { return inner.get_future(); })
+                                .then([](future<int> v) { return std::to_string(v.get()); });
+    CPPUNIT_ASSERT(!f.ready());
+    inner.set_value(5);
+    CPPUNIT_ASSERT_EQUAL(std::string("5"), f.get());
+}
+
+void test_future::broken_promise() {
+    future<int> f;
+    {
+        promise<int> p;
+        promise<int> copy = p;
+        f = p.get_future();
+    }
+    CPPUNIT_ASSERT(f.failed());
+    CPPUNIT_ASSERT(tasks_error::FUTURE_BROKEN_PROMISE == f.error().error_code());
+}
+
+void test_future::all() {
+    std::vector<promise<int>> promises(3);
+    std::vector<future<int>> futures;
+    for (auto& p : promises) {
+        futures.push_back(p.get_future());
+    }
+    int sum = 0;
+    bool failed = false;
+    future<void> done = when_all(futures).then([&](future<std::vector<future<int>>> all) {
+        for (auto& f : all.get()) {
+            if (f.failed()) {
+                failed = true;
+            } else {
+                sum += f.get();
+            }
+        }
+    });
+    promises[2].set_value(3);
+    promises[0].set_value(1);
+    CPPUNIT_ASSERT(!done.ready());
+    promises[1].set_exception(tasks_exception(tasks_error::FANOUT_DEADLINE, "late"));
+    CPPUNIT_ASSERT(done.ready());
+    CPPUNIT_ASSERT_EQUAL(4, sum);
+    CPPUNIT_ASSERT(failed);
+
+    CPPUNIT_ASSERT(when_all(std::vector<future<int>>()).ready());
+}
+
+void test_future::any() {
+    std::vector<promise<int>> promises(3);
+    std::vector<future<int>> futures;
+    for (auto& p : promises) {
+        futures.push_back(p.get_future());
+    }
+    future<std::size_t> first = when_any(futures);
+    CPPUNIT_ASSERT(!first.ready());
+    promises[1].set_value(10);
+    promises[0].set_value(20);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), first.get());
+    CPPUNIT_ASSERT_EQUAL(10, futures[first.get()].get());
+}
+
+void test_future::threads() {
+    const int count = 64;
+    std::vector<promise<int>> promises(count);
+    std::vector<future<int>> futures;
+    for (auto& p : promises) {
+        futures.push_back(p.get_future().then([](future<int> v) { return v.get() + 1; }));
+    }
+    std::promise<int> result;
+    when_all(futures).then([&result](future<std::vector<future<int>>> all) {
+        int sum = 0;
+        for (auto& f : all.get()) {
+            sum += f.get();
+        }
+        result.set_value(sum);
+    });
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&promises, t] {
+            for (int i = t; i < count; i += 4) {
+                promises[i].set_value(i);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    CPPUNIT_ASSERT_EQUAL(count * (count - 1) / 2 + count, result.get_future().get());
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class test_future : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_future);
+    CPPUNIT_TEST(chain);
+    CPPUNIT_TEST(error);
+    CPPUNIT_TEST(unwrap);
+    CPPUNIT_TEST(broken_promise);
+    CPPUNIT_TEST(all);
+    CPPUNIT_TEST(any);
+    CPPUNIT_TEST(threads);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void chain();
+    void error();
+    void unwrap();
+    void broken_promise();
+    void all();
+    void any();
+    void threads();
+};
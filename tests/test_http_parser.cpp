@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <tasks/net/socket.h>
+
+#include "test_http_parser.h"
+
+using namespace tasks;
+using namespace tasks::net;
+
+void test_http_parser::read_response(http_response& response, const std::string& data, std::size_t piece,
+                                     bool close) {
+    int fds[2];
+    CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    tasks::net::socket sock(fds[1]);
+    std::size_t pos = 0;
+    while (pos < data.length() && !response.done()) {
+        std::size_t len = std::min(piece, data.length() - pos);
+        CPPUNIT_ASSERT(static_cast<ssize_t>(len) == ::write(fds[0], data.c_str() + pos, len));
+        pos += len;
+        // read exactly what has been written to not block
+        response.read_data(sock);
+    }
+    if (close) {
+        ::close(fds[0]);
+        fds[0] = -1;
+        response.read_data(sock);
+    }
+    if (fds[0] > -1) {
+        ::close(fds[0]);
+    }
+    ::close(fds[1]);
+}
+
+void test_http_parser::content_length() {
+    std::string data =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/plain\r\n"
+        "content-length: 11\r\n"
+        "\r\n"
+        "hello world";
+    for (std::size_t piece : {1, 7, 1024}) {
+        http_response response;
+        read_response(response, data, piece);
+        CPPUNIT_ASSERT_MESSAGE("piece=" + std::to_string(piece), response.done());
+        CPPUNIT_ASSERT(response.status_code() == 200);
+        CPPUNIT_ASSERT(response.status() == "200 OK");
+        CPPUNIT_ASSERT(response.header("Content-Type") == "text/plain");
+        CPPUNIT_ASSERT(response.content_length() == 11);
+        CPPUNIT_ASSERT(std::string(response.content_p()) == "hello world");
+        CPPUNIT_ASSERT(response.keep_alive());
+    }
+}
+
+void test_http_parser::chunked() {
+    std::string data =
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5\r\nhello\r\n"
+        "1;ext=1\r\n \r\n"
+        "A\r\n0123456789\r\n"
+        "0\r\n"
+        "X-Trailer: 1\r\n"
+        "\r\n";
+    for (std::size_t piece : {1, 3, 1024}) {
+        http_response response;
+        read_response(response, data, piece);
+        CPPUNIT_ASSERT_MESSAGE("piece=" + std::to_string(piece), response.done());
+        CPPUNIT_ASSERT(response.content_length() == 16);
+        CPPUNIT_ASSERT(std::string(response.content_p()) == "hello 0123456789");
+        CPPUNIT_ASSERT(response.header("X-Trailer") == "1");
+    }
+}
+
+void test_http_parser::close_delimited() {
+    std::string data =
+        "HTTP/1.0 200 OK\r\n"
+        "Content-Type: text/plain\r\n"
+        "\r\n"
+        "until close";
+    http_response response;
+    read_response(response, data, 5, true);
+    CPPUNIT_ASSERT(response.done());
+    CPPUNIT_ASSERT(response.content_length() == 11);
+    CPPUNIT_ASSERT(std::string(response.content_p()) == "until close");
+    CPPUNIT_ASSERT(!response.keep_alive());
+
+    // No body for 204
+    http_response response2;
+    read_response(response2, "HTTP/1.1 204 No Content\r\n\r\n", 1024);
+    CPPUNIT_ASSERT(response2.done());
+    CPPUNIT_ASSERT(response2.content_length() == 0);
+}
+
+void test_http_parser::invalid() {
+    tasks_error error = tasks_error::UNSET;
+    try {
+        http_response response;
+        read_response(response, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nxyz\r\n", 1024);
+    } catch (tasks_exception& e) {
+        error = e.error_code();
+    }
+    CPPUNIT_ASSERT(tasks_error::HTTP_INVALID_CHUNK == error);
+
+    error = tasks_error::UNSET;
+    try {
+        http_response response;
+        read_response(response, "HTTP/1.1 200 OK\r\nno colon\r\n\r\n", 1024);
+    } catch (tasks_exception& e) {
+        error = e.error_code();
+    }
+    CPPUNIT_ASSERT(tasks_error::HTTP_INVALID_HEADER == error);
+
+    error = tasks_error::UNSET;
+    try {
+        http_response response;
+        read_response(response, "HTTP/1.1 42 Bad\r\n\r\n", 1024);
+    } catch (tasks_exception& e) {
+        error = e.error_code();
+    }
+    CPPUNIT_ASSERT(tasks_error::HTTP_INVALID_STATUS_CODE == error);
+}
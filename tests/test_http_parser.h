@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include <tasks/net/http_response.h>
+
+class test_http_parser : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_http_parser);
+    CPPUNIT_TEST(content_length);
+    CPPUNIT_TEST(chunked);
+    CPPUNIT_TEST(close_delimited);
+    CPPUNIT_TEST(invalid);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void content_length();
+    void chunked();
+    void close_delimited();
+    void invalid();
+
+   private:
+    /// Send data through a socket pair and read it back into a response. The data is written in pieces of the given
+    /// size to test the resumption of the parser.
+    void read_response(tasks::net::http_response& response, const std::string& data, std::size_t piece,
+                       bool close = false);
+};
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include <tasks/net/socket.h>
+
+#include "test_http_response.h"
+
+using namespace tasks;
+using namespace tasks::net;
+
+void test_http_response::roundtrip(http_response& out, http_response& in) {
+    int fds[2];
+    CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    tasks::net::socket wsock(fds[0]);
+    tasks::net::socket rsock(fds[1]);
+    out.write_data(wsock);
+    CPPUNIT_ASSERT(out.done());
+    in.read_data(rsock);
+    CPPUNIT_ASSERT(in.done());
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+void test_http_response::plain() {
+    http_response out, in;
+    out.set_status("404 Not Found");
+    out.set_header("X-Test", "1");
+    out.write("not here", 8);
+    roundtrip(out, in);
+    CPPUNIT_ASSERT(in.status_code() == 404);
+    CPPUNIT_ASSERT(in.header("X-Test") == "1");
+    CPPUNIT_ASSERT(in.header("Content-Length") == "8");
+    CPPUNIT_ASSERT(in.header("Date") == http_base::NO_VAL);
+    CPPUNIT_ASSERT(std::string(in.content_p()) == "not here");
+}
+
+void test_http_response::header_template() {
+    auto tpl = std::make_shared<const http_header_template>(
+        "200 OK", http_header_template::headers_t{{"Content-Type", "text/plain"}, {"Server", "libtasks"}});
+    CPPUNIT_ASSERT(tpl->status_code() == 200);
+    for (std::size_t len : {0, 1, 10, 12345}) {
+        http_response out, in;
+        out.set_status("500 Ignored");
+        out.set_template(tpl);
+        CPPUNIT_ASSERT(out.status_code() == 200);
+        out.set_header("X-Request-Id", "42");
+        std::string content(len, 'x');
+        out.write(content.c_str(), content.length());
+        roundtrip(out, in);
+        CPPUNIT_ASSERT(in.status() == "200 OK");
+        CPPUNIT_ASSERT(in.header("Content-Type") == "text/plain");
+        CPPUNIT_ASSERT(in.header("Server") == "libtasks");
+        CPPUNIT_ASSERT(in.header("X-Request-Id") == "42");
+        CPPUNIT_ASSERT(in.header("Content-Length") == std::to_string(len));
+        // e.g. "Tue, 15 Nov 1994 08:12:31 GMT"
+        CPPUNIT_ASSERT(in.header("Date").length() == 29);
+        CPPUNIT_ASSERT(in.content_length() == len);
+        if (len) {
+            CPPUNIT_ASSERT(std::string(in.content_p()) == content);
+        }
+    }
+    // The template gets reset with the response
+    http_response out;
+    out.set_template(tpl);
+    out.clear();
+    CPPUNIT_ASSERT(nullptr == out.header_template());
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <tasks/net/http_response.h>
+
+class test_http_response : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_http_response);
+    CPPUNIT_TEST(plain);
+    CPPUNIT_TEST(header_template);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void plain();
+    void header_template();
+
+   private:
+    /// Write a response through a socket pair and parse it again.
+    void roundtrip(tasks::net::http_response& out, tasks::net::http_response& in);
+};
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+
+#include <tasks/net/socket.h>
+
+#include "test_http_server_request.h"
+
+using namespace tasks;
+using namespace tasks::net;
+
+void test_http_server_request::read_request(http_server_request& request, const std::string& data,
+                                            std::size_t piece) {
+    int fds[2];
+    CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    tasks::net::socket sock(fds[1]);
+    std::size_t pos = 0;
+    while (pos < data.length()) {
+        std::size_t len = std::min(piece, data.length() - pos);
+        CPPUNIT_ASSERT(static_cast<ssize_t>(len) == ::write(fds[0], data.c_str() + pos, len));
+        pos += len;
+        // read exactly what has been written to not block
+        request.read_data(sock);
+    }
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+void test_http_server_request::request() {
+    std::string data =
+        "POST /path?q=1 HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Content-Length: 11\r\n"
+        "\r\n"
+        "hello world";
+    for (std::size_t piece : {1, 7, 1024}) {
+        http_server_request request;
+        read_request(request, data, piece);
+        CPPUNIT_ASSERT_MESSAGE("piece=" + std::to_string(piece), request.done());
+        CPPUNIT_ASSERT(request.method() == "POST");
+        CPPUNIT_ASSERT(request.url() == "/path?q=1");
+        CPPUNIT_ASSERT(request.header("Host") == "localhost");
+        CPPUNIT_ASSERT(request.content_length() == 11);
+        CPPUNIT_ASSERT(std::string(request.content_p()) == "hello world");
+        CPPUNIT_ASSERT(request.keep_alive());
+        CPPUNIT_ASSERT(!request.has_pipelined());
+    }
+}
+
+void test_http_server_request::pipelined() {
+    std::string data =
+        "GET /a HTTP/1.1\r\n"
+        "\r\n"
+        "POST /b HTTP/1.1\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "3\r\nabc\r\n0\r\n\r\n"
+        "GET /c HTTP/1.1\r\n"
+        "Connection: close\r\n"
+        "\r\n";
+    for (std::size_t piece : {1, 5, 1024}) {
+        http_server_request request;
+        read_request(request, data, piece);
+        CPPUNIT_ASSERT(request.done());
+        CPPUNIT_ASSERT(request.url() == "/a");
+        CPPUNIT_ASSERT(request.content_length() == 0);
+        CPPUNIT_ASSERT(request.has_pipelined());
+
+        request.clear();
+        request.read_pipelined();
+        CPPUNIT_ASSERT(request.done());
+        CPPUNIT_ASSERT(request.method() == "POST");
+        CPPUNIT_ASSERT(request.url() == "/b");
+        CPPUNIT_ASSERT(request.content_length() == 3);
+        CPPUNIT_ASSERT(std::string(request.content_p()) == "abc");
+
+        request.clear();
+        request.read_pipelined();
+        CPPUNIT_ASSERT(request.done());
+        CPPUNIT_ASSERT(request.url() == "/c");
+        CPPUNIT_ASSERT(!request.keep_alive());
+        CPPUNIT_ASSERT(!request.has_pipelined());
+
+        request.clear();
+        request.read_pipelined();
+        CPPUNIT_ASSERT(!request.done());
+    }
+}
+
+void test_http_server_request::keep_alive() {
+    http_server_request request;
+    read_request(request, "GET / HTTP/1.0\r\n\r\n", 1024);
+    CPPUNIT_ASSERT(request.done());
+    CPPUNIT_ASSERT(!request.http11());
+    CPPUNIT_ASSERT(!request.keep_alive());
+
+    request.clear();
+    read_request(request, "GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", 1024);
+    CPPUNIT_ASSERT(request.done());
+    CPPUNIT_ASSERT(request.keep_alive());
+}
+
+void test_http_server_request::invalid() {
+    tasks_error error = tasks_error::UNSET;
+    try {
+        http_server_request request;
+        read_request(request, "GET /\r\n\r\n", 1024);
+    } catch (tasks_exception& e) {
+        error = e.error_code();
+    }
+    CPPUNIT_ASSERT(tasks_error::HTTP_INVALID_REQUEST_LINE == error);
+
+    error = tasks_error::UNSET;
+    try {
+        http_server_request request;
+        read_request(request, "GET / FTP/1.1\r\n\r\n", 1024);
+    } catch (tasks_exception& e) {
+        error = e.error_code();
+    }
+    CPPUNIT_ASSERT(tasks_error::HTTP_INVALID_REQUEST_LINE == error);
+}
+
+void test_http_server_request::pipeline_overflow() {
+    int fds[2];
+    CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    CPPUNIT_ASSERT(0 == fcntl(fds[1], F_SETFL, O_NONBLOCK));
+    tasks::net::socket sock(fds[1]);
+    http_server_request request;
+    std::string req = "GET / HTTP/1.1\r\n\r\n";
+    CPPUNIT_ASSERT(static_cast<ssize_t>(req.length()) == ::write(fds[0], req.c_str(), req.length()));
+    request.read_data(sock);
+    CPPUNIT_ASSERT(request.done());
+    // Keep pipelining while the request is being handled, the limit has to hit before the socket is drained.
+    std::string chunk(READ_BUFFER_SIZE_BLOCK, 'x');
+    std::size_t written = 0;
+    tasks_error error = tasks_error::UNSET;
+    try {
+        while (written <= HTTP_SERVER_MAX_PIPELINE) {
+            ssize_t n = ::write(fds[0], chunk.c_str(), chunk.length());
+            CPPUNIT_ASSERT(n > 0);
+            written += n;
+            request.read_data(sock);
+        }
+    } catch (tasks_exception& e) {
+        error = e.error_code();
+    }
+    CPPUNIT_ASSERT(tasks_error::HTTP_PIPELINE_OVERFLOW == error);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+void test_http_server_request::limits() {
+    std::string headers = "GET / HTTP/1.1\r\n";
+    for (int i = 0; i < HTTP_SERVER_MAX_HEADERS; i++) {
+        headers += "X-Header-" + std::to_string(i) + ": 1\r\n";
+    }
+    {
+        http_server_request request;
+        read_request(request, headers + "\r\n", 1024);
+        CPPUNIT_ASSERT(request.done());
+    }
+
+    tasks_error error = tasks_error::UNSET;
+    try {
+        http_server_request request;
+        read_request(request, headers + "X-Header: 1\r\n\r\n", 1024);
+    } catch (tasks_exception& e) {
+        error = e.error_code();
+    }
+    CPPUNIT_ASSERT(tasks_error::HTTP_TOO_MANY_HEADERS == error);
+
+    // The Content-Length is checked before the body gets read.
+    for (std::string length : {"10000000000", "100000000000000000000000"}) {
+        error = tasks_error::UNSET;
+        try {
+            http_server_request request;
+            read_request(request, "POST / HTTP/1.1\r\nContent-Length: " + length + "\r\n\r\n", 1024);
+        } catch (tasks_exception& e) {
+            error = e.error_code();
+        }
+        CPPUNIT_ASSERT_MESSAGE(length, tasks_error::HTTP_BODY_TOO_LARGE == error);
+    }
+
+    // A chunked body fails as soon as it exceeds the limit.
+    std::string chunked = "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+    std::size_t head = chunked.size();
+    char size[32];
+    snprintf(size, sizeof(size), "%x\r\n", HTTP_SERVER_MAX_BODY + 1);
+    chunked += size;
+    chunked.append(HTTP_SERVER_MAX_BODY + 1, 'x');
+    error = tasks_error::UNSET;
+    http_server_request request;
+    try {
+        read_request(request, chunked, 64 * 1024);
+    } catch (tasks_exception& e) {
+        error = e.error_code();
+    }
+    CPPUNIT_ASSERT(tasks_error::HTTP_BODY_TOO_LARGE == error);
+    CPPUNIT_ASSERT(request.content_buffer().offset_write() - head <= HTTP_SERVER_MAX_BODY + 64 * 1024);
+}
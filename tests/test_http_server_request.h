@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include <tasks/net/http_server_request.h>
+
+class test_http_server_request : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_http_server_request);
+    CPPUNIT_TEST(request);
+    CPPUNIT_TEST(pipelined);
+    CPPUNIT_TEST(keep_alive);
+    CPPUNIT_TEST(invalid);
+    CPPUNIT_TEST(pipeline_overflow);
+    CPPUNIT_TEST(limits);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void request();
+    void pipelined();
+    void keep_alive();
+    void invalid();
+    void pipeline_overflow();
+    void limits();
+
+   private:
+    /// Send data through a socket pair and read it back into a request. The data is written in pieces of the given
+    /// size to test the resumption of the parser.
+    void read_request(tasks::net::http_server_request& request, const std::string& data, std::size_t piece);
+};
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <utility>
+
+#include <tasks/net/http_server_task.h>
+
+#include "test_http_server_task.h"
+
+using namespace tasks;
+using namespace tasks::net;
+
+namespace {
+
+class ok_task : public http_server_task {
+  public:
+    ok_task(net::socket& sock) : http_server_task(sock) {}
+
+    bool handle_request() {
+        if (request().url() == "/") {
+            response().set_status("200 OK");
+            response().write("ok", 2);
+            send_response();
+        }
+        return true;
+    }
+};
+
+}  // anon
+
+int test_http_server_task::start_task(double idle, double request) {
+    int fds[2];
+    CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    CPPUNIT_ASSERT(0 == fcntl(fds[1], F_SETFL, O_NONBLOCK));
+    tasks::net::socket sock(fds[1]);
+    http_server_task::timeouts_t timeouts;
+    timeouts.idle = idle;
+    timeouts.request = request;
+    http_server_task::set_default_timeouts(timeouts);
+    ok_task* task = new ok_task(sock);
+    http_server_task::set_default_timeouts(http_server_task::timeouts_t());
+    net_io_task::add_task(task);
+    return fds[0];
+}
+
+std::string test_http_server_task::request(int fd, const std::string& path) {
+    std::string data = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    CPPUNIT_ASSERT(static_cast<ssize_t>(data.length()) == ::write(fd, data.c_str(), data.length()));
+    std::string response;
+    if (path != "/") {
+        return response;
+    }
+    char buf[1024];
+    while (response.find("\r\n\r\nok") == std::string::npos) {
+        pollfd pfd = {fd, POLLIN, 0};
+        CPPUNIT_ASSERT(1 == poll(&pfd, 1, 2000));
+        ssize_t bytes = ::read(fd, buf, sizeof(buf));
+        CPPUNIT_ASSERT(bytes > 0);
+        response.append(buf, bytes);
+    }
+    return response;
+}
+
+int test_http_server_task::wait_closed(int fd, int timeout_ms) {
+    auto start = std::chrono::steady_clock::now();
+    pollfd pfd = {fd, POLLIN, 0};
+    char c;
+    if (1 != poll(&pfd, 1, timeout_ms) || 0 != ::read(fd, &c, 1)) {
+        return -1;
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<int>(ms.count());
+}
+
+void test_http_server_task::idle_timeout() {
+    int fd = start_task(0.2, 0.);
+    // Every request resets the idle timeout.
+    for (int i = 0; i < 3; i++) {
+        usleep(100000);
+        std::string response = request(fd, "/");
+        CPPUNIT_ASSERT_MESSAGE(response, response.find("HTTP/1.1 200 OK") == 0);
+    }
+    int ms = wait_closed(fd, 2000);
+    CPPUNIT_ASSERT_MESSAGE(std::to_string(ms) + "ms", ms >= 150);
+    ::close(fd);
+}
+
+void test_http_server_task::request_timeout() {
+    // The request timeout replaces the idle timeout while the handler is busy.
+    int fd = start_task(5., 0.2);
+    request(fd, "/");
+    request(fd, "/never");
+    int ms = wait_closed(fd, 2000);
+    CPPUNIT_ASSERT_MESSAGE(std::to_string(ms) + "ms", ms >= 150 && ms < 1000);
+    ::close(fd);
+}
+
+void test_http_server_task::limits() {
+    std::string headers;
+    for (int i = 0; i <= HTTP_SERVER_MAX_HEADERS; i++) {
+        headers += "X-Header-" + std::to_string(i) + ": 1\r\n";
+    }
+    std::pair<std::string, std::string> requests[] = {
+        {"GET / HTTP/1.1\r\n" + headers + "\r\n", "HTTP/1.1 431 "},
+        {"POST / HTTP/1.1\r\nContent-Length: 10000000000\r\n\r\n", "HTTP/1.1 413 "}};
+    for (auto& r : requests) {
+        int fd = start_task(5., 0.);
+        CPPUNIT_ASSERT(static_cast<ssize_t>(r.first.length()) == ::write(fd, r.first.c_str(), r.first.length()));
+        // The request gets answered and the connection closed.
+        std::string response;
+        char buf[1024];
+        while (response.find("\r\n\r\n") == std::string::npos) {
+            pollfd pfd = {fd, POLLIN, 0};
+            CPPUNIT_ASSERT(1 == poll(&pfd, 1, 2000));
+            ssize_t bytes = ::read(fd, buf, sizeof(buf));
+            CPPUNIT_ASSERT(bytes > 0);
+            response.append(buf, bytes);
+        }
+        CPPUNIT_ASSERT_MESSAGE(response, response.find(r.second) == 0);
+        CPPUNIT_ASSERT_MESSAGE(response, response.find("Connection: close\r\n") != std::string::npos);
+        CPPUNIT_ASSERT(wait_closed(fd, 2000) >= 0);
+        ::close(fd);
+    }
+}
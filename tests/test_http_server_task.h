@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+class test_http_server_task : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_http_server_task);
+    CPPUNIT_TEST(idle_timeout);
+    CPPUNIT_TEST(request_timeout);
+    CPPUNIT_TEST(limits);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void idle_timeout();
+    void request_timeout();
+    void limits();
+
+   private:
+    /// Start an http_server_task on one end of a socket pair. The task answers requests for "/" and ignores others.
+    ///
+    /// \return The other end of the socket pair.
+    int start_task(double idle, double request);
+
+    /// Send a request for a path and read the response if one is expected.
+    ///
+    /// \return The response.
+    std::string request(int fd, const std::string& path);
+
+    /// Wait until the peer closed the connection.
+    ///
+    /// \return The milliseconds until the connection has been closed or -1 if it is still open after timeout_ms.
+    int wait_closed(int fd, int timeout_ms);
+};
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <tasks/net/http_singleflight.h>
+#include <tasks/net/socket.h>
+
+#include "test_http_singleflight.h"
+
+using namespace tasks;
+using namespace tasks::net;
+
+namespace {
+
+/// Wait until count callbacks have been called or a timeout of five seconds has passed.
+bool wait_for(std::atomic<int>& calls, int count) {
+    for (int i = 0; i < 500 && calls < count; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return calls == count;
+}
+
+}  // namespace
+
+void test_http_singleflight::key() {
+    http_request r1("backend", "/a", 8080);
+    http_request r2("backend", "/b", 8080);
+    http_request r3("backend", "/a", 8081);
+    CPPUNIT_ASSERT_EQUAL(std::string("GET backend:8080/a"), http_singleflight::key(r1));
+    CPPUNIT_ASSERT(http_singleflight::key(r1) != http_singleflight::key(r2));
+    CPPUNIT_ASSERT(http_singleflight::key(r1) != http_singleflight::key(r3));
+    // The method is part of the key.
+    http_request r4("backend", "/a", 8080);
+    r4.write("data", 4);
+    CPPUNIT_ASSERT_EQUAL(std::string("POST backend:8080/a"), http_singleflight::key(r4));
+}
+
+void test_http_singleflight::coalesce() {
+    // A server that never answers. Connections wait in the accept queue until the socket is closed.
+    tasks::net::socket srv;
+    srv.listen(18082);
+
+    http_singleflight flights;
+    std::atomic<int> calls(0);
+    std::atomic<int> errors(0);
+    auto f = [&](std::shared_ptr<http_response> response, const tasks_exception& e) {
+        if (tasks_error::UNSET != e.error_code() && nullptr == response) {
+            errors++;
+        }
+        calls++;
+    };
+    int sent = 0;
+    for (int i = 0; i < 5; i++) {
+        if (flights.send(std::make_shared<http_request>("localhost", "/", 18082), f)) {
+            sent++;
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(1, sent);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), flights.in_flight());
+    // A different key gets its own request.
+    CPPUNIT_ASSERT(flights.send(std::make_shared<http_request>("localhost", "/other", 18082), f));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), flights.in_flight());
+    // Requests with a body are never coalesced and don't count as in flight.
+    for (int i = 0; i < 2; i++) {
+        auto post = std::make_shared<http_request>("localhost", "/", 18082);
+        post->write("data", 4);
+        CPPUNIT_ASSERT(flights.send(post, f));
+    }
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), flights.in_flight());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CPPUNIT_ASSERT_EQUAL(0, calls.load());
+
+    // Resets the queued connections, so all waiters get an error.
+    srv.close();
+    CPPUNIT_ASSERT(wait_for(calls, 8));
+    CPPUNIT_ASSERT_EQUAL(8, errors.load());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), flights.in_flight());
+}
+
+void test_http_singleflight::response() {
+    http_singleflight flights;
+    std::atomic<int> calls(0);
+    std::mutex mutex;
+    std::set<http_response*> responses;
+    std::set<int> status_codes;
+    auto f = [&](std::shared_ptr<http_response> response, const tasks_exception& e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks_error::UNSET == e.error_code()) {
+            responses.insert(response.get());
+            status_codes.insert(response->status_code());
+        }
+        calls++;
+    };
+    int sent = 0;
+    for (int i = 0; i < 3; i++) {
+        if (flights.send(std::make_shared<http_request>("localhost", "/", 18080), f)) {
+            sent++;
+        }
+    }
+    CPPUNIT_ASSERT(wait_for(calls, 3));
+    std::lock_guard<std::mutex> lock(mutex);
+    // Every upstream request delivered one response object to all of its waiters.
+    CPPUNIT_ASSERT_EQUAL(std::size_t(sent), responses.size());
+    CPPUNIT_ASSERT(status_codes.size() == 1 && 404 == *status_codes.begin());
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class test_http_singleflight : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_http_singleflight);
+    CPPUNIT_TEST(key);
+    CPPUNIT_TEST(coalesce);
+    CPPUNIT_TEST(response);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void key();
+    void coalesce();
+    void response();
+};
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <atomic>
+#include <future>
+#include <string>
+#include <vector>
+
+#include <tasks/parallel.h>
+
+#include "test_parallel.h"
+
+using namespace tasks;
+
+namespace {
+
+// Outside of a worker the futures are completed by the pool threads, block until then.
+template <class T>
+T wait(future<T> f) {
+    std::promise<T> p;
+    f.then([&p](future<T> r) { p.set_value(r.get()); });
+    return p.get_future().get();
+}
+
+void wait(future<void> f) {
+    std::promise<bool> p;
+    f.then([&p](future<void> r) { p.set_value(!r.failed()); });
+    CPPUNIT_ASSERT(p.get_future().get());
+}
+
+}
+
+void test_parallel::for_each() {
+    std::vector<int> out(10000, 0);
+    wait(parallel_for(0, out.size(), [&out](std::size_t i) { out[i] += static_cast<int>(i) * 2; }));
+    for (std::size_t i = 0; i < out.size(); i++) {
+        CPPUNIT_ASSERT_EQUAL(static_cast<int>(i) * 2, out[i]);
+    }
+
+    // Ranges smaller than a grain and empty ranges
+    std::atomic<int> calls(0);
+    wait(parallel_for(5, 8, [&calls](std::size_t) { calls++; }, 100));
+    CPPUNIT_ASSERT_EQUAL(3, calls.load());
+    wait(parallel_for(8, 8, [&calls](std::size_t) { calls++; }));
+    CPPUNIT_ASSERT_EQUAL(3, calls.load());
+}
+
+void test_parallel::reduce() {
+    std::size_t sum = wait(parallel_reduce(0, 100000, std::size_t(0), [](std::size_t i) { return i; },
+                                           [](std::size_t a, std::size_t b) { return a + b; }));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(100000) * 99999 / 2, sum);
+
+    // The values are combined in order.
+    std::string s = wait(parallel_reduce(0, 26, std::string(), [](std::size_t i) { return std::string(1, 'a' + i); },
+                                         [](const std::string& a, const std::string& b) { return a + b; }, 3));
+    CPPUNIT_ASSERT_EQUAL(std::string("abcdefghijklmnopqrstuvwxyz"), s);
+
+    CPPUNIT_ASSERT_EQUAL(7, wait(parallel_reduce(3, 3, 7, [](std::size_t) { return 1; },
+                                                 [](int a, int b) { return a + b; })));
+}
+
+void test_parallel::group() {
+    // Functors can spawn more functors of their group after join().
+    std::atomic<int> count(0);
+    task_group g;
+    for (int i = 0; i < 10; i++) {
+        g.run([g, &count]() mutable {
+            count++;
+            for (int j = 0; j < 10; j++) {
+                g.run([&count] { count++; });
+            }
+        });
+    }
+    wait(g.join());
+    CPPUNIT_ASSERT_EQUAL(110, count.load());
+}
+
+void test_parallel::error() {
+    std::promise<int> p;
+    parallel_for(0, 1000, [](std::size_t i) {
+        if (500 == i) {
+            throw tasks_exception(tasks_error::DISKIO_ERROR, "failed");
+        }
+    }).then([&p](future<void> done) { p.set_value(static_cast<int>(done.error().error_code())); });
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(tasks_error::DISKIO_ERROR), p.get_future().get());
+
+    std::promise<std::string> q;
+    parallel_reduce(0, 10, 0, [](std::size_t) -> int { throw std::runtime_error("oops"); },
+                    [](int a, int b) { return a + b; })
+        .then([&q](future<int> r) { q.set_value(r.error().message()); });
+    CPPUNIT_ASSERT_EQUAL(std::string("oops"), q.get_future().get());
+}
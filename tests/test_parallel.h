@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class test_parallel : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_parallel);
+    CPPUNIT_TEST(for_each);
+    CPPUNIT_TEST(reduce);
+    CPPUNIT_TEST(group);
+    CPPUNIT_TEST(error);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void for_each();
+    void reduce();
+    void group();
+    void error();
+};
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <tasks/dispatcher.h>
+#include <tasks/ready_queue.h>
+#include <tasks/worker.h>
+
+#include "test_ready_queue.h"
+
+using namespace tasks;
+
+namespace {
+
+class prio_task : public event_task {
+  public:
+    prio_task(event_priority p) { set_priority(p); }
+    bool handle_event(worker*, int) { return false; }
+    void init_watcher() {}
+    void stop_watcher(worker*) {}
+    void start_watcher(worker*) {}
+};
+
+/// Records the order in which the handlers of its instances get called.
+class record_task : public prio_task {
+  public:
+    record_task(event_priority p, char name, std::string& order, std::mutex& mutex)
+        : prio_task(p), m_name(name), m_order(order), m_mutex(mutex) {}
+
+    bool handle_event(worker*, int) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_order += m_name;
+        return true;
+    }
+
+  private:
+    char m_name;
+    std::string& m_order;
+    std::mutex& m_mutex;
+};
+
+}
+
+void test_ready_queue::order() {
+    prio_task high(event_priority::HIGH);
+    prio_task normal(event_priority::NORMAL);
+    prio_task low(event_priority::LOW);
+    ready_queue q;
+    CPPUNIT_ASSERT(q.empty());
+    q.push({&low, 1});
+    q.push({&normal, 2});
+    q.push({&high, 3});
+    q.push({&normal, 4});
+    q.push({&high, 5});
+    CPPUNIT_ASSERT_EQUAL(std::size_t(5), q.size());
+    // Higher priorities first, FIFO within a priority
+    int expected[] = {3, 5, 2, 4, 1};
+    for (int r : expected) {
+        CPPUNIT_ASSERT_EQUAL(r, q.pop().revents);
+    }
+    CPPUNIT_ASSERT(q.empty());
+}
+
+void test_ready_queue::starvation() {
+    prio_task high(event_priority::HIGH);
+    prio_task normal(event_priority::NORMAL);
+    prio_task low(event_priority::LOW);
+    ready_queue q;
+    q.push({&low, 0});
+    q.push({&normal, 0});
+    for (int i = 0; i < 2 * READY_QUEUE_STARVATION_LIMIT; i++) {
+        q.push({&high, 0});
+    }
+    // Both waiting levels get a turn after being passed over READY_QUEUE_STARVATION_LIMIT times.
+    int highs = 0;
+    while (q.pop().task == &high) {
+        highs++;
+    }
+    // The loop stopped at the normal event, the low one follows.
+    CPPUNIT_ASSERT_EQUAL(READY_QUEUE_STARVATION_LIMIT, highs);
+    CPPUNIT_ASSERT(q.pop().task == &low);
+    while (!q.empty()) {
+        CPPUNIT_ASSERT(q.pop().task == &high);
+    }
+}
+
+void test_ready_queue::worker_batch() {
+    std::string order;
+    std::mutex mutex;
+    record_task low(event_priority::LOW, 'l', order, mutex);
+    record_task normal(event_priority::NORMAL, 'n', order, mutex);
+    record_task high(event_priority::HIGH, 'h', order, mutex);
+    // All events and the functor are queued before the worker handles the batch.
+    dispatcher::instance()->last_worker()->exec_in_worker_ctx([&](struct ev_loop*) {
+        worker::get()->add_event({&low, EV_READ});
+        worker::get()->add_event({&normal, EV_READ});
+        worker::get()->add_event({&high, EV_READ});
+        worker::get()->defer(
+            [&](worker*) {
+                std::lock_guard<std::mutex> lock(mutex);
+                order += 'd';
+            },
+            event_priority::HIGH);
+    });
+    for (int i = 0; i < 200; i++) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (order.length() >= 4) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    // Let the worker finish the last handler call before the tasks go out of scope.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::lock_guard<std::mutex> lock(mutex);
+    CPPUNIT_ASSERT_EQUAL(std::string("hdnl"), order);
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class test_ready_queue : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_ready_queue);
+    CPPUNIT_TEST(order);
+    CPPUNIT_TEST(starvation);
+    CPPUNIT_TEST(worker_batch);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void order();
+    void starvation();
+    void worker_batch();
+};
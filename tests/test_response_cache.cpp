@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+#include <tasks/net/response_cache.h>
+#include <tasks/net/socket.h>
+#include <tasks/net/uwsgi_structs.h>
+
+#include "test_response_cache.h"
+
+using namespace tasks::net;
+
+void test_response_cache::read_packet(uwsgi_request& req,
+                                      const std::vector<std::pair<std::string, std::string>>& vars) {
+    std::string data;
+    for (auto& kv : vars) {
+        uint16_t len = kv.first.length();
+        data.append((const char*)&len, sizeof(len));
+        data.append(kv.first);
+        len = kv.second.length();
+        data.append((const char*)&len, sizeof(len));
+        data.append(kv.second);
+    }
+    uwsgi_packet_header header = {UWSGI_VARS, static_cast<uint16_t>(data.length()), 0};
+
+    int fds[2];
+    CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    CPPUNIT_ASSERT(sizeof(header) == ::write(fds[0], &header, sizeof(header)));
+    CPPUNIT_ASSERT(static_cast<ssize_t>(data.length()) == ::write(fds[0], data.c_str(), data.length()));
+
+    tasks::net::socket sock(fds[1]);
+    while (!req.done()) {
+        req.read_data(sock);
+    }
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+void test_response_cache::get_put() {
+    response_cache cache(1024, 60.);
+    CPPUNIT_ASSERT(nullptr == cache.get("a"));
+    cache.put("a", "response a");
+    response_cache::entry_t e = cache.get("a");
+    CPPUNIT_ASSERT(nullptr != e);
+    CPPUNIT_ASSERT_EQUAL(std::string("response a"), *e);
+    // Replacing an entry keeps the old bytes alive for readers that still hold them.
+    cache.put("a", "new");
+    CPPUNIT_ASSERT_EQUAL(std::string("response a"), *e);
+    CPPUNIT_ASSERT_EQUAL(std::string("new"), *cache.get("a"));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), cache.size());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), cache.bytes());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), cache.hits());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), cache.misses());
+    cache.clear();
+    CPPUNIT_ASSERT(nullptr == cache.get("a"));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache.bytes());
+}
+
+void test_response_cache::expiry() {
+    response_cache cache(1024, 0.05);
+    cache.put("a", "response a");
+    CPPUNIT_ASSERT(nullptr != cache.get("a"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CPPUNIT_ASSERT(nullptr == cache.get("a"));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache.size());
+}
+
+void test_response_cache::eviction() {
+    // One shard with a budget of 30 bytes
+    response_cache cache(30, 60., {"REQUEST_URI"}, 1);
+    cache.put("a", std::string(10, 'a'));
+    cache.put("b", std::string(10, 'b'));
+    cache.put("c", std::string(10, 'c'));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(30), cache.bytes());
+    // Make "a" the most recently used entry, so "b" is evicted next.
+    CPPUNIT_ASSERT(nullptr != cache.get("a"));
+    cache.put("d", std::string(10, 'd'));
+    CPPUNIT_ASSERT(nullptr != cache.get("a"));
+    CPPUNIT_ASSERT(nullptr == cache.get("b"));
+    CPPUNIT_ASSERT(nullptr != cache.get("c"));
+    CPPUNIT_ASSERT(nullptr != cache.get("d"));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(30), cache.bytes());
+    // Entries bigger than the budget are not stored.
+    cache.put("e", std::string(31, 'e'));
+    CPPUNIT_ASSERT(nullptr == cache.get("e"));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), cache.size());
+}
+
+void test_response_cache::key() {
+    response_cache cache(1024, 60., {"REQUEST_URI", "HTTP_ACCEPT_ENCODING"});
+    std::string k1, k2;
+
+    uwsgi_request r1;
+    read_packet(r1, {{"REQUEST_METHOD", "GET"}, {"REQUEST_URI", "/a"}, {"HTTP_ACCEPT_ENCODING", "gzip"}});
+    CPPUNIT_ASSERT(cache.key(r1, k1));
+
+    uwsgi_request r2;
+    read_packet(r2, {{"REQUEST_METHOD", "GET"}, {"REQUEST_URI", "/a"}});
+    CPPUNIT_ASSERT(cache.key(r2, k2));
+    CPPUNIT_ASSERT(k1 != k2);
+
+    uwsgi_request r3;
+    read_packet(r3, {{"HTTP_ACCEPT_ENCODING", "gzip"}, {"REQUEST_URI", "/a"}, {"REQUEST_METHOD", "GET"}});
+    CPPUNIT_ASSERT(cache.key(r3, k2));
+    CPPUNIT_ASSERT_EQUAL(k1, k2);
+
+    uwsgi_request r4;
+    read_packet(r4, {{"REQUEST_METHOD", "POST"}, {"REQUEST_URI", "/a"}});
+    CPPUNIT_ASSERT(!cache.key(r4, k2));
+}
+
+void test_response_cache::default_key() {
+    // Virtual hosts behind one socket get their own entries.
+    response_cache cache(1024, 60.);
+    std::string k1, k2;
+
+    uwsgi_request r1;
+    read_packet(r1, {{"REQUEST_METHOD", "GET"}, {"HTTP_HOST", "a.example.com"}, {"REQUEST_URI", "/"}});
+    CPPUNIT_ASSERT(cache.key(r1, k1));
+
+    uwsgi_request r2;
+    read_packet(r2, {{"REQUEST_METHOD", "GET"}, {"HTTP_HOST", "b.example.com"}, {"REQUEST_URI", "/"}});
+    CPPUNIT_ASSERT(cache.key(r2, k2));
+    CPPUNIT_ASSERT(k1 != k2);
+
+    uwsgi_request r3;
+    read_packet(r3, {{"REQUEST_METHOD", "GET"}, {"REQUEST_URI", "/"}, {"HTTP_HOST", "a.example.com"}});
+    CPPUNIT_ASSERT(cache.key(r3, k2));
+    CPPUNIT_ASSERT_EQUAL(k1, k2);
+}
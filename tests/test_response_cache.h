@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tasks/net/uwsgi_request.h>
+
+class test_response_cache : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_response_cache);
+    CPPUNIT_TEST(get_put);
+    CPPUNIT_TEST(expiry);
+    CPPUNIT_TEST(eviction);
+    CPPUNIT_TEST(key);
+    CPPUNIT_TEST(default_key);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void get_put();
+    void expiry();
+    void eviction();
+    void key();
+    void default_key();
+
+   private:
+    void read_packet(tasks::net::uwsgi_request& req, const std::vector<std::pair<std::string, std::string>>& vars);
+};
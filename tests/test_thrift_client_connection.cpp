@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+#include <tasks/net/thrift_client_connection.h>
+
+#include "test_thrift_client_connection.h"
+
+using namespace tasks;
+using namespace tasks::net;
+
+namespace {
+
+// strict binary: 0x8001 version, type 1 (call) or 2 (reply), name "lookup", seqid 0x01020304, stop field
+const char g_message[] = {'\x80', '\x01', '\x00', '\x01', '\x00', '\x00', '\x00', '\x06', 'l',   'o',  'o',
+                          'k',    'u',    'p',    '\x01', '\x02', '\x03', '\x04', '\x00'};
+
+/// Read a frame from the server side of a connection.
+std::string read_frame(int fd) {
+    char buf[64];
+    std::size_t received = 0;
+    while (received < 4 + sizeof(g_message)) {
+        pollfd pfd = {fd, POLLIN, 0};
+        CPPUNIT_ASSERT(1 == poll(&pfd, 1, 2000));
+        ssize_t bytes = ::read(fd, buf + received, sizeof(buf) - received);
+        CPPUNIT_ASSERT(bytes > 0);
+        received += bytes;
+    }
+    CPPUNIT_ASSERT(4 + sizeof(g_message) == received);
+    return std::string(buf, received);
+}
+
+}  // anon
+
+void test_thrift_client_connection::parse_seqid() {
+    int32_t seqid = 0;
+
+    // strict binary: 0x8001 version, type 2 (reply), name "lookup", seqid 0x01020304
+    const char binary[] = {'\x80', '\x01', '\x00', '\x02', '\x00', '\x00', '\x00', '\x06', 'l',   'o',  'o',
+                           'k',    'u',    'p',    '\x01', '\x02', '\x03', '\x04', '\x0c', '\x00'};
+    CPPUNIT_ASSERT(thrift_client_connection::parse_seqid(binary, sizeof(binary), seqid));
+    CPPUNIT_ASSERT_EQUAL(0x01020304, seqid);
+    // truncated
+    CPPUNIT_ASSERT(!thrift_client_connection::parse_seqid(binary, 16, seqid));
+
+    // old binary: name length, name, type, seqid
+    const char old_binary[] = {'\x00', '\x00', '\x00', '\x02', 'l', 'o', '\x02', '\x00', '\x00', '\x00', '\x07'};
+    CPPUNIT_ASSERT(thrift_client_connection::parse_seqid(old_binary, sizeof(old_binary), seqid));
+    CPPUNIT_ASSERT_EQUAL(7, seqid);
+
+    // compact: protocol id, version 1 and type 2, varint seqid 300, name "lookup"
+    const char compact[] = {'\x82', '\x41', '\xac', '\x02', '\x06', 'l', 'o', 'o', 'k', 'u', 'p'};
+    CPPUNIT_ASSERT(thrift_client_connection::parse_seqid(compact, sizeof(compact), seqid));
+    CPPUNIT_ASSERT_EQUAL(300, seqid);
+    // unterminated varint
+    CPPUNIT_ASSERT(!thrift_client_connection::parse_seqid(compact, 3, seqid));
+
+    CPPUNIT_ASSERT(!thrift_client_connection::parse_seqid(compact, 0, seqid));
+}
+
+int test_thrift_client_connection::listen_socket(int& port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    CPPUNIT_ASSERT(fd >= 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    CPPUNIT_ASSERT(0 == ::bind(fd, (struct sockaddr*)&addr, len));
+    CPPUNIT_ASSERT(0 == ::listen(fd, 1));
+    CPPUNIT_ASSERT(0 == getsockname(fd, (struct sockaddr*)&addr, &len));
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+void test_thrift_client_connection::connect() {
+    int port;
+    int srv = listen_socket(port);
+    auto* conn = new thrift_client_connection("127.0.0.1", port);
+    net_io_task::add_task(conn);
+
+    // The call is buffered until the connection has been established.
+    std::promise<std::string> reply;
+    CPPUNIT_ASSERT(conn->send(g_message, sizeof(g_message), 0x01020304,
+                              [&reply](thrift_frame_buffer* r, const tasks_exception& e) {
+                                  if (nullptr == r) {
+                                      reply.set_value("error: " + e.message());
+                                  } else {
+                                      reply.set_value("reply");
+                                  }
+                              }));
+    CPPUNIT_ASSERT(1 == conn->pending());
+
+    int fd = ::accept(srv, nullptr, nullptr);
+    CPPUNIT_ASSERT(fd >= 0);
+    char buf[64];
+    std::size_t received = 0;
+    while (received < 4 + sizeof(g_message)) {
+        pollfd pfd = {fd, POLLIN, 0};
+        CPPUNIT_ASSERT(1 == poll(&pfd, 1, 2000));
+        ssize_t bytes = ::read(fd, buf + received, sizeof(buf) - received);
+        CPPUNIT_ASSERT(bytes > 0);
+        received += bytes;
+    }
+    CPPUNIT_ASSERT(4 + sizeof(g_message) == received);
+    CPPUNIT_ASSERT(sizeof(g_message) == ntohl(*(uint32_t*)buf));
+    CPPUNIT_ASSERT(std::string(buf + 4, sizeof(g_message)) == std::string(g_message, sizeof(g_message)));
+
+    // Answer with the same seqid.
+    buf[4 + 3] = '\x02';
+    CPPUNIT_ASSERT(static_cast<ssize_t>(received) == ::write(fd, buf, received));
+    auto f = reply.get_future();
+    CPPUNIT_ASSERT(std::future_status::ready == f.wait_for(std::chrono::seconds(2)));
+    CPPUNIT_ASSERT_EQUAL(std::string("reply"), f.get());
+    CPPUNIT_ASSERT(0 == conn->pending());
+
+    conn->shutdown();
+    ::close(fd);
+    ::close(srv);
+}
+
+void test_thrift_client_connection::connect_refused() {
+    int port;
+    ::close(listen_socket(port));
+    std::promise<tasks_error> result;
+    auto* conn = new thrift_client_connection("127.0.0.1", port);
+    conn->send(g_message, sizeof(g_message), 0x01020304, [&result](thrift_frame_buffer* r, const tasks_exception& e) {
+        CPPUNIT_ASSERT(nullptr == r);
+        result.set_value(e.error_code());
+    });
+    net_io_task::add_task(conn);
+    auto f = result.get_future();
+    CPPUNIT_ASSERT(std::future_status::ready == f.wait_for(std::chrono::seconds(2)));
+    CPPUNIT_ASSERT(tasks_error::SOCKET_CONNECT == f.get());
+}
+
+void test_thrift_client_connection::idle_send() {
+    int port;
+    int srv = listen_socket(port);
+    auto* conn = new thrift_client_connection("127.0.0.1", port);
+    net_io_task::add_task(conn);
+    int fd = ::accept(srv, nullptr, nullptr);
+    CPPUNIT_ASSERT(fd >= 0);
+
+    for (int i = 0; i < 2; i++) {
+        // Let the connection go idle, so only a read is pending when the call gets sent.
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::promise<bool> reply;
+        CPPUNIT_ASSERT(conn->send(g_message, sizeof(g_message), 0x01020304,
+                                  [&reply](thrift_frame_buffer* r, const tasks_exception&) {
+                                      reply.set_value(nullptr != r);
+                                  }));
+        std::string frame = read_frame(fd);
+        CPPUNIT_ASSERT(std::string(g_message, sizeof(g_message)) == frame.substr(4));
+        frame[4 + 3] = '\x02';
+        CPPUNIT_ASSERT(static_cast<ssize_t>(frame.size()) == ::write(fd, frame.data(), frame.size()));
+        auto f = reply.get_future();
+        CPPUNIT_ASSERT(std::future_status::ready == f.wait_for(std::chrono::seconds(2)));
+        CPPUNIT_ASSERT(f.get());
+    }
+
+    conn->shutdown();
+    ::close(fd);
+    ::close(srv);
+}
+
+void test_thrift_client_connection::frame_limit() {
+    int fds[2];
+    CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    CPPUNIT_ASSERT(0 == fcntl(fds[1], F_SETFL, O_NONBLOCK));
+    tasks::net::socket sock(fds[1]);
+
+    // A frame of the maximum size followed by more data. The reader stops once the frame can be complete.
+    std::thread writer([&fds] {
+        uint32_t len = htonl(THRIFT_MAX_FRAME);
+        std::string data(reinterpret_cast<const char*>(&len), 4);
+        data.append(THRIFT_MAX_FRAME + 1024 * 1024, 'x');
+        std::size_t pos = 0;
+        while (pos < data.size()) {
+            ssize_t bytes = ::send(fds[0], data.data() + pos, data.size() - pos, MSG_NOSIGNAL);
+            if (bytes <= 0) {
+                break;
+            }
+            pos += bytes;
+        }
+    });
+    thrift_frame_buffer buf;
+    std::size_t frame_end;
+    while (!buf.next_frame(frame_end)) {
+        pollfd pfd = {fds[1], POLLIN, 0};
+        CPPUNIT_ASSERT(1 == poll(&pfd, 1, 2000));
+        buf.read_data(sock);
+    }
+    // Give the writer time to fill the socket buffer. Reading more is refused until the frame has been consumed.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    buf.read_data(sock);
+    ::shutdown(fds[1], SHUT_RDWR);
+    writer.join();
+    ::close(fds[0]);
+    ::close(fds[1]);
+    CPPUNIT_ASSERT(buf.content_buffer().to_read() <= THRIFT_MAX_FRAME + THRIFT_READ_BLOCK);
+    CPPUNIT_ASSERT(frame_end == THRIFT_MAX_FRAME + 4);
+
+    // The length of a frame that is too big gets rejected as soon as it has been read.
+    CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    CPPUNIT_ASSERT(0 == fcntl(fds[1], F_SETFL, O_NONBLOCK));
+    tasks::net::socket sock2(fds[1]);
+    uint32_t len = htonl(THRIFT_MAX_FRAME + 1);
+    CPPUNIT_ASSERT(4 == ::write(fds[0], &len, 4));
+    thrift_frame_buffer buf2;
+    tasks_error error = tasks_error::UNSET;
+    try {
+        buf2.read_data(sock2);
+    } catch (tasks_exception& e) {
+        error = e.error_code();
+    }
+    CPPUNIT_ASSERT(tasks_error::THRIFT_INVALID_FRAME == error);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
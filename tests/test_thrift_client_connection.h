@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class test_thrift_client_connection : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_thrift_client_connection);
+    CPPUNIT_TEST(parse_seqid);
+    CPPUNIT_TEST(connect);
+    CPPUNIT_TEST(connect_refused);
+    CPPUNIT_TEST(idle_send);
+    CPPUNIT_TEST(frame_limit);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void parse_seqid();
+    void connect();
+    void connect_refused();
+    void idle_send();
+    void frame_limit();
+
+   private:
+    /// Open a listening tcp socket on the loopback interface.
+    ///
+    /// \param port Gets set to the port.
+    /// \return The socket.
+    int listen_socket(int& port);
+};
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <tasks/net/socket.h>
+#include <tasks/net/thrift_protocol.h>
+
+#include "test_thrift_protocol.h"
+
+using namespace tasks::net;
+
+void test_thrift_protocol::read_packet(uwsgi_request& req,
+                                       const std::vector<std::pair<std::string, std::string>>& vars) {
+    std::string data;
+    for (auto& kv : vars) {
+        uint16_t len = kv.first.length();
+        data.append((const char*)&len, sizeof(len));
+        data.append(kv.first);
+        len = kv.second.length();
+        data.append((const char*)&len, sizeof(len));
+        data.append(kv.second);
+    }
+    uwsgi_packet_header header = {UWSGI_VARS, static_cast<uint16_t>(data.length()), 0};
+
+    int fds[2];
+    CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    CPPUNIT_ASSERT(sizeof(header) == ::write(fds[0], &header, sizeof(header)));
+    CPPUNIT_ASSERT(static_cast<ssize_t>(data.length()) == ::write(fds[0], data.c_str(), data.length()));
+
+    tasks::net::socket sock(fds[1]);
+    while (!req.done()) {
+        req.read_data(sock);
+    }
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+void test_thrift_protocol::from_mime() {
+    thrift_protocol p = thrift_protocol::COMPACT;
+    CPPUNIT_ASSERT(thrift_protocol_from_mime("application/x-thrift", p));
+    CPPUNIT_ASSERT(thrift_protocol::BINARY == p);
+    CPPUNIT_ASSERT(thrift_protocol_from_mime("application/vnd.apache.thrift.compact", p));
+    CPPUNIT_ASSERT(thrift_protocol::COMPACT == p);
+    CPPUNIT_ASSERT(thrift_protocol_from_mime("application/vnd.apache.thrift.binary; charset=binary", p));
+    CPPUNIT_ASSERT(thrift_protocol::BINARY == p);
+
+    // The first thrift type of a list wins.
+    CPPUNIT_ASSERT(
+        thrift_protocol_from_mime("text/html, application/vnd.apache.thrift.compact, application/x-thrift", p));
+    CPPUNIT_ASSERT(thrift_protocol::COMPACT == p);
+    CPPUNIT_ASSERT(thrift_protocol_from_mime("application/x-thrift;q=0.9, application/vnd.apache.thrift.compact", p));
+    CPPUNIT_ASSERT(thrift_protocol::BINARY == p);
+
+    // Unknown or missing types leave the protocol untouched.
+    p = thrift_protocol::COMPACT;
+    CPPUNIT_ASSERT(!thrift_protocol_from_mime("application/json", p));
+    CPPUNIT_ASSERT(thrift_protocol::COMPACT == p);
+    CPPUNIT_ASSERT(!thrift_protocol_from_mime("*/*", p));
+    CPPUNIT_ASSERT(!thrift_protocol_from_mime("", p));
+    CPPUNIT_ASSERT(thrift_protocol::COMPACT == p);
+
+    CPPUNIT_ASSERT(std::string(thrift_content_type(thrift_protocol::BINARY)) == THRIFT_CONTENT_TYPE_BINARY);
+    CPPUNIT_ASSERT(std::string(thrift_content_type(thrift_protocol::COMPACT)) == THRIFT_CONTENT_TYPE_COMPACT);
+}
+
+void test_thrift_protocol::negotiate() {
+    struct expectation {
+        std::vector<std::pair<std::string, std::string>> vars;
+        thrift_protocol in;
+        thrift_protocol out;
+    };
+    std::vector<expectation> expectations = {
+        // No content type at all falls back to binary.
+        {{{"REQUEST_METHOD", "POST"}}, thrift_protocol::BINARY, thrift_protocol::BINARY},
+        // Unknown content types fall back to binary as well.
+        {{{"CONTENT_TYPE", "application/json"}}, thrift_protocol::BINARY, thrift_protocol::BINARY},
+        {{{"CONTENT_TYPE", "application/x-thrift"}}, thrift_protocol::BINARY, thrift_protocol::BINARY},
+        // The response uses the request protocol without a thrift type in HTTP_ACCEPT.
+        {{{"CONTENT_TYPE", THRIFT_CONTENT_TYPE_COMPACT}}, thrift_protocol::COMPACT, thrift_protocol::COMPACT},
+        {{{"CONTENT_TYPE", THRIFT_CONTENT_TYPE_COMPACT}, {"HTTP_ACCEPT", "*/*"}},
+         thrift_protocol::COMPACT,
+         thrift_protocol::COMPACT},
+        // A thrift type in HTTP_ACCEPT selects the response protocol.
+        {{{"CONTENT_TYPE", THRIFT_CONTENT_TYPE_COMPACT}, {"HTTP_ACCEPT", THRIFT_CONTENT_TYPE_BINARY}},
+         thrift_protocol::COMPACT,
+         thrift_protocol::BINARY},
+        {{{"CONTENT_TYPE", "text/plain"}, {"HTTP_ACCEPT", THRIFT_CONTENT_TYPE_COMPACT}},
+         thrift_protocol::BINARY,
+         thrift_protocol::COMPACT},
+    };
+    for (auto& e : expectations) {
+        uwsgi_request req;
+        read_packet(req, e.vars);
+        thrift_protocol in, out;
+        negotiate_thrift_protocol(req, in, out);
+        CPPUNIT_ASSERT_MESSAGE(e.vars[0].second, e.in == in);
+        CPPUNIT_ASSERT_MESSAGE(e.vars[0].second, e.out == out);
+    }
+}
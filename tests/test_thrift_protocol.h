@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <vector>
+
+#include <tasks/net/uwsgi_request.h>
+
+class test_thrift_protocol : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_thrift_protocol);
+    CPPUNIT_TEST(from_mime);
+    CPPUNIT_TEST(negotiate);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void from_mime();
+    void negotiate();
+
+   private:
+    /// Serialize a uwsgi packet with the given vars and read it back through a socket pair.
+    void read_packet(tasks::net::uwsgi_request& req, const std::vector<std::pair<std::string, std::string>>& vars);
+};
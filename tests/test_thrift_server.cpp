@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <thrift/protocol/TBinaryProtocol.h>
+#include <thrift/protocol/TCompactProtocol.h>
+#include <thrift/transport/TBufferTransports.h>
+#include <thrift/transport/TSocket.h>
+#include <boost/shared_ptr.hpp>
+#include <chrono>
+#include <future>
+#include <vector>
+
+#include <tasks/net/acceptor.h>
+#include <tasks/net/thrift_async_client.h>
+#include <tasks/net/thrift_server_task.h>
+
+#include "test_thrift_server.h"
+#include "test_uwsgi_thrift_async.h"
+
+using namespace apache::thrift;
+using namespace apache::thrift::protocol;
+using namespace apache::thrift::transport;
+
+namespace {
+
+void check_result(const response_type& r) {
+    CPPUNIT_ASSERT(r.key_values.size() == 2);
+    CPPUNIT_ASSERT(r.key_values[0].key.name == "city");
+    CPPUNIT_ASSERT(r.key_values[0].values.size() == 1);
+    CPPUNIT_ASSERT(r.key_values[0].values[0].name == "Berlin");
+    CPPUNIT_ASSERT(r.key_values[1].key.name == "country");
+    CPPUNIT_ASSERT(r.key_values[1].values.size() == 1);
+    CPPUNIT_ASSERT(r.key_values[1].values[0].name == "Germany");
+}
+
+}  // anon
+
+void test_thrift_server::persistent() {
+    m_srv1.reset(new acceptor<thrift_server_task<ip_service_async1> >(12350));
+    tasks::net_io_task::add_task(m_srv1.get());
+
+    boost::shared_ptr<TSocket> sock(new TSocket("localhost", 12350));
+    boost::shared_ptr<TFramedTransport> transport(new TFramedTransport(sock));
+    boost::shared_ptr<TBinaryProtocol> protocol(new TBinaryProtocol(transport));
+    IpServiceClient client(protocol);
+
+    transport->open();
+    ipv6_type ipv6;
+    // Several calls over the same connection
+    for (int i = 0; i < 3; i++) {
+        response_type r;
+        client.lookup(r, 123456789, ipv6);
+        check_result(r);
+    }
+    // Handler errors are returned as exceptions and don't close the connection
+    try {
+        response_type r;
+        client.lookup(r, 0, ipv6);
+        CPPUNIT_ASSERT_MESSAGE("TApplicationException expected", false);
+    } catch (TApplicationException& e) {
+        CPPUNIT_ASSERT(std::string(e.what()) == "wrong ip address");
+    }
+    response_type r;
+    client.lookup(r, 123456789, ipv6);
+    check_result(r);
+    transport->close();
+}
+
+void test_thrift_server::in_flight() {
+    m_srv2.reset(new acceptor<thrift_server_task<ip_service_async2> >(12351));
+    tasks::net_io_task::add_task(m_srv2.get());
+
+    boost::shared_ptr<TSocket> sock(new TSocket("localhost", 12351));
+    boost::shared_ptr<TFramedTransport> transport(new TFramedTransport(sock));
+    boost::shared_ptr<TBinaryProtocol> protocol(new TBinaryProtocol(transport));
+    IpServiceClient client(protocol);
+
+    transport->open();
+    ipv6_type ipv6;
+    // The handler sleeps a second, both calls have to run in parallel.
+    auto start = std::chrono::steady_clock::now();
+    client.send_lookup(123456789, ipv6);
+    client.send_lookup(123456789, ipv6);
+    for (int i = 0; i < 2; i++) {
+        response_type r;
+        client.recv_lookup(r);
+        check_result(r);
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    CPPUNIT_ASSERT_MESSAGE(std::to_string(ms.count()) + "ms", ms.count() < 1900);
+    transport->close();
+}
+
+void test_thrift_server::compact() {
+    m_srv3.reset(new acceptor<thrift_server_task<ip_service_async1> >(12352));
+    tasks::net_io_task::add_task(m_srv3.get());
+
+    boost::shared_ptr<TSocket> sock(new TSocket("localhost", 12352));
+    boost::shared_ptr<TFramedTransport> transport(new TFramedTransport(sock));
+    boost::shared_ptr<TCompactProtocol> protocol(new TCompactProtocol(transport));
+    IpServiceClient client(protocol);
+
+    transport->open();
+    ipv6_type ipv6;
+    response_type r;
+    client.lookup(r, 123456789, ipv6);
+    check_result(r);
+    transport->close();
+}
+
+void test_thrift_server::async_client() {
+    m_srv4.reset(new acceptor<thrift_server_task<ip_service_async2> >(12353));
+    tasks::net_io_task::add_task(m_srv4.get());
+
+    thrift_async_client client("localhost", 12353, 2);
+    IpService_lookup_args args;
+    args.ipv4 = 123456789;
+
+    // The handler sleeps a second, the calls have to be multiplexed over the pooled connections.
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<response_type>> futures;
+    for (int i = 0; i < 4; i++) {
+        futures.push_back(client.call<IpService_lookup_result>("lookup", args));
+    }
+    for (auto& f : futures) {
+        check_result(f.get());
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    CPPUNIT_ASSERT_MESSAGE(std::to_string(ms.count()) + "ms", ms.count() < 1900);
+    CPPUNIT_ASSERT(client.pool().connections() <= 2);
+
+    // Callback interface
+    std::promise<bool> done;
+    client.call<IpService_lookup_result>("lookup", args, [&done](response_type& r, const tasks_exception& e) {
+        done.set_value(e.error_code() == tasks_error::UNSET && r.key_values.size() == 2);
+    });
+    CPPUNIT_ASSERT(done.get_future().get());
+
+    // Handler errors
+    args.ipv4 = 0;
+    try {
+        client.call<IpService_lookup_result>("lookup", args).get();
+        CPPUNIT_ASSERT_MESSAGE("tasks_exception expected", false);
+    } catch (tasks_exception& e) {
+        CPPUNIT_ASSERT_MESSAGE(e.message(), e.message() == "wrong ip address");
+    }
+}
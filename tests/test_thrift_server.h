@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <memory>
+
+#include <tasks/net_io_task.h>
+
+class test_thrift_server : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_thrift_server);
+    CPPUNIT_TEST(persistent);
+    CPPUNIT_TEST(in_flight);
+    CPPUNIT_TEST(compact);
+    CPPUNIT_TEST(async_client);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void persistent();
+    void in_flight();
+    void compact();
+    void async_client();
+
+   private:
+    std::unique_ptr<tasks::net_io_task> m_srv1;
+    std::unique_ptr<tasks::net_io_task> m_srv2;
+    std::unique_ptr<tasks::net_io_task> m_srv3;
+    std::unique_ptr<tasks::net_io_task> m_srv4;
+};
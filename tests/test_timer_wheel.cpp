@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <tasks/timer_wheel.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "test_timer_wheel.h"
+
+using namespace std;
+
+namespace tasks {
+
+void test_timer_wheel::expire() {
+    timer_wheel wheel;
+    int64_t now = timer_wheel::now_ms();
+    int fired = 0;
+    wheel_timer t1([&fired] { fired++; });
+    wheel_timer t2([&fired] { fired += 10; });
+    wheel.add(&t1, now + 100);
+    wheel.add(&t2, now + 200);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), wheel.size());
+    CPPUNIT_ASSERT(t1.armed());
+    // Timers never expire early, but up to a tick late.
+    CPPUNIT_ASSERT_EQUAL(size_t(0), wheel.advance(now + 99));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), wheel.advance(now + 150));
+    CPPUNIT_ASSERT_EQUAL(1, fired);
+    CPPUNIT_ASSERT(!t1.armed());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), wheel.advance(now + 200 + TIMER_WHEEL_TICK_MS));
+    CPPUNIT_ASSERT_EQUAL(11, fired);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), wheel.size());
+}
+
+void test_timer_wheel::reset() {
+    timer_wheel wheel;
+    int64_t now = timer_wheel::now_ms();
+    int fired = 0;
+    wheel_timer t([&fired] { fired++; });
+    wheel.add(&t, now + 100);
+    // Reset the timer as a connection does on every read.
+    wheel.add(&t, now + 300);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), wheel.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), wheel.advance(now + 200));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), wheel.advance(now + 300 + TIMER_WHEEL_TICK_MS));
+    CPPUNIT_ASSERT_EQUAL(1, fired);
+
+    wheel.add(&t, now + 400);
+    wheel.remove(&t);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), wheel.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), wheel.advance(now + 500));
+
+    // A timer that is destroyed gets removed.
+    {
+        wheel_timer t2([&fired] { fired++; });
+        wheel.add(&t2, now + 600);
+        CPPUNIT_ASSERT_EQUAL(size_t(1), wheel.size());
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0), wheel.size());
+    CPPUNIT_ASSERT_EQUAL(1, fired);
+}
+
+void test_timer_wheel::cascade() {
+    timer_wheel wheel;
+    int64_t now = timer_wheel::now_ms();
+    // Timeouts from 10ms to ~2h spread over all levels.
+    vector<int64_t> timeouts = {10, 640, 650, 41000, 2621440, 7200000};
+    vector<int64_t> fired_at(timeouts.size(), 0);
+    vector<unique_ptr<wheel_timer>> timers;
+    int64_t t = now;
+    for (size_t i = 0; i < timeouts.size(); i++) {
+        timers.emplace_back(new wheel_timer([&fired_at, &t, i] { fired_at[i] = t; }));
+        wheel.add(timers.back().get(), now + timeouts[i]);
+    }
+    // Advance in steps of one second and check that every timer expires within its step.
+    while (wheel.size()) {
+        t += 1000;
+        wheel.advance(t);
+        CPPUNIT_ASSERT(t <= now + 7200000 + 1000 + TIMER_WHEEL_TICK_MS);
+    }
+    for (size_t i = 0; i < timeouts.size(); i++) {
+        CPPUNIT_ASSERT(fired_at[i] >= now + timeouts[i]);
+        CPPUNIT_ASSERT(fired_at[i] < now + timeouts[i] + 1000 + TIMER_WHEEL_TICK_MS);
+    }
+}
+
+void test_timer_wheel::run() {
+    // Timers armed outside of a worker use the wheel of the last worker.
+    atomic<int> fired{0};
+    wheel_timer t1([&fired] { fired++; });
+    wheel_timer t2([&fired] { fired++; });
+    t1.arm(0.05);
+    t2.arm(0.05);
+    t2.cancel();
+    this_thread::sleep_for(chrono::milliseconds(300));
+    CPPUNIT_ASSERT_EQUAL(1, fired.load());
+    CPPUNIT_ASSERT(!t1.armed());
+}
+
+}
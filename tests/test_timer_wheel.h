@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace tasks {
+
+class test_timer_wheel : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_timer_wheel);
+    CPPUNIT_TEST(expire);
+    CPPUNIT_TEST(reset);
+    CPPUNIT_TEST(cascade);
+    CPPUNIT_TEST(run);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void expire();
+    void reset();
+    void cascade();
+    void run();
+};
+
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <tasks/net/socket.h>
+#include <tasks/net/uwsgi_vars.h>
+
+#include "test_uwsgi_request.h"
+
+using namespace tasks::net;
+
+static const std::vector<std::pair<std::string, std::string>> g_vars = {{"REQUEST_METHOD", "GET"},
+                                                                        {"REQUEST_URI", "/test?a=1"},
+                                                                        {"QUERY_STRING", "a=1"},
+                                                                        {"REMOTE_ADDR", "127.0.0.1"},
+                                                                        {"HTTP_X_CUSTOM", "custom"}};
+
+void test_uwsgi_request::read_packet(uwsgi_request& req, const std::vector<std::pair<std::string, std::string>>& vars) {
+    std::string data;
+    for (auto& kv : vars) {
+        uint16_t len = kv.first.length();
+        data.append((const char*)&len, sizeof(len));
+        data.append(kv.first);
+        len = kv.second.length();
+        data.append((const char*)&len, sizeof(len));
+        data.append(kv.second);
+    }
+    uwsgi_packet_header header = {UWSGI_VARS, static_cast<uint16_t>(data.length()), 0};
+
+    int fds[2];
+    CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    CPPUNIT_ASSERT(sizeof(header) == ::write(fds[0], &header, sizeof(header)));
+    CPPUNIT_ASSERT(static_cast<ssize_t>(data.length()) == ::write(fds[0], data.c_str(), data.length()));
+
+    tasks::net::socket sock(fds[1]);
+    while (!req.done()) {
+        req.read_data(sock);
+    }
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+void test_uwsgi_request::lookup() {
+    for (std::size_t i = 0; i < uwsgi_vars::COUNT; i++) {
+        std::string name = uwsgi_vars::names[i];
+        CPPUNIT_ASSERT_MESSAGE(name, static_cast<std::size_t>(uwsgi_vars::lookup(name.c_str(), name.length())) == i);
+    }
+    CPPUNIT_ASSERT(uwsgi_vars::lookup("HTTP_X_CUSTOM", 13) == uwsgi_var::COUNT);
+    CPPUNIT_ASSERT(uwsgi_vars::lookup("REQUEST_URI_", 12) == uwsgi_var::COUNT);
+    CPPUNIT_ASSERT(uwsgi_vars::lookup("URI", 3) == uwsgi_var::COUNT);
+}
+
+void test_uwsgi_request::parse_copy() {
+    uwsgi_request req;
+    read_packet(req, g_vars);
+    CPPUNIT_ASSERT(req.var("REQUEST_URI") == "/test?a=1");
+    CPPUNIT_ASSERT(req.var("HTTP_X_CUSTOM") == "custom");
+    CPPUNIT_ASSERT(req.var(uwsgi_var::QUERY_STRING) == "a=1");
+    CPPUNIT_ASSERT(req.var(uwsgi_var::CONTENT_LENGTH).empty());
+    CPPUNIT_ASSERT(req.var_view("HTTP_X_CUSTOM") == "custom");
+    CPPUNIT_ASSERT(req.vars().size() == g_vars.size());
+    CPPUNIT_ASSERT(req.other_vars().empty());
+}
+
+void test_uwsgi_request::parse_zero_copy() {
+    uwsgi_request req;
+    req.set_parse_mode(uwsgi_parse_mode::ZERO_COPY);
+    read_packet(req, g_vars);
+    CPPUNIT_ASSERT(req.var(uwsgi_var::REQUEST_METHOD) == "GET");
+    CPPUNIT_ASSERT(req.var(uwsgi_var::REMOTE_ADDR) == "127.0.0.1");
+    CPPUNIT_ASSERT(req.var_view("REQUEST_URI") == "/test?a=1");
+    CPPUNIT_ASSERT(req.var_view("HTTP_X_CUSTOM") == "custom");
+    CPPUNIT_ASSERT(req.var_view("HTTP_X_MISSING").empty());
+    CPPUNIT_ASSERT(req.other_vars().size() == 1);
+    CPPUNIT_ASSERT(req.headers().empty());
+    // Falling back to the string interface fills the map
+    CPPUNIT_ASSERT(req.var("QUERY_STRING") == "a=1");
+    CPPUNIT_ASSERT(req.vars().size() == g_vars.size());
+
+    // Reuse the object
+    req.clear();
+    CPPUNIT_ASSERT(req.var(uwsgi_var::REQUEST_METHOD).empty());
+    read_packet(req, {{"REQUEST_METHOD", "POST"}, {"CONTENT_LENGTH", "0"}});
+    CPPUNIT_ASSERT(req.var(uwsgi_var::REQUEST_METHOD) == "POST");
+    CPPUNIT_ASSERT(req.var(uwsgi_var::REQUEST_URI).empty());
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <vector>
+
+#include <tasks/net/uwsgi_request.h>
+
+class test_uwsgi_request : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_uwsgi_request);
+    CPPUNIT_TEST(lookup);
+    CPPUNIT_TEST(parse_copy);
+    CPPUNIT_TEST(parse_zero_copy);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void lookup();
+    void parse_copy();
+    void parse_zero_copy();
+
+   private:
+    /// Serialize a uwsgi packet with the given vars and read it back through a socket pair.
+    void read_packet(tasks::net::uwsgi_request& req, const std::vector<std::pair<std::string, std::string>>& vars);
+};
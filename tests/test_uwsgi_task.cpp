@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <utility>
+
+#include <tasks/net/uwsgi_task.h>
+
+#include "test_uwsgi_task.h"
+
+using namespace tasks;
+using namespace tasks::net;
+
+namespace {
+
+std::atomic<int> g_handled(0);
+// An additional response header, set before a task gets started.
+std::pair<std::string, std::string> g_header;
+
+class ok_task : public uwsgi_task {
+  public:
+    ok_task(net::socket& sock) : uwsgi_task(sock) {}
+
+    bool handle_request() {
+        g_handled++;
+        response().set_status("200 OK");
+        response().set_header("Date", "Thu, 01 Jan 1970 00:00:00 GMT");
+        response().set_header("Connection", "close");
+        response().set_header("X-Test", "1");
+        if (!g_header.first.empty()) {
+            response().set_header(g_header.first, g_header.second);
+        }
+        response().write("ok", 2);
+        send_response();
+        return true;
+    }
+};
+
+}  // anon
+
+int test_uwsgi_task::start_task(bool keep_alive, double idle_timeout, std::shared_ptr<response_cache> cache) {
+    int fds[2];
+    CPPUNIT_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    CPPUNIT_ASSERT(0 == fcntl(fds[1], F_SETFL, O_NONBLOCK));
+    tasks::net::socket sock(fds[1]);
+    ok_task* task = new ok_task(sock);
+    task->set_keep_alive(keep_alive);
+    task->set_idle_timeout(idle_timeout);
+    task->set_response_cache(cache);
+    net_io_task::add_task(task);
+    return fds[0];
+}
+
+std::string test_uwsgi_task::request(int fd) {
+    std::string vars;
+    for (auto& kv : {std::make_pair("REQUEST_METHOD", "GET"), std::make_pair("REQUEST_URI", "/")}) {
+        uint16_t len = std::string(kv.first).length();
+        vars.append((const char*)&len, sizeof(len));
+        vars.append(kv.first);
+        len = std::string(kv.second).length();
+        vars.append((const char*)&len, sizeof(len));
+        vars.append(kv.second);
+    }
+    uwsgi_packet_header header = {UWSGI_VARS, static_cast<uint16_t>(vars.length()), 0};
+    std::string data((const char*)&header, sizeof(header));
+    data.append(vars);
+    CPPUNIT_ASSERT(static_cast<ssize_t>(data.length()) == ::write(fd, data.c_str(), data.length()));
+    // Read until the body has been received.
+    std::string response;
+    char buf[1024];
+    while (response.find("\r\n\r\nok") == std::string::npos) {
+        pollfd pfd = {fd, POLLIN, 0};
+        CPPUNIT_ASSERT(1 == poll(&pfd, 1, 2000));
+        ssize_t bytes = ::read(fd, buf, sizeof(buf));
+        CPPUNIT_ASSERT(bytes > 0);
+        response.append(buf, bytes);
+    }
+    return response;
+}
+
+bool test_uwsgi_task::wait_closed(int fd, int timeout_ms) {
+    pollfd pfd = {fd, POLLIN, 0};
+    if (1 != poll(&pfd, 1, timeout_ms)) {
+        return false;
+    }
+    char c;
+    return 0 == ::read(fd, &c, 1);
+}
+
+void test_uwsgi_task::keep_alive() {
+    int fd = start_task(true, 0.);
+    for (int i = 0; i < 3; i++) {
+        std::string response = request(fd);
+        CPPUNIT_ASSERT_MESSAGE(response, response.find("HTTP/1.1 200 OK") == 0);
+    }
+    // Without an idle timeout the connection stays open.
+    CPPUNIT_ASSERT(!wait_closed(fd, 200));
+    ::close(fd);
+
+    fd = start_task(false, 0.);
+    request(fd);
+    CPPUNIT_ASSERT(wait_closed(fd, 1000));
+    ::close(fd);
+}
+
+void test_uwsgi_task::idle_timeout() {
+    int fd = start_task(true, 0.2);
+    // Every request resets the idle timeout.
+    for (int i = 0; i < 3; i++) {
+        usleep(100000);
+        request(fd);
+    }
+    auto start = std::chrono::steady_clock::now();
+    CPPUNIT_ASSERT(wait_closed(fd, 2000));
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    CPPUNIT_ASSERT_MESSAGE(std::to_string(ms.count()) + "ms", ms.count() >= 150);
+    ::close(fd);
+}
+
+void test_uwsgi_task::cached() {
+    auto cache = std::make_shared<response_cache>(1024 * 1024, 60.);
+    int fd = start_task(true, 0., cache);
+    int handled = g_handled;
+    std::string first = request(fd);
+    CPPUNIT_ASSERT_MESSAGE(first, first.find("Date: Thu, 01 Jan 1970") != std::string::npos);
+    // The hit is written from the cache with a current Date header and without the Connection header.
+    std::string second = request(fd);
+    CPPUNIT_ASSERT_EQUAL(handled + 1, g_handled.load());
+    CPPUNIT_ASSERT_MESSAGE(second, second.find("HTTP/1.1 200 OK\r\nDate: ") == 0);
+    CPPUNIT_ASSERT_MESSAGE(second, second.find("1970") == std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(second, second.find("Connection") == std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(second, second.find("X-Test: 1\r\n") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE(second, second.find("\r\n\r\nok") != std::string::npos);
+    ::close(fd);
+}
+
+void test_uwsgi_task::not_cached() {
+    std::pair<std::string, std::string> headers[] = {{"Set-Cookie", "session=1"},
+                                                     {"Cache-Control", "no-store"},
+                                                     {"Cache-Control", "max-age=60, Private"},
+                                                     {"Vary", "Cookie"}};
+    for (auto& h : headers) {
+        g_header = h;
+        auto cache = std::make_shared<response_cache>(1024 * 1024, 60.);
+        int fd = start_task(true, 0., cache);
+        int handled = g_handled;
+        // Both requests get handled.
+        std::string first = request(fd);
+        CPPUNIT_ASSERT_MESSAGE(first, first.find(h.first + ": " + h.second + "\r\n") != std::string::npos);
+        request(fd);
+        CPPUNIT_ASSERT_MESSAGE(h.first, handled + 2 == g_handled);
+        CPPUNIT_ASSERT_MESSAGE(h.first, 0 == cache->size());
+        ::close(fd);
+    }
+    // Other Cache-Control directives do not prevent caching.
+    g_header = std::make_pair("Cache-Control", "max-age=60");
+    auto cache = std::make_shared<response_cache>(1024 * 1024, 60.);
+    int fd = start_task(true, 0., cache);
+    request(fd);
+    std::string cached = request(fd);
+    CPPUNIT_ASSERT_MESSAGE(cached, cached.find("Cache-Control: max-age=60\r\n") != std::string::npos);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), cache->size());
+    g_header = {};
+    ::close(fd);
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <memory>
+#include <string>
+
+#include <tasks/net/response_cache.h>
+
+class test_uwsgi_task : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_uwsgi_task);
+    CPPUNIT_TEST(keep_alive);
+    CPPUNIT_TEST(idle_timeout);
+    CPPUNIT_TEST(cached);
+    CPPUNIT_TEST(not_cached);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void keep_alive();
+    void idle_timeout();
+    void cached();
+    void not_cached();
+
+   private:
+    /// Start a uwsgi_task on one end of a socket pair.
+    ///
+    /// \return The other end of the socket pair.
+    int start_task(bool keep_alive, double idle_timeout, std::shared_ptr<tasks::net::response_cache> cache = nullptr);
+
+    /// Send a request and read the response.
+    ///
+    /// \return The response.
+    std::string request(int fd);
+
+    /// Wait until the peer closed the connection.
+    ///
+    /// \return True if the connection has been closed within timeout_ms.
+    bool wait_closed(int fd, int timeout_ms);
+};
@@ -15,6 +15,7 @@
 #include <IpService.h>  // Thrift generated
 
 #include <tasks/net/uwsgi_thrift_async_handler.h>
+#include <tasks/net/uwsgi_thrift_handler_traits.h>
 
 using namespace tasks;
 using namespace tasks::net;
@@ -25,6 +26,14 @@ class ip_service_async1 : public uwsgi_thrift_async_handler<IpService_lookup_res
     std::string service_name() const { return "lookup"; }
 };
 
+// The handler keeps no state besides the result, so it can serve all requests of a connection.
+namespace tasks {
+namespace net {
+template <>
+struct uwsgi_thrift_handler_reuse<ip_service_async1> : std::true_type {};
+}  // net
+}  // tasks
+
 class ip_service_async2 : public uwsgi_thrift_async_handler<IpService_lookup_result, IpService_lookup_args> {
    public:
     void service(std::shared_ptr<args_t> args);
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <tasks/net/uwsgi_thrift_async_bundle.h>
+#include <tasks/net/uwsgi_thrift_async_handler.h>
+
+#include "test_uwsgi_thrift_async_bundle.h"
+
+using namespace tasks::net;
+
+namespace {
+
+// Minimal stand-ins for the thrift generated types. The "protocol" is a plain int.
+struct bundle_result {
+    int success = 0;
+    struct {
+        bool success = false;
+    } __isset;
+    uint32_t write(int* out) const {
+        *out = success;
+        return 0;
+    }
+};
+
+struct bundle_args {
+    int value = 0;
+    uint32_t read(int* in) {
+        value = *in;
+        return 0;
+    }
+};
+
+template <int ID>
+class bundle_handler : public uwsgi_thrift_async_handler<bundle_result, bundle_args> {
+  public:
+    static constexpr const char* method_name() { return 0 == ID ? "lookup" : 1 == ID ? "update" : "remove"; }
+    std::string service_name() const { return method_name(); }
+    void service(std::shared_ptr<args_t> args) {
+        if (args->value < 0) {
+            set_error("negative value");
+        } else {
+            result() = args->value * 10 + ID;
+        }
+        finish();
+    }
+};
+
+using bundle_t = uwsgi_thrift_async_bundle<bundle_handler<0>, bundle_handler<1>, bundle_handler<2>>;
+
+}  // anon
+
+void test_uwsgi_thrift_async_bundle::lookup() {
+    CPPUNIT_ASSERT(bundle_t::lookup("lookup") == 0);
+    CPPUNIT_ASSERT(bundle_t::lookup("update") == 1);
+    CPPUNIT_ASSERT(bundle_t::lookup("remove") == 2);
+    CPPUNIT_ASSERT(bundle_t::lookup("") == bundle_t::COUNT);
+    CPPUNIT_ASSERT(bundle_t::lookup("lookups") == bundle_t::COUNT);
+    CPPUNIT_ASSERT(bundle_t::lookup("delete") == bundle_t::COUNT);
+}
+
+void test_uwsgi_thrift_async_bundle::dispatch() {
+    bundle_t b;
+    int finished = 0;
+    b.on_finish([&finished] { finished++; });
+
+    const char* methods[] = {"update", "remove", "lookup", "update"};
+    int expected[] = {41, 42, 40, 41};
+    for (int i = 0; i < 4; i++) {
+        b.reset();
+        CPPUNIT_ASSERT(b.select(methods[i]));
+        CPPUNIT_ASSERT(b.service_name() == methods[i]);
+        int in = 4, out = 0;
+        b.read_args(&in);
+        b.call();
+        CPPUNIT_ASSERT(!b.error());
+        b.write_result(&out);
+        CPPUNIT_ASSERT_EQUAL(expected[i], out);
+    }
+    CPPUNIT_ASSERT_EQUAL(4, finished);
+
+    b.reset();
+    CPPUNIT_ASSERT(b.select("lookup"));
+    int in = -1;
+    b.read_args(&in);
+    b.call();
+    CPPUNIT_ASSERT(b.error());
+    CPPUNIT_ASSERT(b.error_message() == "negative value");
+
+    b.reset();
+    CPPUNIT_ASSERT(!b.select("delete"));
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class test_uwsgi_thrift_async_bundle : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_uwsgi_thrift_async_bundle);
+    CPPUNIT_TEST(lookup);
+    CPPUNIT_TEST(dispatch);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void lookup();
+    void dispatch();
+};
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <tasks/dispatcher.h>
+#include <tasks/timer_task.h>
+#include <tasks/worker.h>
+
+#include "test_worker.h"
+
+using namespace tasks;
+
+namespace {
+
+std::atomic<int> g_yield_calls{0};
+std::atomic<bool> g_should_yield{true};
+std::atomic<uint64_t> g_over_budget{0};
+
+class yield_test : public timer_task {
+  public:
+    yield_test() : timer_task(0.01, 0.) {}
+
+    bool handle_event(worker* worker, int) {
+        if (g_yield_calls++ < 3) {
+            // Use up the time slice.
+            auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(2);
+            while (std::chrono::steady_clock::now() < end) {
+            }
+            if (!worker->should_yield()) {
+                g_should_yield = false;
+            }
+            worker->yield(this);
+            return true;
+        }
+        g_over_budget = worker->over_budget_count();
+        return false;
+    }
+};
+
+/// Records the order in which the handlers of its instances get called.
+class record_task : public event_task {
+  public:
+    record_task(char name, int yields, std::string& order, std::mutex& mutex)
+        : m_name(name), m_yields(yields), m_order(order), m_mutex(mutex) {}
+
+    bool handle_event(worker* worker, int) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_order += m_name;
+        }
+        if (m_yields-- > 0) {
+            worker->yield(this);
+        }
+        return true;
+    }
+
+    void init_watcher() {}
+    void stop_watcher(worker*) {}
+    void start_watcher(worker*) {}
+
+  private:
+    char m_name;
+    int m_yields;
+    std::string& m_order;
+    std::mutex& m_mutex;
+};
+
+/// Wait until the string has a length or a timeout of two seconds has passed.
+std::string wait_for(std::string& s, std::size_t len, std::mutex& mutex) {
+    for (int i = 0; i < 200; i++) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (s.length() >= len) {
+                return s;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return s;
+}
+
+}  // namespace
+
+void test_worker::yield() {
+    worker::set_handler_budget(1000);
+    dispatcher::instance()->add_event_task(new yield_test());
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    worker::set_handler_budget(HANDLER_TIME_BUDGET);
+    CPPUNIT_ASSERT_MESSAGE("g_yield_calls=" + std::to_string(g_yield_calls), g_yield_calls == 4);
+    CPPUNIT_ASSERT(g_should_yield);
+    CPPUNIT_ASSERT_MESSAGE("g_over_budget=" + std::to_string(g_over_budget), g_over_budget >= 3);
+}
+
+void test_worker::yield_order() {
+    std::string order;
+    std::mutex mutex;
+    record_task a('a', 1, order, mutex);
+    record_task b('b', 0, order, mutex);
+    // Both events fire in the same batch. The yielded event goes back to the ready queue behind b.
+    dispatcher::instance()->last_worker()->exec_in_worker_ctx([&a, &b](struct ev_loop*) {
+        worker::get()->add_event({&a, EV_READ});
+        worker::get()->add_event({&b, EV_READ});
+    });
+    CPPUNIT_ASSERT_EQUAL(std::string("aba"), wait_for(order, 3, mutex));
+    // Let the worker finish the last handler call before the tasks go out of scope.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2013-2015 ADTECH GmbH
+ * Licensed under MIT (https://github.com/adtechlabs/libtasks/blob/master/COPYING)
+ *
+ * Author: Andreas Pohl
+ */
+
+#include <cppunit/TestCase.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class test_worker : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(test_worker);
+    CPPUNIT_TEST(yield);
+    CPPUNIT_TEST(yield_order);
+    CPPUNIT_TEST_SUITE_END();
+
+   public:
+    void setUp() {}
+    void tearDown() {}
+
+   protected:
+    void yield();
+    void yield_order();
+};